@@ -0,0 +1,931 @@
+#include "BatchRunner.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "RegionPolicies.hpp"
+
+namespace
+{
+    /// @brief Делит строку команды на слова по пробелам
+    std::vector<std::string_view> splitWords(std::string_view line)
+    {
+        std::vector<std::string_view> words{};
+
+        while(!line.empty())
+        {
+            auto begin = line.find_first_not_of(" \t\r");
+
+            if(begin == std::string_view::npos)
+                break;
+
+            line.remove_prefix(begin);
+
+            auto end = line.find_first_of(" \t\r");
+            words.push_back(line.substr(0, end));
+            line = end == std::string_view::npos ? std::string_view{} : line.substr(end);
+        }
+
+        return words;
+    }
+
+    std::expected<size_t, std::string> parseCount(std::string_view text)
+    {
+        size_t number = 0;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+
+        if(ec != std::errc{} || ptr != text.data() + text.size())
+            return std::unexpected{"invalid number: " + std::string(text)};
+
+        return number;
+    }
+}
+
+BatchRunner::BatchRunner(OutputFormat format, size_t limit)
+    : finder(reader, procScanner), cache(procScanner), parser(reader), classifier(reader), out(STDOUT_FILENO, format), limit(limit)
+{
+    scanner.setAlignment(Alignment::Four);
+}
+
+int BatchRunner::run(std::istream& commands)
+{
+    std::string line;
+    size_t lineNumber = 0;
+
+    while(std::getline(commands, line))
+    {
+        ++lineNumber;
+
+        auto words = splitWords(line);
+
+        if(words.empty() || words[0].starts_with('#'))
+            continue;
+
+        if(words[0] == "quit")
+            break;
+
+        if(auto result = execute(line); !result)
+        {
+            out.flush();
+            std::cerr << "line " << lineNumber << ": " << result.error() << "\n";
+            return 1;
+        }
+    }
+
+    out.flush();
+    return 0;
+}
+
+BatchRunner::CommandResult BatchRunner::execute(std::string_view line)
+{
+    auto words = splitWords(line);
+    auto command = words[0];
+    auto argument = [&](size_t i) { return i < words.size() ? words[i] : std::string_view{}; };
+
+    // шаблон структуры -- весь остаток строки после команды
+    auto rest = line.substr(std::min(line.size(), static_cast<size_t>(command.data() + command.size() - line.data())));
+
+    if(command == "find") return find(argument(1), argument(2));
+    if(command == "attach") return attach(argument(1));
+    if(command == "policy") return policy(argument(1), argument(2));
+    if(command == "profile") return profile(argument(1));
+    if(command == "estimate") return estimate(argument(1));
+    if(command == "scan") return firstScan(argument(1));
+    if(command == "group") return groupScan(rest);
+    if(command == "next") return nextScan(group ? rest : argument(1));
+    if(command == "compare") return compareScan(argument(1), argument(2));
+    if(command == "save") return save(argument(1));
+    if(command == "export") return exportRelative(argument(1));
+    if(command == "import") return importRelative(argument(1));
+    if(command == "write") return write(argument(1), argument(2));
+    if(command == "aob") return signatureScan(argument(1), words.size() > 2 ? line.substr(static_cast<size_t>(words[2].data() - line.data())) : std::string_view{});
+    if(command == "snapshot") return snapshot();
+    if(command == "diff") return diff(argument(1));
+    if(command == "monitor") return monitor(argument(1), argument(2));
+    if(command == "throttle") return setThrottle(argument(1));
+
+    if(command == "type")
+    {
+        auto parsed = Value::typeFromName(argument(1));
+
+        if(!parsed)
+            return std::unexpected{"unknown type: " + std::string(argument(1))};
+
+        type = *parsed;
+        return {};
+    }
+
+    if(command == "float")
+    {
+        auto mode = argument(1);
+
+        if(mode == "exact") rounding.reset();
+        else if(mode == "truncated") rounding = FloatRange::Rounding::Truncated;
+        else if(mode == "rounded") rounding = FloatRange::Rounding::Rounded;
+        else if(mode == "ulp") rounding = FloatRange::Rounding::Ulp;
+        else return std::unexpected{"unknown float mode: " + std::string(mode)};
+
+        if(mode == "ulp" && !argument(2).empty())
+        {
+            auto ulps = parseCount(argument(2));
+
+            if(!ulps)
+                return std::unexpected{ulps.error()};
+
+            roundingUlps = static_cast<unsigned>(*ulps);
+        }
+        return {};
+    }
+
+    if(command == "images")
+    {
+        auto mode = argument(1);
+
+        if(mode != "on" && mode != "off")
+            return std::unexpected{"unknown images mode: " + std::string(mode)};
+
+        scanner.setFileImages(mode == "on");
+        return {};
+    }
+
+    if(command == "reads")
+    {
+        auto mode = argument(1);
+
+        if(mode != "queued" && mode != "sync")
+            return std::unexpected{"unknown read mode: " + std::string(mode)};
+
+        scanner.setQueuedReads(mode == "queued");
+        return {};
+    }
+
+    if(command == "format")
+    {
+        auto name = argument(1);
+
+        if(name == "text") out.setFormat(OutputFormat::Text);
+        else if(name == "ndjson") out.setFormat(OutputFormat::Ndjson);
+        else if(name == "binary") out.setFormat(OutputFormat::Binary);
+        else return std::unexpected{"unknown format: " + std::string(name)};
+
+        return {};
+    }
+
+    if(command == "limit")
+    {
+        auto parsed = parseCount(argument(1));
+
+        if(!parsed)
+            return std::unexpected{parsed.error()};
+
+        limit = *parsed;
+        return {};
+    }
+
+    if(command == "print" || command == "count")
+    {
+        if(!session || (!value && !group))
+            return std::unexpected{"no scan results"};
+
+        if(command == "count")
+        {
+            out.writeLine(std::to_string(session->size()));
+            return {};
+        }
+
+        size_t printLimit = limit;
+
+        if(!argument(1).empty())
+        {
+            auto parsed = parseCount(argument(1));
+
+            if(!parsed)
+                return std::unexpected{parsed.error()};
+
+            printLimit = *parsed;
+        }
+
+        // с пределом карты слотов не разворачиваются
+        std::span<const ScanResult> shown = printLimit ? session->getFirst(printLimit) : std::span<const ScanResult>(session->getData());
+
+        if(group)
+            out.write(shown, *group, printLimit);
+        else
+            out.write(shown, *value, printLimit);
+
+        return {};
+    }
+
+    return std::unexpected{"unknown command: " + std::string(command)};
+}
+
+BatchRunner::CommandResult BatchRunner::find(std::string_view fieldOrText, std::string_view text)
+{
+    MatchField field = MatchField::Comm;
+
+    if(text.empty())
+        text = fieldOrText;
+    else if(fieldOrText == "cmdline")
+        field = MatchField::Cmdline;
+    else if(fieldOrText == "exe")
+        field = MatchField::Exe;
+    else if(fieldOrText != "comm")
+        return std::unexpected{"find: unknown field " + std::string(fieldOrText)};
+
+    if(text.empty())
+        return std::unexpected{"find: name expected"};
+
+    auto processes = finder.searchCached(text, field, cache);
+
+    if(!processes)
+        return std::unexpected{"find: process enumeration failed"};
+
+    for(const auto& p : *processes)
+        out.writeLine(std::to_string(p.pid) + " " + p.name);
+
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::attach(std::string_view pidText)
+{
+    pid_t target = 0;
+
+    if(auto [ptr, ec] = std::from_chars(pidText.data(), pidText.data() + pidText.size(), target);
+    ec != std::errc{} || target <= 0) return std::unexpected{"attach: invalid pid " + std::string(pidText)};
+
+    auto parsed = parser.parse(target);
+
+    if(!parsed)
+        return std::unexpected{"attach: cannot read maps of " + std::string(pidText)};
+
+    classifier.classify(*parsed);
+    (void)classifier.attachUsage(target, *parsed);
+
+    auto filtered = rules ? filter.filter(*parsed, *rules) : filter.filter(*parsed, RegionPolicies::forScan());
+
+    if(!filtered)
+        return std::unexpected{"attach: no regions left after filtering"};
+
+    auto metadata = cache.get(target);
+
+    pid = target;
+    attached = metadata ? (*metadata)->key : ProcessKey{target, 0};
+    regions = std::move(*filtered);
+    layout = std::move(*parsed);
+    session.reset();
+
+    // снимки старого процесса (или старой фильтрации) сравнивать не с чем
+    previousSnapshot.reset();
+    lastSnapshot.reset();
+    sampled.reset();
+    pages = std::make_shared<PageStore>();
+
+    rebuildThrottle();
+
+    std::cerr << "[regions] " << regions.size() << "\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::policy(std::string_view file, std::string_view name)
+{
+    auto loaded = RegionPolicies::load(std::filesystem::path(file), name);
+
+    if(!loaded)
+        return std::unexpected{"policy: cannot load " + std::string(name) + " from " + std::string(file)};
+
+    rules = std::move(*loaded);
+
+    // уже подключённый процесс перефильтровывается новой политикой
+    if(pid > 0)
+        return attach(std::to_string(pid));
+
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::firstScan(std::string_view valueText)
+{
+    if(pid <= 0)
+        return std::unexpected{"scan: attach a process first"};
+
+    if(auto alive = checkTarget("scan"); !alive)
+        return alive;
+
+    auto range = floatRange(valueText);
+
+    if(!range)
+        return std::unexpected{"scan: " + range.error()};
+
+    auto parsed = *range ? (*range)->value() : Value::parse(type, valueText);
+
+    if(!parsed)
+        return std::unexpected{"scan: invalid value " + std::string(valueText)};
+
+    value = *parsed;
+    group.reset();
+
+    Memory mem(pid);
+    session = std::make_unique<ScanSessions>(*value, mem);
+
+    auto status = *range ? scanner.scan(regions, *session, **range, mem) : scanner.scan(regions, *session, *value, mem);
+
+    if(!status)
+        return std::unexpected{"scan: read error"};
+
+    reportScanStats();
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::profile(std::string_view topText)
+{
+    if(pid <= 0)
+        return std::unexpected{"profile: attach a process first"};
+
+    if(auto alive = checkTarget("profile"); !alive)
+        return alive;
+
+    size_t top = 10;
+
+    if(!topText.empty())
+    {
+        auto parsed = parseCount(topText);
+
+        if(!parsed)
+            return std::unexpected{"profile: " + parsed.error()};
+
+        top = *parsed;
+    }
+
+    Memory mem(pid);
+    auto taken = ValueProfile::sample(regions, mem, scanner.getAlignment());
+
+    if(!taken)
+        return std::unexpected{"profile: read error"};
+
+    sampled = std::move(*taken);
+
+    auto counts = sampled->histogram(type, top);
+
+    if(counts.empty() && top > 0)
+        return std::unexpected{"profile: " + std::string(Value::typeName(type)) + " has no histogram"};
+
+    std::vector<std::byte> bytes(counts.empty() ? 0 : counts.front().value.size());
+    char text[96];
+
+    for(const auto& entry : counts)
+    {
+        entry.value.store(bytes.data());
+
+        char* end = entry.value.format(bytes, text, text + 40);
+        *end++ = ' ';
+        end = std::to_chars(end, text + sizeof(text), entry.count).ptr;
+        *end++ = ' ';
+        end = std::to_chars(end, text + sizeof(text), entry.share * 100.0, std::chars_format::fixed, 3).ptr;
+        *end++ = '%';
+
+        out.writeLine(std::string_view(text, static_cast<size_t>(end - text)));
+    }
+
+    std::cerr << "[profile] sampled " << sampled->sampledBytes() << " of " << sampled->totalBytes() << " bytes\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::estimate(std::string_view valueText)
+{
+    if(pid <= 0)
+        return std::unexpected{"estimate: attach a process first"};
+
+    if(auto alive = checkTarget("estimate"); !alive)
+        return alive;
+
+    auto parsed = Value::parse(type, valueText);
+
+    if(!parsed)
+        return std::unexpected{"estimate: invalid value " + std::string(valueText)};
+
+    // выборка переиспользуется, пока не сменились процесс или выравнивание
+    if(!sampled || sampled->step() != scanner.getAlignment())
+    {
+        Memory mem(pid);
+        auto taken = ValueProfile::sample(regions, mem, scanner.getAlignment());
+
+        if(!taken)
+            return std::unexpected{"estimate: read error"};
+
+        sampled = std::move(*taken);
+    }
+
+    auto guess = sampled->estimate(scanner, *parsed);
+
+    std::cerr << "[estimate] ~" << guess.projectedHits << " hits, " << guess.matches << " of " << guess.sampledSlots
+              << " sampled slots, sampled " << sampled->sampledBytes() << " of " << sampled->totalBytes() << " bytes, "
+              << (guess.layout == ResultLayout::Bitmap ? "bitmap" : "addresses") << "\n";
+    return {};
+}
+
+std::expected<std::optional<FloatRange>, std::string> BatchRunner::floatRange(std::string_view valueText) const
+{
+    if(type != Value::ValueType::Float && type != Value::ValueType::Double)
+        return std::nullopt;
+
+    std::expected<FloatRange, ValueError> parsed = std::unexpected{ValueError::InvalidFormat};
+
+    if(auto dots = valueText.find(".."); dots != std::string_view::npos)
+        parsed = FloatRange::between(type, valueText.substr(0, dots), valueText.substr(dots + 2));
+    else if(rounding)
+        parsed = FloatRange::shown(type, valueText, *rounding, roundingUlps);
+    else
+        return std::nullopt;
+
+    if(!parsed)
+        return std::unexpected{"invalid range " + std::string(valueText)};
+
+    return *parsed;
+}
+
+BatchRunner::CommandResult BatchRunner::groupScan(std::string_view templateText)
+{
+    if(pid <= 0)
+        return std::unexpected{"group: attach a process first"};
+
+    if(auto alive = checkTarget("group"); !alive)
+        return alive;
+
+    auto parsed = GroupPattern::parse(templateText);
+
+    if(!parsed)
+        return std::unexpected{"group: invalid template " + std::string(templateText)};
+
+    group = std::move(*parsed);
+    value.reset();
+
+    Memory mem(pid);
+    session = std::make_unique<ScanSessions>(group->anchor().value, mem);
+
+    if(!scanner.scan(regions, *session, *group, mem))
+        return std::unexpected{"group: read error"};
+
+    reportScanStats();
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::nextScan(std::string_view valueText)
+{
+    if(!session)
+        return std::unexpected{"next: run scan first"};
+
+    if(auto alive = checkTarget("next"); !alive)
+        return alive;
+
+    if(group)
+    {
+        auto parsed = GroupPattern::parse(valueText);
+
+        if(!parsed)
+            return std::unexpected{"next: invalid template " + std::string(valueText)};
+
+        group = std::move(*parsed);
+        session->filterPrevious(*group, threads());
+
+        std::cerr << "remaining: " << session->size() << "\n";
+        return {};
+    }
+
+    auto range = floatRange(valueText);
+
+    if(!range)
+        return std::unexpected{"next: " + range.error()};
+
+    if(*range)
+    {
+        value = (*range)->value();
+        session->filterPrevious(**range, threads());
+
+        std::cerr << "remaining: " << session->size() << "\n";
+        return {};
+    }
+
+    auto parsed = Value::parse(type, valueText);
+
+    if(!parsed)
+        return std::unexpected{"next: invalid value " + std::string(valueText)};
+
+    value = *parsed;
+    session->filterPrevious(*value, threads());
+
+    std::cerr << "remaining: " << session->size() << "\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::compareScan(std::string_view changeText, std::string_view deltaText)
+{
+    if(!session || !value)
+        return std::unexpected{"compare: run scan first"};
+
+    if(auto alive = checkTarget("compare"); !alive)
+        return alive;
+
+    ValueChange change{};
+
+    if(changeText == "changed") change = ValueChange::Changed;
+    else if(changeText == "unchanged") change = ValueChange::Unchanged;
+    else if(changeText == "increased") change = ValueChange::Increased;
+    else if(changeText == "decreased") change = ValueChange::Decreased;
+    else if(changeText == "by") change = ValueChange::ChangedBy;
+    else return std::unexpected{"compare: unknown condition " + std::string(changeText)};
+
+    // тип берётся от первого сканирования, type после него на сравнение не влияет
+    Value delta = *value;
+
+    if(change == ValueChange::ChangedBy)
+    {
+        auto parsed = Value::parse(value->type(), deltaText);
+
+        if(!parsed)
+            return std::unexpected{"compare: invalid delta " + std::string(deltaText)};
+
+        delta = std::move(*parsed);
+    }
+
+    if(auto filtered = session->filterChanged(change, delta, threads()); !filtered)
+        return std::unexpected{"compare: " + std::string(changeText) + " is not defined for " + std::string(Value::typeName(value->type()))};
+
+    std::cerr << "remaining: " << session->size() << "\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::save(std::string_view file)
+{
+    if(!session || (!value && !group))
+        return std::unexpected{"save: no scan results"};
+
+    int fd = ::open(std::string(file).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if(fd < 0)
+        return std::unexpected{"save: cannot open " + std::string(file)};
+
+    bool written = false;
+    {
+        ResultWriter fileOut(fd, OutputFormat::Binary);
+
+        if(group)
+            fileOut.write(session->getData(), *group);
+        else
+            fileOut.write(session->getData(), *value);
+
+        written = fileOut.flush();
+    }
+
+    ::close(fd);
+
+    if(!written)
+        return std::unexpected{"save: write failed"};
+
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::write(std::string_view addressText, std::string_view valueText)
+{
+    if(pid <= 0)
+        return std::unexpected{"write: attach a process first"};
+
+    if(auto alive = checkTarget("write"); !alive)
+        return alive;
+
+    if(addressText.starts_with("0x"))
+        addressText.remove_prefix(2);
+
+    uintptr_t address = 0;
+
+    if(auto [ptr, ec] = std::from_chars(addressText.data(), addressText.data() + addressText.size(), address, 16);
+    ec != std::errc{} || ptr != addressText.data() + addressText.size()) return std::unexpected{"write: invalid address"};
+
+    auto parsed = Value::parse(type, valueText);
+
+    if(!parsed)
+        return std::unexpected{"write: invalid value " + std::string(valueText)};
+
+    std::vector<std::byte> bytes(parsed->size());
+    parsed->store(bytes.data());
+
+    if(!Memory(pid).writeBlock(address, bytes.size(), bytes.data()))
+        return std::unexpected{"write: failed"};
+
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::exportRelative(std::string_view file)
+{
+    if(!session || !value)
+        return std::unexpected{"export: no scan results"};
+
+    AddressResolver resolver(layout);
+    auto saved = RelativeResults::save(std::filesystem::path(file), session->getData(), resolver, value->type());
+
+    if(!saved)
+        return std::unexpected{"export: cannot write " + std::string(file)};
+
+    std::cerr << "exported: " << *saved << "\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::importRelative(std::string_view file)
+{
+    if(pid <= 0)
+        return std::unexpected{"import: attach a process first"};
+
+    if(auto alive = checkTarget("import"); !alive)
+        return alive;
+
+    auto loaded = RelativeResults::load(std::filesystem::path(file));
+
+    if(!loaded)
+        return std::unexpected{"import: cannot read " + std::string(file)};
+
+    if(loaded->records.empty())
+        return std::unexpected{"import: no records"};
+
+    auto prototype = Value::fromBytes(loaded->type, loaded->records.front().value);
+
+    if(!prototype)
+        return std::unexpected{"import: invalid record"};
+
+    type = loaded->type;
+    value = std::move(*prototype);
+    group.reset();
+
+    session = std::make_unique<ScanSessions>(*value, Memory(pid));
+
+    size_t placed = loaded->rebase(AddressResolver(layout), *session);
+
+    std::cerr << "imported: " << placed << " of " << loaded->records.size() << "\n";
+    return {};
+}
+
+ThreadPool& BatchRunner::threads()
+{
+    if(!pool)
+        pool = std::make_unique<ThreadPool>();
+
+    return *pool;
+}
+
+BatchRunner::CommandResult BatchRunner::signatureScan(std::string_view module, std::string_view signatureText)
+{
+    if(pid <= 0)
+        return std::unexpected{"aob: attach a process first"};
+
+    if(auto alive = checkTarget("aob"); !alive)
+        return alive;
+
+    auto signature = CodeSignature::parse(signatureText);
+
+    if(!signature)
+        return std::unexpected{"aob: invalid signature " + std::string(signatureText)};
+
+    Memory mem(pid);
+    auto matches = signatures.find(layout, module, *signature, mem);
+
+    if(!matches)
+        return std::unexpected{matches.error() == ScanError::InvalidRegion ? "aob: no executable regions of " + std::string(module) : std::string("aob: read error")};
+
+    char text[32];
+
+    for(const auto& match : *matches)
+    {
+        auto slash = match.module.rfind('/');
+        auto address = std::to_chars(text, text + sizeof(text), match.address, 16).ptr;
+        auto offset = std::to_chars(address + 1, text + sizeof(text), match.moduleOffset, 16).ptr;
+
+        out.writeLine("0x" + std::string(text, address) + " " + match.module.substr(slash + 1) + "+0x" + std::string(address + 1, offset));
+    }
+
+    std::cerr << "aob: " << matches->size() << " matches, " << signatures.lastScanned() << " modules scanned, "
+              << signatures.lastCached() << " from cache\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::snapshot()
+{
+    if(pid <= 0)
+        return std::unexpected{"snapshot: attach a process first"};
+
+    if(auto alive = checkTarget("snapshot"); !alive)
+        return alive;
+
+    auto taken = MemorySnapshot::take(Memory(pid), regions, pages, threads());
+
+    if(!taken)
+        return std::unexpected{"snapshot: read error"};
+
+    // держатся только два последних снимка, страницы старого освобождаются
+    previousSnapshot = std::move(lastSnapshot);
+    lastSnapshot = std::move(*taken);
+
+    std::cerr << "[snapshot] " << lastSnapshot->pageCount() << " pages, "
+              << pages->uniquePages() << " unique, "
+              << pages->storedBytes() << " bytes stored\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::diff(std::string_view sizeText)
+{
+    if(!previousSnapshot || !lastSnapshot)
+        return std::unexpected{"diff: take two snapshots first"};
+
+    size_t valueSize = 4;
+
+    if(!sizeText.empty())
+    {
+        auto parsed = parseCount(sizeText);
+
+        if(!parsed || (*parsed != 1 && *parsed != 2 && *parsed != 4 && *parsed != 8))
+            return std::unexpected{"diff: value size must be 1, 2, 4 or 8"};
+
+        valueSize = *parsed;
+    }
+
+    auto changes = previousSnapshot->diff(*lastSnapshot, threads(), valueSize);
+
+    size_t shown = limit == 0 ? changes.values.size() : std::min(limit, changes.values.size());
+    char text[2 + 2 * sizeof(uintptr_t)] = {'0', 'x'};
+
+    for(size_t i = 0; i < shown; ++i)
+    {
+        auto end = std::to_chars(text + 2, text + sizeof(text), changes.values[i], 16).ptr;
+        out.writeLine(std::string_view(text, end));
+    }
+
+    std::cerr << "[diff] " << changes.pages.size() << " of " << changes.comparedPages << " pages changed, "
+              << changes.values.size() << " values\n";
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::monitor(std::string_view durationText, std::string_view periodText)
+{
+    if(!session || !value)
+        return std::unexpected{"monitor: run scan first"};
+
+    if(auto alive = checkTarget("monitor"); !alive)
+        return alive;
+
+    auto duration = parseCount(durationText);
+
+    if(!duration)
+        return std::unexpected{"monitor: " + duration.error()};
+
+    std::chrono::microseconds period{1000};
+
+    if(!periodText.empty())
+    {
+        auto parsed = parseCount(periodText);
+
+        if(!parsed || *parsed == 0)
+            return std::unexpected{"monitor: invalid period " + std::string(periodText)};
+
+        period = std::chrono::microseconds(*parsed);
+    }
+
+    ChangeMonitor monitor(Memory(pid), *value);
+    monitor.watch(session->getData());
+    monitor.setPeriod(period);
+
+    auto armed = monitor.arm();
+
+    if(!armed)
+        return std::unexpected{"monitor: read error"};
+
+    // опрос в этом же потоке: команда всё равно ждёт окончания
+    auto begin = std::chrono::steady_clock::now();
+    auto deadline = begin + std::chrono::milliseconds(*duration);
+
+    for(auto next = begin; next < deadline && monitor.pending() > 0;)
+    {
+        if(auto polled = monitor.pollOnce(); !polled)
+            return std::unexpected{"monitor: read error"};
+
+        next = std::max(next + period, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(std::min(next, deadline));
+    }
+
+    auto hits = monitor.hits();
+    size_t shown = limit == 0 ? hits.size() : std::min(limit, hits.size());
+
+    std::vector<std::byte> bytes(value->size());
+    char text[160];
+
+    for(size_t i = 0; i < shown; ++i)
+    {
+        const auto& hit = hits[i];
+
+        char* end = text;
+        *end++ = '0';
+        *end++ = 'x';
+        end = std::to_chars(end, text + sizeof(text), hit.address, 16).ptr;
+        *end++ = ' ';
+        end = std::to_chars(end, text + sizeof(text), std::chrono::duration_cast<std::chrono::microseconds>(hit.time).count()).ptr;
+        end = std::copy_n("us ", 3, end);
+
+        hit.previous.store(bytes.data());
+        end = hit.previous.format(bytes, end, text + sizeof(text) - 4);
+        end = std::copy_n(" -> ", 4, end);
+
+        hit.current.store(bytes.data());
+        end = hit.current.format(bytes, end, text + sizeof(text));
+
+        out.writeLine(std::string_view(text, static_cast<size_t>(end - text)));
+    }
+
+    auto stats = monitor.stats();
+
+    std::cerr << "[monitor] " << hits.size() << " of " << *armed << " changed, "
+              << stats.ticks << " ticks, " << stats.pagesPerTick << " of " << stats.activePages << " pages per tick, sweep "
+              << std::chrono::duration_cast<std::chrono::microseconds>(stats.sweep).count() << " us, tick "
+              << std::chrono::duration_cast<std::chrono::microseconds>(stats.tickCost).count() << " us\n";
+    return {};
+}
+
+void BatchRunner::reportScanStats() const
+{
+    std::cerr << "found: " << session->size() << "\n";
+    std::cerr << "[arena] peak " << session->getArena().peakReserved() << " bytes\n";
+
+    if(session->bitmapHits() > 0)
+        std::cerr << "[bitmap] " << session->bitmapHits() << " hits in " << session->bitmapBytes() << " bytes\n";
+
+    if(scanner.lastStats().queuedReads > 0)
+        std::cerr << "[uring] " << scanner.lastStats().queuedReads << " reads\n";
+
+    if(scanner.lastStats().bytesMapped > 0)
+        std::cerr << "[images] " << scanner.lastStats().bytesMapped << " bytes from files\n";
+
+    if(throttle)
+    {
+        auto limits = throttle->stats();
+        std::cerr << "[throttle] slept " << std::chrono::duration_cast<std::chrono::milliseconds>(limits.slept).count()
+                  << " ms, " << limits.backoffs << " backoffs, rate " << static_cast<size_t>(limits.rate) << " B/s\n";
+    }
+}
+
+void BatchRunner::rebuildThrottle()
+{
+    // сначала отвязываем сканер: старый ограничитель сейчас будет разрушен
+    scanner.setThrottle(nullptr);
+    throttle.reset();
+
+    if(!throttleConfig || pid <= 0)
+        return;
+
+    throttle = std::make_unique<ScanThrottle>(std::vector<pid_t>{pid}, *throttleConfig);
+    scanner.setThrottle(throttle.get());
+}
+
+BatchRunner::CommandResult BatchRunner::setThrottle(std::string_view rateText)
+{
+    if(rateText == "off")
+    {
+        throttleConfig.reset();
+        rebuildThrottle();
+        return {};
+    }
+
+    size_t multiplier = 1;
+
+    if(!rateText.empty())
+    {
+        switch(rateText.back())
+        {
+            case 'K': case 'k': multiplier = size_t{1} << 10; break;
+            case 'M': case 'm': multiplier = size_t{1} << 20; break;
+            case 'G': case 'g': multiplier = size_t{1} << 30; break;
+            default: break;
+        }
+    }
+
+    if(multiplier != 1)
+        rateText.remove_suffix(1);
+
+    auto parsed = parseCount(rateText);
+
+    if(!parsed)
+        return std::unexpected{"throttle: " + parsed.error()};
+
+    ThrottleConfig config{};
+    config.bytesPerSecond = *parsed * multiplier;
+
+    throttleConfig = config;
+    rebuildThrottle();
+    return {};
+}
+
+BatchRunner::CommandResult BatchRunner::checkTarget(std::string_view command) const
+{
+    // время старта неизвестно, если stat не прочитался при attach -- тогда проверять нечем
+    if(attached.startTime != 0 && !ProcessCache::isAlive(attached))
+        return std::unexpected{std::string(command) + ": process " + std::to_string(pid) + " exited or its pid was reused"};
+
+    return {};
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <expected>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/Process/ProcessFinder.hpp"
+#include "core/Process/ProcessReader.hpp"
+#include "core/Process/ProcessScanner.hpp"
+#include "core/Process/ModuleMapParser.hpp"
+#include "core/Process/ModuleFilter.hpp"
+#include "core/Process/RegionClassifier.hpp"
+#include "core/Scanner/changeMonitor.hpp"
+#include "core/Scanner/floatRange.hpp"
+#include "core/Scanner/groupPattern.hpp"
+#include "core/Scanner/memorySnapshot.hpp"
+#include "core/Scanner/scanner.hpp"
+#include "core/Scanner/scanSession.hpp"
+#include "core/Scanner/signatureScanner.hpp"
+#include "core/Scanner/threadPool.hpp"
+#include "core/Scanner/value.hpp"
+#include "core/Scanner/valueProfile.hpp"
+#include "ResultWriter.hpp"
+#include "RelativeResults.hpp"
+
+/**
+ * @brief Неинтерактивный режим: выполняет поток команд из файла или stdin
+ *
+ * Команды, по одной на строку ('#' -- комментарий):
+ *
+ *     find [comm|cmdline|exe] <text> -- список процессов по подстроке (по умолчанию в имени)
+ *     attach <pid>              -- прочитать и отфильтровать регионы процесса
+ *     policy <file> <name>      -- фильтровать регионы политикой из файла
+ *     type <i8..u64|f32|f64>    -- тип значений для scan/next/write
+ *     float <exact|truncated|rounded|ulp [n]>
+ *                               -- как число f32/f64 сравнивается с памятью: с погрешностью 0.1 (exact)
+ *                                  или как показанное на экране (отброшены/округлены знаки, n шагов сетки)
+ *     profile [top]             -- самые частые значения типа type в выборке из регионов
+ *     estimate <value>          -- сколько совпадений даст scan, по той же выборке
+ *     scan <value>              -- первое сканирование, для f32/f64 также <min>..<max>
+ *     group <+off:type:value>.. -- первое сканирование по шаблону структуры
+ *     next <value|шаблон>       -- отсев по новому значению или шаблону
+ *     compare <changed|unchanged|increased|decreased|by <delta>>
+ *                               -- отсев по сравнению с прошлым значением каждого адреса
+ *     print [limit]             -- вывести результаты
+ *     count                     -- вывести число результатов
+ *     save <file>               -- сохранить результаты в двоичном формате
+ *     export <file>             -- сохранить результаты относительно модулей (не зависит от ASLR)
+ *     import <file>             -- перенести сохранённые export результаты на подключённый процесс
+ *     write <addr> <value>      -- записать значение по адресу
+ *     aob <module|*> <signature> -- найти байты кода ("48 8B ?? ?? C3") в исполняемых регионах модуля
+ *     snapshot                  -- снимок регионов в сжатое хранилище страниц
+ *     diff [1|2|4|8]            -- изменившиеся значения между двумя последними снимками
+ *     monitor <ms> [period_us]  -- опрос страниц с результатами (по умолчанию каждые 1000 мкс):
+ *                                  первое изменение каждого адреса, его время и новое значение
+ *     throttle <rate|off>       -- потолок скорости чтения (байт/с, суффиксы K/M/G, 0 -- без потолка) с торможением
+ *                                  при нагрузке на цель и потоками на свободных от неё процессорах
+ *     reads <queued|sync>       -- читать память через io_uring или process_vm_readv
+ *     images <on|off>           -- брать не изменённые регионы файлов с диска, а не из процесса
+ *     format <text|ndjson|binary>
+ *     limit <n>                 -- ограничение вывода по умолчанию, 0 -- без ограничения
+ *     quit
+ *
+ * Результаты идут в stdout через ResultWriter, диагностика -- в stderr
+ */
+class BatchRunner
+{
+public:
+    BatchRunner(OutputFormat format, size_t limit);
+
+    /**
+     * @brief Выполняет команды до конца потока или quit
+     *
+     * @param commands поток команд
+     * @return int 0 при успехе, 1 если команда завершилась ошибкой (выполнение прерывается)
+     */
+    int run(std::istream& commands);
+
+private:
+    using CommandResult = std::expected<void, std::string>;
+
+    CommandResult execute(std::string_view line);
+
+    CommandResult find(std::string_view fieldOrText, std::string_view text);
+    CommandResult attach(std::string_view pidText);
+    CommandResult policy(std::string_view file, std::string_view name);
+    CommandResult firstScan(std::string_view valueText);
+    CommandResult groupScan(std::string_view templateText);
+    CommandResult nextScan(std::string_view valueText);
+    CommandResult compareScan(std::string_view changeText, std::string_view deltaText);
+    CommandResult save(std::string_view file);
+    CommandResult exportRelative(std::string_view file);
+    CommandResult importRelative(std::string_view file);
+    CommandResult write(std::string_view addressText, std::string_view valueText);
+    CommandResult signatureScan(std::string_view module, std::string_view signatureText);
+    CommandResult snapshot();
+    CommandResult diff(std::string_view sizeText);
+    CommandResult profile(std::string_view topText);
+    CommandResult estimate(std::string_view valueText);
+    CommandResult monitor(std::string_view durationText, std::string_view periodText);
+    CommandResult setThrottle(std::string_view rateText);
+
+    /**
+     * @brief Интервал для f32/f64: "min..max" или число при включённом float-режиме
+     *
+     * @return std::expected<std::optional<FloatRange>, std::string> nullopt -- обычное сравнение Value
+     */
+    std::expected<std::optional<FloatRange>, std::string> floatRange(std::string_view valueText) const;
+
+    /// @brief Ошибка, если подключённый процесс завершился или pid занят другим процессом
+    CommandResult checkTarget(std::string_view command) const;
+
+    /// @brief Печатает в stderr итог первого сканирования: найдено, арена, карты, io_uring, образы, ограничитель
+    void reportScanStats() const;
+
+    /// @brief Пересоздаёт ограничитель под текущий pid
+    void rebuildThrottle();
+
+    /// @brief Пул создаётся при первой команде, которой он нужен
+    ThreadPool& threads();
+
+    ProcessScanner procScanner{};
+    ProcessReader reader{};
+    ProcessFinder finder;
+    ProcessCache cache;
+    ModuleMapParser parser;
+    ModuleFilter filter{};
+    RegionClassifier classifier;
+    Scanner scanner{};
+
+    std::optional<RegionRuleSet> rules{};
+    pid_t pid = 0;
+    ProcessKey attached{}; // pid и время старта подключённого процесса
+    std::vector<MemoryRegion> regions{};
+    std::vector<MemoryRegion> layout{}; // все регионы до фильтрации, для модульных адресов
+
+    Value::ValueType type = Value::ValueType::Int32;
+    std::optional<FloatRange::Rounding> rounding{}; // nullopt -- сравнение с погрешностью
+    unsigned roundingUlps = 4;
+    std::optional<Value> value{};
+    std::optional<GroupPattern> group{};
+    std::unique_ptr<ScanSessions> session{};
+    SignatureScanner signatures{}; // кеш по build-id переживает attach к другому процессу
+
+    std::optional<ThrottleConfig> throttleConfig{};
+    std::unique_ptr<ScanThrottle> throttle{};
+
+    std::unique_ptr<ThreadPool> pool{};
+    std::shared_ptr<PageStore> pages{}; // общее хранилище страниц снимков подключённого процесса
+    std::optional<MemorySnapshot> previousSnapshot{};
+    std::optional<MemorySnapshot> lastSnapshot{};
+    std::optional<ValueProfile> sampled{}; // выборка подключённого процесса, сбрасывается при attach
+
+    ResultWriter out;
+    size_t limit;
+};
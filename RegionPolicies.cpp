@@ -1,10 +1,11 @@
 #include "RegionPolicies.hpp"
+#include <fstream>
 /**
  * @brief Заполняет конфиг фильтрации регионов именно для сканирования
  * 
  * @return ModuleFilterConfig Заполненый кфг 
  */
-ModuleFilterConfig RegionPolicies::forScan()
+ModuleFilterConfig RegionPolicies::forScan() noexcept
 {
     ModuleFilterConfig config{};
     config.onlyWritable = true;
@@ -13,6 +14,76 @@ ModuleFilterConfig RegionPolicies::forScan()
     config.includeAnonymous = true;
     config.includeDrivers = false;
     config.includeTemporaryFile = false;
+    config.skipNonResident = true;
 
     return config;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Читает именованные политики из файла
+ * 
+ * Строки до первой секции [name] игнорируются, правила каждой секции компилируются сразу
+ * 
+ * @param file путь к файлу политик
+ * @return std::expected<std::map<std::string, RegionRuleSet>, RuleError> политики по именам
+ * @retval RuleError::SourceUnavailable если файл не открылся
+ * @retval ошибка RegionRuleSet::addRule() если правило не разобрано
+ */
+std::expected<std::map<std::string, RegionRuleSet>, RuleError> RegionPolicies::load(const std::filesystem::path& file)
+{
+    std::ifstream input(file);
+
+    if(!input.is_open())
+        return std::unexpected{RuleError::SourceUnavailable};
+
+    std::map<std::string, RegionRuleSet> policies{};
+    RegionRuleSet* current = nullptr;
+    std::string line;
+
+    while(std::getline(input, line))
+    {
+        auto first = line.find_first_not_of(" \t");
+
+        if(first != std::string::npos && line[first] == '[')
+        {
+            auto close = line.find(']', first);
+
+            if(close == std::string::npos)
+                return std::unexpected{RuleError::SyntaxError};
+
+            current = &policies[line.substr(first + 1, close - first - 1)];
+            continue;
+        }
+
+        if(!current)
+            continue;
+
+        if(auto added = current->addRule(line); !added)
+            return std::unexpected{added.error()};
+    }
+
+    return policies;
+}
+
+/**
+ * @brief Читает одну политику по имени
+ * 
+ * @param file путь к файлу политик
+ * @param name имя секции
+ * @return std::expected<RegionRuleSet, RuleError> скомпилированная политика
+ * @retval RuleError::NotFound если секции с таким именем нет
+ */
+std::expected<RegionRuleSet, RuleError> RegionPolicies::load(const std::filesystem::path& file, std::string_view name)
+{
+    auto policies = load(file);
+
+    if(!policies)
+        return std::unexpected{policies.error()};
+
+    auto it = policies->find(std::string(name));
+
+    if(it == policies->end())
+        return std::unexpected{RuleError::NotFound};
+
+    return std::move(it->second);
+}
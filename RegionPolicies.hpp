@@ -1,11 +1,30 @@
 #pragma once
+#include <expected>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
 #include "core/Process/ModuleFilter.hpp"
+#include "core/Process/RegionRules.hpp"
 
 /**
  * @brief выбор политики для настройки конфига фильтрации регионов
  * 
+ * Именованные политики хранятся в файле секциями:
+ * 
+ *     [scan]
+ *     default include
+ *     exclude !perms=?w
+ * 
+ * синтаксис правил описан в RegionRuleSet
  */
 namespace RegionPolicies
 {
     ModuleFilterConfig forScan() noexcept; /// предназначен для сканнера, возвращает заполненый cfg
+
+    /// читает все политики из файла, ключ -- имя секции
+    std::expected<std::map<std::string, RegionRuleSet>, RuleError> load(const std::filesystem::path& file);
+
+    /// читает одну политику по имени, RuleError::NotFound если секции нет
+    std::expected<RegionRuleSet, RuleError> load(const std::filesystem::path& file, std::string_view name);
 }
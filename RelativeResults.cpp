@@ -0,0 +1,199 @@
+#include "RelativeResults.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+namespace
+{
+    constexpr char hexDigits[] = "0123456789abcdef";
+
+    /// @brief Следующее поле строки до пробела
+    std::string_view nextField(std::string_view& rest)
+    {
+        auto field = rest.substr(0, rest.find(' '));
+        rest.remove_prefix(std::min(rest.size(), field.size() + 1));
+        return field;
+    }
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& number, int base = 10)
+    {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number, base);
+        return ec == std::errc{} && ptr == text.data() + text.size() && !text.empty();
+    }
+
+    bool parseHexBytes(std::string_view text, std::vector<std::byte>& out)
+    {
+        if(text.size() % 2 != 0)
+            return false;
+
+        out.resize(text.size() / 2);
+
+        for(size_t i = 0; i < out.size(); ++i)
+        {
+            uint8_t byte = 0;
+
+            if(!parseNumber(text.substr(i * 2, 2), byte, 16))
+                return false;
+
+            out[i] = static_cast<std::byte>(byte);
+        }
+        return true;
+    }
+}
+
+std::expected<size_t, ExportError> RelativeResults::save
+(
+    const std::filesystem::path& path,
+    std::span<const ScanResult> results,
+    const AddressResolver& resolver,
+    Value::ValueType type
+)
+{
+    std::ofstream file(path, std::ios::trunc);
+
+    if(!file)
+        return std::unexpected{ExportError::SourceUnavailable};
+
+    auto annotated = resolver.annotate(results);
+
+    // в файл попадают только модули, на которые есть записи, с новой нумерацией
+    constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> fileIndex{};
+    uint32_t modulesWritten = 0;
+
+    file << "LURR 1 " << Value::typeName(type) << '\n';
+
+    for(const auto& address : annotated)
+    {
+        if(!address) continue;
+
+        if(address->module >= fileIndex.size())
+            fileIndex.resize(address->module + 1, unused);
+
+        if(fileIndex[address->module] == unused)
+        {
+            fileIndex[address->module] = modulesWritten;
+            file << "M " << modulesWritten++ << ' ' << resolver.moduleName(address->module) << '\n';
+        }
+    }
+
+    size_t saved = 0;
+    std::string line{};
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& address = annotated[i];
+
+        if(!address) continue;
+
+        char number[32];
+        line.assign("R ");
+
+        auto appendNumber = [&](auto value, int base)
+        {
+            line.append(number, std::to_chars(number, number + sizeof(number), value, base).ptr);
+            line.push_back(' ');
+        };
+
+        appendNumber(fileIndex[address->module], 10);
+        appendNumber(address->regionOffset, 16);
+        appendNumber(address->ordinal, 10);
+        appendNumber(address->offset, 16);
+
+        for(auto b : results[i].value)
+        {
+            line.push_back(hexDigits[static_cast<uint8_t>(b) >> 4]);
+            line.push_back(hexDigits[static_cast<uint8_t>(b) & 0xf]);
+        }
+
+        line.push_back('\n');
+        file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        ++saved;
+    }
+
+    if(!file.flush())
+        return std::unexpected{ExportError::WriteError};
+
+    return saved;
+}
+
+std::expected<RelativeResults, ExportError> RelativeResults::load(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+
+    if(!file)
+        return std::unexpected{ExportError::SourceUnavailable};
+
+    std::string line{};
+
+    if(!std::getline(file, line) || !line.starts_with("LURR 1 "))
+        return std::unexpected{ExportError::InvalidFormat};
+
+    auto type = Value::typeFromName(std::string_view(line).substr(7));
+
+    if(!type)
+        return std::unexpected{ExportError::InvalidFormat};
+
+    RelativeResults loaded{};
+    loaded.type = *type;
+
+    while(std::getline(file, line))
+    {
+        std::string_view rest(line);
+        auto kind = nextField(rest);
+
+        if(kind == "M")
+        {
+            uint32_t index = 0;
+
+            if(!parseNumber(nextField(rest), index) || index != loaded.modules.size())
+                return std::unexpected{ExportError::InvalidFormat};
+
+            // путь -- остаток строки, в нём могут быть пробелы
+            loaded.modules.emplace_back(rest);
+        }
+        else if(kind == "R")
+        {
+            RelativeRecord record{};
+
+            if(!parseNumber(nextField(rest), record.module) || record.module >= loaded.modules.size() ||
+               !parseNumber(nextField(rest), record.regionOffset, 16) ||
+               !parseNumber(nextField(rest), record.ordinal) ||
+               !parseNumber(nextField(rest), record.offset, 16) ||
+               !parseHexBytes(nextField(rest), record.value))
+                return std::unexpected{ExportError::InvalidFormat};
+
+            loaded.records.push_back(std::move(record));
+        }
+        else if(!kind.empty())
+        {
+            return std::unexpected{ExportError::InvalidFormat};
+        }
+    }
+
+    return loaded;
+}
+
+size_t RelativeResults::rebase(const AddressResolver& resolver, ScanSessions& session) const
+{
+    std::vector<std::pair<uintptr_t, size_t>> placed{};
+    placed.reserve(records.size());
+
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        const auto& record = records[i];
+
+        if(auto address = resolver.resolve(modules[record.module], record.regionOffset, record.ordinal, record.offset))
+            placed.emplace_back(*address, i);
+    }
+
+    std::ranges::sort(placed);
+
+    for(const auto& [address, index] : placed)
+        session.add(address, records[index].value);
+
+    return placed.size();
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "core/Scanner/addressResolver.hpp"
+#include "core/Scanner/scanSession.hpp"
+#include "core/Scanner/value.hpp"
+
+enum class ExportError
+{
+    SourceUnavailable, // файл не открылся
+    InvalidFormat, // файл не в формате LURR
+    WriteError
+};
+
+/**
+ * @brief Результат в модульном виде: индекс модуля в RelativeResults::modules и смещения
+ */
+struct RelativeRecord
+{
+    uint32_t module = 0;
+    uint32_t ordinal = 0;
+    uintptr_t regionOffset = 0;
+    uintptr_t offset = 0;
+    std::vector<std::byte> value{};
+};
+
+/**
+ * @brief Сохранённые результаты, не привязанные к раскладке памяти процесса
+ *
+ * Текстовый формат, по записи на строку:
+ *
+ *     LURR 1 <тип>
+ *     M <индекс> <путь модуля>
+ *     R <модуль> <regionOffset hex> <ordinal> <offset hex> <байты hex>
+ *
+ * После перезапуска цели результаты переносятся на новый pid через rebase()
+ * без повторного первого сканирования
+ */
+struct RelativeResults
+{
+    Value::ValueType type = Value::ValueType::Int32;
+    std::vector<std::string> modules{};
+    std::vector<RelativeRecord> records{};
+
+    /**
+     * @brief Переводит результаты в модульный вид и пишет в файл
+     *
+     * Адреса, не попавшие ни в один регион резолвера, пропускаются
+     *
+     * @return std::expected<size_t, ExportError> сколько записей сохранено
+     */
+    static std::expected<size_t, ExportError> save
+    (
+        const std::filesystem::path& path,
+        std::span<const ScanResult> results,
+        const AddressResolver& resolver,
+        Value::ValueType type
+    );
+
+    static std::expected<RelativeResults, ExportError> load(const std::filesystem::path& path);
+
+    /**
+     * @brief Переносит записи в раскладку другого процесса
+     *
+     * Записи добавляются в сессию по возрастанию новых адресов, байты -- сохранённые,
+     * так что следующий filterPrevious() работает как после первого сканирования
+     *
+     * @return size_t сколько записей удалось перенести
+     */
+    size_t rebase(const AddressResolver& resolver, ScanSessions& session) const;
+};
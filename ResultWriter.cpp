@@ -0,0 +1,282 @@
+#include "ResultWriter.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <unistd.h>
+
+namespace
+{
+    constexpr char hexDigits[] = "0123456789abcdef";
+
+    char* appendHexBytes(char* out, std::span<const std::byte> bytes) noexcept
+    {
+        for(auto b : bytes)
+        {
+            *out++ = hexDigits[static_cast<uint8_t>(b) >> 4];
+            *out++ = hexDigits[static_cast<uint8_t>(b) & 0xf];
+        }
+        return out;
+    }
+
+    /**
+     * @brief Выводит строковое значение как строку JSON
+     *
+     * Управляющие символы Value::format уже заменил, экранируются только '"' и '\\'
+     */
+    char* appendJsonString(char* out, const Value& type, std::span<const std::byte> bytes)
+    {
+        std::array<char, 64 + Value::maxTextLength * 4> text;
+        char* end = type.format(bytes, text.data(), text.data() + text.size());
+
+        *out++ = '"';
+
+        for(const char* c = text.data(); c != end; ++c)
+        {
+            if(*c == '"' || *c == '\\')
+                *out++ = '\\';
+
+            *out++ = *c;
+        }
+
+        *out++ = '"';
+        return out;
+    }
+
+    /**
+     * @brief Выводит одно значение: число или строку, в JSON -- с кавычками или null
+     */
+    char* appendValue(char* out, const Value& type, std::span<const std::byte> bytes, bool json)
+    {
+        if(!json)
+            return type.format(bytes, out, out + 64 + bytes.size() * 4);
+
+        if(type.textPattern())
+            return appendJsonString(out, type, bytes);
+
+        char* number = out;
+        out = type.format(bytes, out, out + 64);
+
+        // inf и nan не являются числами JSON
+        if(std::string_view text(number, out - number); text.empty() || text.find_first_of("in") != std::string_view::npos)
+            out = std::copy_n("null", 4, number);
+
+        return out;
+    }
+
+    char* appendAddress(char* out, uintptr_t address) noexcept
+    {
+        *out++ = '0';
+        *out++ = 'x';
+        return std::to_chars(out, out + 16, address, 16).ptr;
+    }
+}
+
+ResultWriter::ResultWriter(int fd, OutputFormat format, size_t bufferSize)
+    : fd(fd), format(format), buffer(bufferSize < 4096 ? 4096 : bufferSize) {}
+
+ResultWriter::~ResultWriter()
+{
+    flush();
+}
+
+void ResultWriter::setFormat(OutputFormat format) noexcept
+{
+    flush();
+    this->format = format;
+}
+
+OutputFormat ResultWriter::getFormat() const noexcept
+{
+    return format;
+}
+
+/**
+ * @brief Форматирует результаты прямо в буфер вывода
+ *
+ * На одну запись резервируется место под худший случай, буфер сбрасывается
+ * в дескриптор только когда места не хватает
+ */
+void ResultWriter::write(std::span<const ScanResult> results, const Value& type, size_t limit)
+{
+    writeRecords(results, limit, 64, [&](char* out, std::span<const std::byte> bytes, bool json)
+    {
+        return bytes.size() >= type.size() ? appendValue(out, type, bytes, json) : out;
+    });
+}
+
+/**
+ * @brief Выводит результаты сканирования структуры
+ *
+ * Поля выводятся по возрастанию смещения: через ',' в тексте и массивом в NDJSON
+ */
+void ResultWriter::write(std::span<const ScanResult> results, const GroupPattern& group, size_t limit)
+{
+    std::vector<const GroupField*> fields{};
+
+    for(const auto& field : group.fields())
+        fields.push_back(&field);
+
+    std::ranges::sort(fields, {}, &GroupField::offset);
+
+    writeRecords(results, limit, 66 * fields.size(), [&](char* out, std::span<const std::byte> bytes, bool json)
+    {
+        if(bytes.size() < group.size())
+            return out;
+
+        if(json) *out++ = '[';
+
+        for(size_t i = 0; i < fields.size(); ++i)
+        {
+            if(i > 0) *out++ = ',';
+
+            out = appendValue(out, fields[i]->value, bytes.subspan(fields[i]->offset, fields[i]->value.size()), json);
+        }
+
+        if(json) *out++ = ']';
+        return out;
+    });
+}
+
+/**
+ * @brief Общий цикл вывода записей
+ *
+ * @param room сколько символов кроме 4 на байт значения может занять formatValue
+ * @param formatValue formatValue(out, байты, json) пишет значение и возвращает конец
+ */
+template <typename F>
+void ResultWriter::writeRecords(std::span<const ScanResult> results, size_t limit, size_t room, F&& formatValue)
+{
+    size_t count = limit == 0 ? results.size() : std::min(limit, results.size());
+
+    if(format == OutputFormat::Binary)
+    {
+        char* out = reserve(12);
+        std::memcpy(out, "LURS", 4);
+        uint64_t records = count;
+        std::memcpy(out + 4, &records, sizeof(records));
+        used += 12;
+    }
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto& r = results[i];
+        std::span<const std::byte> bytes(r.value);
+
+        // строка из UTF-16 в UTF-8 и экранирование JSON дают не больше 4 символов на байт
+        char* out = reserve(96 + bytes.size() * 6 + room * 2);
+        char* begin = out;
+
+        switch (format)
+        {
+            case OutputFormat::Text:
+            {
+                out = appendAddress(out, r.address);
+                *out++ = ' ';
+
+                if(char* value = formatValue(out, bytes, false); value != out)
+                {
+                    out = value;
+                    *out++ = ' ';
+                }
+
+                out = appendHexBytes(out, bytes);
+                *out++ = '\n';
+                break;
+            }
+            case OutputFormat::Ndjson:
+            {
+                constexpr std::string_view addressKey = "{\"address\":\"";
+                constexpr std::string_view valueKey = "\",\"value\":";
+                constexpr std::string_view bytesKey = ",\"bytes\":\"";
+
+                out = std::copy(addressKey.begin(), addressKey.end(), out);
+                out = appendAddress(out, r.address);
+                out = std::copy(valueKey.begin(), valueKey.end(), out);
+
+                if(char* value = formatValue(out, bytes, true); value != out)
+                    out = value;
+                else
+                    out = std::copy_n("null", 4, out);
+
+                out = std::copy(bytesKey.begin(), bytesKey.end(), out);
+                out = appendHexBytes(out, bytes);
+                *out++ = '"';
+                *out++ = '}';
+                *out++ = '\n';
+                break;
+            }
+            case OutputFormat::Binary:
+            {
+                uint64_t address = r.address;
+                uint32_t size = static_cast<uint32_t>(bytes.size());
+
+                std::memcpy(out, &address, sizeof(address));
+                out += sizeof(address);
+                std::memcpy(out, &size, sizeof(size));
+                out += sizeof(size);
+                std::memcpy(out, bytes.data(), bytes.size());
+                out += bytes.size();
+                break;
+            }
+        }
+
+        used += static_cast<size_t>(out - begin);
+    }
+}
+
+void ResultWriter::writeLine(std::string_view text)
+{
+    append(text);
+    append("\n");
+}
+
+bool ResultWriter::flush()
+{
+    size_t written = 0;
+
+    while(written < used)
+    {
+        ssize_t n = ::write(fd, buffer.data() + written, used - written);
+
+        if(n <= 0)
+        {
+            used = 0;
+            return false;
+        }
+
+        written += static_cast<size_t>(n);
+    }
+
+    used = 0;
+    return true;
+}
+
+void ResultWriter::append(std::string_view text)
+{
+    while(!text.empty())
+    {
+        size_t chunk = std::min(text.size(), buffer.size());
+        char* out = reserve(chunk);
+
+        std::memcpy(out, text.data(), chunk);
+        used += chunk;
+        text.remove_prefix(chunk);
+    }
+}
+
+/**
+ * @brief Гарантирует size свободных байт в буфере
+ *
+ * @return char* место для записи, used увеличивает вызывающий
+ */
+char* ResultWriter::reserve(size_t size)
+{
+    if(buffer.size() - used < size)
+        flush();
+
+    if(buffer.size() < size)
+        buffer.resize(size);
+
+    return buffer.data() + used;
+}
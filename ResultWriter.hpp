@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "core/Scanner/groupPattern.hpp"
+#include "core/Scanner/scanSession.hpp"
+#include "core/Scanner/value.hpp"
+
+/**
+ * @brief Формат вывода результатов
+ *
+ * Text -- "0xADDR VALUE BYTES" по строке на результат
+ * Ndjson -- {"address":"0x..","value":..,"bytes":".."} по строке на результат
+ * Binary -- "LURS", uint64 число записей, затем записи (uint64 адрес, uint32 размер, байты)
+ */
+enum class OutputFormat
+{
+    Text,
+    Ndjson,
+    Binary
+};
+
+/**
+ * @brief Буферизированный вывод результатов сканирования в файловый дескриптор
+ *
+ * Результаты форматируются пачкой в большой буфер без iostream и пишутся
+ * одним write() при заполнении буфера, а не построчно с flush
+ */
+class ResultWriter
+{
+public:
+    explicit ResultWriter(int fd, OutputFormat format = OutputFormat::Text, size_t bufferSize = 1 << 20);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    void setFormat(OutputFormat format) noexcept;
+    [[nodiscard]] OutputFormat getFormat() const noexcept;
+
+    /**
+     * @brief Выводит результаты сессии
+     *
+     * @param results результаты
+     * @param type значение, задающее тип для форматирования числа
+     * @param limit сколько результатов вывести максимум, 0 -- без ограничения
+     */
+    void write(std::span<const ScanResult> results, const Value& type, size_t limit = 0);
+
+    /// @brief Выводит результаты сканирования по шаблону структуры, значения -- по полям
+    void write(std::span<const ScanResult> results, const GroupPattern& group, size_t limit = 0);
+
+    /// @brief Выводит произвольную строку, перевод строки добавляется
+    void writeLine(std::string_view text);
+
+    /// @brief Сбрасывает буфер в дескриптор, false при ошибке записи
+    bool flush();
+
+private:
+    template <typename F>
+    void writeRecords(std::span<const ScanResult> results, size_t limit, size_t room, F&& formatValue);
+
+    void append(std::string_view text);
+    char* reserve(size_t size);
+
+    int fd;
+    OutputFormat format;
+    std::vector<char> buffer;
+    size_t used = 0;
+};
@@ -0,0 +1,183 @@
+#include "daemonClient.hpp"
+#include <cstring>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    /// @brief Принимает байт-маркер и дескриптор кольца, -1 если его нет
+    int receiveDescriptor(int socketFd)
+    {
+        char marker = 0;
+        iovec iov{&marker, 1};
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if(::recvmsg(socketFd, &msg, MSG_CMSG_CLOEXEC) != 1 || marker != 'R')
+            return -1;
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+        if(!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            return -1;
+
+        int fd = -1;
+        std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        return fd;
+    }
+}
+
+std::expected<DaemonClient, DaemonError> DaemonClient::connect(const std::filesystem::path& socketPath)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    const auto& path = socketPath.native();
+
+    if(path.empty() || path.size() >= sizeof(addr.sun_path))
+        return std::unexpected{DaemonError::SocketError};
+
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if(fd < 0)
+        return std::unexpected{DaemonError::SocketError};
+
+    if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        ::close(fd);
+        return std::unexpected{DaemonError::SocketError};
+    }
+
+    int ringFd = receiveDescriptor(fd);
+
+    if(ringFd < 0)
+    {
+        ::close(fd);
+        return std::unexpected{DaemonError::ProtocolError};
+    }
+
+    auto ring = ResultRing::attach(ringFd);
+
+    if(!ring)
+    {
+        ::close(fd);
+        return std::unexpected{ring.error()};
+    }
+
+    return DaemonClient(fd, std::move(*ring));
+}
+
+DaemonClient::DaemonClient(int fd, ResultRing ring) noexcept
+    : fd(fd), ring(std::move(ring)) {}
+
+DaemonClient::~DaemonClient()
+{
+    if(fd >= 0)
+        ::close(fd);
+}
+
+DaemonClient::DaemonClient(DaemonClient&& other) noexcept
+    : fd(std::exchange(other.fd, -1)), ring(std::move(other.ring)),
+      inbox(std::move(other.inbox)), error(std::move(other.error)) {}
+
+std::expected<std::string, DaemonError> DaemonClient::request(std::string_view line)
+{
+    std::string message(line);
+    message += '\n';
+
+    for(std::string_view rest = message; !rest.empty();)
+    {
+        ssize_t n = ::send(fd, rest.data(), rest.size(), MSG_NOSIGNAL);
+
+        if(n <= 0)
+            return std::unexpected{DaemonError::Disconnected};
+
+        rest.remove_prefix(static_cast<size_t>(n));
+    }
+
+    size_t end = 0;
+
+    while((end = inbox.find('\n')) == std::string::npos)
+    {
+        char chunk[4096];
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+
+        if(n <= 0)
+            return std::unexpected{DaemonError::Disconnected};
+
+        inbox.append(chunk, static_cast<size_t>(n));
+    }
+
+    std::string answer = inbox.substr(0, end);
+    inbox.erase(0, end + 1);
+
+    if(answer.starts_with("err"))
+    {
+        error = answer.size() > 4 ? answer.substr(4) : std::string{};
+        return std::unexpected{DaemonError::CommandFailed};
+    }
+
+    if(!answer.starts_with("ok"))
+        return std::unexpected{DaemonError::ProtocolError};
+
+    return answer.size() > 3 ? answer.substr(3) : std::string{};
+}
+
+std::expected<size_t, DaemonError> DaemonClient::attach(pid_t pid)
+{
+    return requestNumber("attach " + std::to_string(pid));
+}
+
+std::expected<void, DaemonError> DaemonClient::setType(std::string_view name)
+{
+    auto answer = request("type " + std::string(name));
+
+    if(!answer)
+        return std::unexpected{answer.error()};
+
+    return {};
+}
+
+std::expected<size_t, DaemonError> DaemonClient::scan(std::string_view value)
+{
+    return requestNumber("scan " + std::string(value));
+}
+
+std::expected<size_t, DaemonError> DaemonClient::next(std::string_view value)
+{
+    return requestNumber("next " + std::string(value));
+}
+
+std::expected<size_t, DaemonError> DaemonClient::count()
+{
+    return requestNumber("count");
+}
+
+const std::string& DaemonClient::lastError() const noexcept
+{
+    return error;
+}
+
+std::expected<size_t, DaemonError> DaemonClient::requestNumber(std::string_view line)
+{
+    auto answer = request(line);
+
+    if(!answer)
+        return std::unexpected{answer.error()};
+
+    size_t number = 0;
+
+    if(std::from_chars(answer->data(), answer->data() + answer->size(), number).ec != std::errc{})
+        return std::unexpected{DaemonError::ProtocolError};
+
+    return number;
+}
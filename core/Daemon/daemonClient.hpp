@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+#include "resultRing.hpp"
+
+/**
+ * @brief Клиент ScanDaemon
+ *
+ * При подключении получает дескриптор кольца результатов и отображает его к себе,
+ * fetch() отдаёт записи прямо из общей памяти без копирования
+ */
+class DaemonClient
+{
+public:
+    /**
+     * @brief Подключается к демону
+     *
+     * @param socketPath путь к Unix-сокету демона
+     * @return std::expected<DaemonClient, DaemonError> подключённый клиент
+     * @retval DaemonError::SocketError если подключиться не удалось
+     * @retval DaemonError::ProtocolError если демон не передал кольцо
+     * @retval DaemonError::SharedMemoryError если кольцо не удалось отобразить
+     */
+    [[nodiscard]] static std::expected<DaemonClient, DaemonError> connect(const std::filesystem::path& socketPath);
+
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    DaemonClient(DaemonClient&& other) noexcept;
+    DaemonClient& operator=(DaemonClient&& other) = delete;
+
+    /**
+     * @brief Отправляет команду и ждёт ответ
+     *
+     * @param line команда без перевода строки
+     * @return std::expected<std::string, DaemonError> данные ответа после "ok"
+     * @retval DaemonError::CommandFailed демон ответил "err", текст доступен через lastError()
+     * @retval DaemonError::Disconnected соединение разорвано
+     */
+    std::expected<std::string, DaemonError> request(std::string_view line);
+
+    std::expected<size_t, DaemonError> attach(pid_t pid);
+    std::expected<void, DaemonError> setType(std::string_view name);
+    std::expected<size_t, DaemonError> scan(std::string_view value);
+    std::expected<size_t, DaemonError> next(std::string_view value);
+    std::expected<size_t, DaemonError> count();
+
+    /**
+     * @brief Забирает все результаты последнего scan/next
+     *
+     * @param callBack вызывается для каждой записи (uint64_t адрес, std::span<const std::byte> значение),
+     *        байты лежат прямо в общей памяти и действительны только до возврата из callBack
+     * @return std::expected<size_t, DaemonError> сколько записей получено
+     * @retval DaemonError::ProtocolError если ответ или записи кольца не сходятся
+     */
+    template <typename T>
+    std::expected<size_t, DaemonError> fetch(T&& callBack)
+    {
+        size_t total = 0;
+
+        while(true)
+        {
+            auto answer = request("fetch");
+
+            if(!answer)
+                return std::unexpected{answer.error()};
+
+            size_t pushed = 0;
+            size_t remaining = 0;
+            const char* end = answer->data() + answer->size();
+            auto first = std::from_chars(answer->data(), end, pushed);
+
+            if(first.ec != std::errc{} || first.ptr == end ||
+               std::from_chars(first.ptr + 1, end, remaining).ec != std::errc{})
+                return std::unexpected{DaemonError::ProtocolError};
+
+            auto drained = ring->drain(callBack);
+
+            if(!drained)
+                return std::unexpected{drained.error()};
+
+            if(*drained != pushed)
+                return std::unexpected{DaemonError::ProtocolError};
+
+            total += pushed;
+
+            if(remaining == 0)
+                return total;
+
+            // демон не смог записать ни одной записи в пустое кольцо -- дальше будет так же
+            if(pushed == 0)
+                return std::unexpected{DaemonError::ProtocolError};
+        }
+    }
+
+    [[nodiscard]] const std::string& lastError() const noexcept;
+
+private:
+    DaemonClient(int fd, ResultRing ring) noexcept;
+
+    std::expected<size_t, DaemonError> requestNumber(std::string_view line);
+
+    int fd = -1;
+    std::optional<ResultRing> ring{};
+    std::string inbox{};
+    std::string error{};
+};
@@ -0,0 +1,200 @@
+#include "resultRing.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr uint32_t ringMagic = 0x32474E52; // "RNG2"
+    constexpr size_t headerSize = 192;
+}
+
+std::expected<ResultRing, DaemonError> ResultRing::create(size_t capacity)
+{
+    static_assert(sizeof(Header) <= headerSize);
+
+    if(capacity == 0)
+        return std::unexpected{DaemonError::SharedMemoryError};
+
+    capacity = (capacity + 7) & ~size_t{7};
+
+    int fd = ::memfd_create("linuxUtilits-results", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if(fd < 0)
+        return std::unexpected{DaemonError::SharedMemoryError};
+
+    size_t size = headerSize + capacity;
+
+    // размер запечатывается до передачи клиенту: ftruncate с его стороны
+    // иначе оставил бы отображение демона без страниц, и запись упала бы в SIGBUS
+    if(::ftruncate(fd, static_cast<off_t>(size)) != 0 ||
+       ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        ::close(fd);
+        return std::unexpected{DaemonError::SharedMemoryError};
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if(mapping == MAP_FAILED)
+    {
+        ::close(fd);
+        return std::unexpected{DaemonError::SharedMemoryError};
+    }
+
+    auto* header = new (mapping) Header{};
+    header->magic = ringMagic;
+    header->capacity = capacity;
+
+    return ResultRing(fd, mapping, size, capacity);
+}
+
+std::expected<ResultRing, DaemonError> ResultRing::attach(int fd)
+{
+    struct stat st{};
+
+    if(::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < headerSize)
+    {
+        ::close(fd);
+        return std::unexpected{DaemonError::SharedMemoryError};
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if(mapping == MAP_FAILED)
+    {
+        ::close(fd);
+        return std::unexpected{DaemonError::SharedMemoryError};
+    }
+
+    const auto* header = static_cast<const Header*>(mapping);
+    uint64_t capacity = header->capacity;
+
+    ResultRing ring(fd, mapping, size, capacity);
+
+    if(header->magic != ringMagic || capacity == 0 || capacity % 8 != 0 || capacity > size - headerSize)
+        return std::unexpected{DaemonError::SharedMemoryError};
+
+    ring.position = header->tail.load(std::memory_order_acquire);
+
+    return ring;
+}
+
+ResultRing::ResultRing(int fd, void* mapping, size_t mappingSize, size_t bytes) noexcept
+    : memFd(fd), mapping(mapping), mappingSize(mappingSize), bytes(bytes) {}
+
+ResultRing::~ResultRing()
+{
+    if(mapping)
+        ::munmap(mapping, mappingSize);
+
+    if(memFd >= 0)
+        ::close(memFd);
+}
+
+ResultRing::ResultRing(ResultRing&& other) noexcept
+    : memFd(std::exchange(other.memFd, -1)), mapping(std::exchange(other.mapping, nullptr)),
+      mappingSize(std::exchange(other.mappingSize, 0)), bytes(std::exchange(other.bytes, 0)),
+      position(std::exchange(other.position, 0)) {}
+
+ResultRing& ResultRing::operator=(ResultRing&& other) noexcept
+{
+    if(this != &other)
+    {
+        if(mapping)
+            ::munmap(mapping, mappingSize);
+
+        if(memFd >= 0)
+            ::close(memFd);
+
+        memFd = std::exchange(other.memFd, -1);
+        mapping = std::exchange(other.mapping, nullptr);
+        mappingSize = std::exchange(other.mappingSize, 0);
+        bytes = std::exchange(other.bytes, 0);
+        position = std::exchange(other.position, 0);
+    }
+    return *this;
+}
+
+int ResultRing::fd() const noexcept
+{
+    return memFd;
+}
+
+size_t ResultRing::capacity() const noexcept
+{
+    return bytes;
+}
+
+std::expected<size_t, DaemonError> ResultRing::push(std::span<const ScanResult> results) noexcept
+{
+    uint64_t head = position;
+    uint64_t tail = header()->tail.load(std::memory_order_acquire);
+
+    // tail пишет клиент: он не может обогнать head и отстать больше чем на буфер
+    if(tail > head || head - tail > bytes)
+        return std::unexpected{DaemonError::ProtocolError};
+
+    size_t count = 0;
+
+    for(const auto& result : results)
+    {
+        size_t need = recordBytes(result.value.size());
+
+        // такая запись могла бы не поместиться даже в пустой буфер из-за заглушки на краю
+        if(need > bytes / 2)
+        {
+            if(count == 0)
+                return std::unexpected{DaemonError::RecordTooLarge};
+            break;
+        }
+
+        size_t offset = head % bytes;
+        size_t toEnd = bytes - offset;
+        size_t skip = toEnd < need ? toEnd : 0;
+
+        if(skip + need > bytes - (head - tail))
+            break;
+
+        if(skip > 0)
+        {
+            if(skip >= sizeof(RingRecord))
+            {
+                RingRecord marker{0, 0, RingRecord::wrap};
+                std::memcpy(data() + offset, &marker, sizeof(marker));
+            }
+
+            head += skip;
+            offset = 0;
+        }
+
+        RingRecord record{result.address, static_cast<uint32_t>(result.value.size()), 0};
+
+        std::memcpy(data() + offset, &record, sizeof(record));
+        std::memcpy(data() + offset + sizeof(record), result.value.data(), result.value.size());
+
+        head += need;
+        ++count;
+    }
+
+    header()->head.store(head, std::memory_order_release);
+    position = head;
+
+    return count;
+}
+
+ResultRing::Header* ResultRing::header() const noexcept
+{
+    return static_cast<Header*>(mapping);
+}
+
+std::byte* ResultRing::data() const noexcept
+{
+    return static_cast<std::byte*>(mapping) + headerSize;
+}
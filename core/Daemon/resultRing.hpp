@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <span>
+#include <vector>
+
+#include "../Scanner/scanSession.hpp"
+
+enum class DaemonError
+{
+    SocketError,
+    SharedMemoryError,
+    ProtocolError,
+    CommandFailed,
+    Disconnected,
+    RecordTooLarge
+};
+
+/**
+ * @brief Заголовок записи результата в общей памяти
+ *
+ * Сразу за заголовком лежат size байт значения, запись целиком выровнена на 8 байт.
+ * flags == wrap -- запись-заглушка: остаток буфера до конца пуст, следующая запись в начале
+ */
+struct RingRecord
+{
+    uint64_t address;
+    uint32_t size;
+    uint32_t flags;
+
+    static constexpr uint32_t wrap = 1;
+};
+
+/**
+ * @brief Кольцевой буфер результатов в общей памяти (memfd) на одного писателя и одного читателя
+ *
+ * Демон пишет записи переменной длины и двигает head, клиент читает их прямо
+ * из отображённой памяти и двигает tail. Кроме двух атомарных счётчиков
+ * синхронизации нет, поэтому буфер работает между процессами без копирования через сокет.
+ *
+ * Заголовок в общей памяти доступен на запись обеим сторонам, поэтому размер буфера
+ * и свой счётчик каждая сторона держит у себя, а счётчик другой стороны
+ * и длины записей проверяет перед использованием
+ */
+class ResultRing
+{
+public:
+    /**
+     * @brief Создаёт новый буфер в memfd
+     *
+     * @param capacity размер области записей в байтах, округляется вверх до 8
+     * @return std::expected<ResultRing, DaemonError> отображённый буфер
+     * @retval DaemonError::SharedMemoryError если memfd_create, ftruncate, запечатывание размера или mmap не удались
+     */
+    [[nodiscard]] static std::expected<ResultRing, DaemonError> create(size_t capacity);
+
+    /**
+     * @brief Отображает буфер, созданный в другом процессе
+     *
+     * @param fd дескриптор memfd, владение переходит к ResultRing
+     * @return std::expected<ResultRing, DaemonError> отображённый буфер
+     * @retval DaemonError::SharedMemoryError если дескриптор не содержит корректный буфер
+     */
+    [[nodiscard]] static std::expected<ResultRing, DaemonError> attach(int fd);
+
+    ~ResultRing();
+
+    ResultRing(const ResultRing&) = delete;
+    ResultRing& operator=(const ResultRing&) = delete;
+
+    ResultRing(ResultRing&& other) noexcept;
+    ResultRing& operator=(ResultRing&& other) noexcept;
+
+    [[nodiscard]] int fd() const noexcept;
+    [[nodiscard]] size_t capacity() const noexcept;
+
+    /// @brief Сколько байт займёт запись со значением из size байт
+    [[nodiscard]] static constexpr size_t recordBytes(size_t size) noexcept
+    {
+        return (sizeof(RingRecord) + size + 7) & ~size_t{7};
+    }
+
+    /**
+     * @brief Пишет сколько поместится результатов (сторона демона)
+     *
+     * @param results результаты по порядку
+     * @return std::expected<size_t, DaemonError> сколько записей опубликовано
+     * @retval DaemonError::ProtocolError если tail в общей памяти испорчен
+     * @retval DaemonError::RecordTooLarge если первое значение длиннее половины буфера
+     */
+    std::expected<size_t, DaemonError> push(std::span<const ScanResult> results) noexcept;
+
+    /**
+     * @brief Отдаёт все опубликованные записи и освобождает их для демона (сторона клиента)
+     *
+     * @param callBack вызывается для каждой записи (адрес, байты значения),
+     *        байты действительны только до возврата из callBack
+     * @return std::expected<size_t, DaemonError> сколько записей прочитано
+     * @retval DaemonError::ProtocolError если head или длина записи выходят за буфер
+     */
+    template <typename T>
+    std::expected<size_t, DaemonError> drain(T&& callBack)
+    {
+        uint64_t tail = position;
+        uint64_t head = header()->head.load(std::memory_order_acquire);
+
+        if(head < tail || head - tail > bytes)
+            return std::unexpected{DaemonError::ProtocolError};
+
+        size_t count = 0;
+
+        while(tail != head)
+        {
+            size_t offset = tail % bytes;
+            size_t toEnd = bytes - offset;
+            RingRecord record{};
+
+            if(toEnd >= sizeof(RingRecord))
+                std::memcpy(&record, data() + offset, sizeof(record));
+
+            if(toEnd < sizeof(RingRecord) || (record.flags & RingRecord::wrap))
+            {
+                if(toEnd > head - tail)
+                    return std::unexpected{DaemonError::ProtocolError};
+
+                tail += toEnd;
+                continue;
+            }
+
+            size_t need = recordBytes(record.size);
+
+            if(need > toEnd || need > head - tail)
+                return std::unexpected{DaemonError::ProtocolError};
+
+            callBack(record.address, std::span<const std::byte>(data() + offset + sizeof(RingRecord), record.size));
+
+            tail += need;
+            ++count;
+        }
+
+        header()->tail.store(tail, std::memory_order_release);
+        position = tail;
+
+        return count;
+    }
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t reserved;
+        uint64_t capacity;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    ResultRing(int fd, void* mapping, size_t mappingSize, size_t bytes) noexcept;
+
+    [[nodiscard]] Header* header() const noexcept;
+    [[nodiscard]] std::byte* data() const noexcept;
+
+    int memFd = -1;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+
+    // свои копии: заголовок в общей памяти может испортить другая сторона
+    size_t bytes = 0;
+    uint64_t position = 0; // head у демона, tail у клиента
+};
@@ -0,0 +1,357 @@
+#include "scanDaemon.hpp"
+#include <charconv>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    /// Как часто потоки проверяют запрос остановки, пока ждут данных
+    constexpr int pollTimeoutMs = 200;
+
+    /**
+     * @brief Читает из сокета одну строку без '\n'
+     *
+     * @param inbox уже принятые, но не разобранные байты
+     * @return false если клиент отключился или запрошена остановка
+     */
+    bool readLine(int fd, std::string& inbox, std::string& line, const std::stop_token& stop)
+    {
+        while(true)
+        {
+            if(auto end = inbox.find('\n'); end != std::string::npos)
+            {
+                line.assign(inbox, 0, end);
+                inbox.erase(0, end + 1);
+                return true;
+            }
+
+            pollfd pfd{fd, POLLIN, 0};
+
+            if(::poll(&pfd, 1, pollTimeoutMs) < 0 && errno != EINTR)
+                return false;
+
+            if(stop.stop_requested())
+                return false;
+
+            if(!(pfd.revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            char chunk[4096];
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+
+            if(n <= 0)
+                return false;
+
+            inbox.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+    bool sendAll(int fd, std::string_view data)
+    {
+        while(!data.empty())
+        {
+            ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+
+            if(n <= 0)
+                return false;
+
+            data.remove_prefix(static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    /// @brief Передаёт клиенту дескриптор кольца вместе с одним байтом данных
+    bool sendDescriptor(int socketFd, int fd)
+    {
+        char marker = 'R';
+        iovec iov{&marker, 1};
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+        return ::sendmsg(socketFd, &msg, MSG_NOSIGNAL) == 1;
+    }
+
+    bool sameUser(int fd)
+    {
+        ucred cred{};
+        socklen_t len = sizeof(cred);
+
+        return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == ::geteuid();
+    }
+
+    std::string reply(size_t number)
+    {
+        return "ok " + std::to_string(number) + "\n";
+    }
+
+    std::string failure(std::string_view text)
+    {
+        return "err " + std::string(text) + "\n";
+    }
+}
+
+ScanDaemon::ScanDaemon(std::filesystem::path socketPath, ModuleFilterConfig config, size_t threads, size_t ringCapacity)
+    : socketPath(std::move(socketPath)), config(config), ringCapacity(ringCapacity == 0 ? 1 : ringCapacity),
+      parser(reader), classifier(reader), pool(threads)
+{
+    scanner.setAlignment(Alignment::Four);
+}
+
+ScanDaemon::~ScanDaemon()
+{
+    connections.clear();
+}
+
+std::expected<void, DaemonError> ScanDaemon::run(std::stop_token stop)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    const auto& path = socketPath.native();
+
+    if(path.empty() || path.size() >= sizeof(addr.sun_path))
+        return std::unexpected{DaemonError::SocketError};
+
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if(listener < 0)
+        return std::unexpected{DaemonError::SocketError};
+
+    // сокет от прошлого запуска мешает bind
+    struct stat st{};
+    if(::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        ::unlink(path.c_str());
+
+    if(::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+       ::chmod(path.c_str(), 0600) != 0 || ::listen(listener, 16) != 0)
+    {
+        ::close(listener);
+        return std::unexpected{DaemonError::SocketError};
+    }
+
+    while(!stop.stop_requested())
+    {
+        std::erase_if(connections, [](const Connection& c) { return c.done.load(); });
+
+        pollfd pfd{listener, POLLIN, 0};
+
+        if(::poll(&pfd, 1, pollTimeoutMs) <= 0 || !(pfd.revents & POLLIN))
+            continue;
+
+        int clientFd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if(clientFd < 0)
+            continue;
+
+        if(!sameUser(clientFd))
+        {
+            ::close(clientFd);
+            continue;
+        }
+
+        auto& connection = connections.emplace_back();
+        connection.thread = std::jthread([this, clientFd, &connection](std::stop_token clientStop)
+        {
+            serve(clientFd, clientStop);
+            connection.done.store(true);
+        });
+    }
+
+    connections.clear();
+    ::close(listener);
+    ::unlink(path.c_str());
+
+    return {};
+}
+
+/**
+ * @brief Обслуживает одно подключение: отдаёт кольцо и выполняет команды до отключения
+ */
+void ScanDaemon::serve(int clientFd, std::stop_token stop)
+{
+    auto ring = ResultRing::create(ringCapacity);
+
+    if(!ring || !sendDescriptor(clientFd, ring->fd()))
+    {
+        ::close(clientFd);
+        return;
+    }
+
+    Client client{clientFd, std::move(*ring), MultiScanner(pool, scanner)};
+
+    std::string inbox{};
+    std::string line{};
+
+    while(readLine(clientFd, inbox, line, stop))
+    {
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if(line == "quit")
+            break;
+
+        if(!sendAll(clientFd, execute(client, line)))
+            break;
+    }
+
+    ::close(clientFd);
+}
+
+std::string ScanDaemon::execute(Client& client, std::string_view line)
+{
+    auto space = line.find(' ');
+    auto command = line.substr(0, space);
+    auto argument = space == std::string_view::npos ? std::string_view{} : line.substr(space + 1);
+
+    if(command == "attach" || command == "refresh")
+    {
+        pid_t pid = 0;
+
+        if(auto [ptr, ec] = std::from_chars(argument.data(), argument.data() + argument.size(), pid);
+        ec != std::errc{} || pid <= 0) return failure("invalid pid");
+
+        auto regions = regionsOf(pid, command == "refresh");
+
+        if(!regions)
+            return failure("cannot read regions");
+
+        client.scanner.clear();
+        client.pid = pid;
+        client.regions = std::move(*regions);
+        client.cursor = 0;
+
+        return reply(client.regions.size());
+    }
+
+    if(command == "type")
+    {
+        auto parsed = Value::typeFromName(argument);
+
+        if(!parsed)
+            return failure("unknown type");
+
+        client.type = *parsed;
+        return "ok\n";
+    }
+
+    if(command == "scan" || command == "next")
+    {
+        if(client.pid <= 0)
+            return failure("not attached");
+
+        auto parsed = Value::parse(client.type, argument);
+
+        if(!parsed)
+            return failure("invalid value");
+
+        client.value = *parsed;
+        client.cursor = 0;
+
+        if(command == "scan")
+        {
+            auto report = client.scanner.scan({ScanTarget{client.pid, client.regions}}, *client.value);
+
+            if(!report)
+                return failure("scan failed");
+
+            return reply(report->totalHits);
+        }
+
+        auto* session = client.scanner.session(client.pid);
+
+        if(!session)
+            return failure("no scan results");
+
+        session->filterPrevious(*client.value, pool);
+        return reply(session->size());
+    }
+
+    if(command == "count")
+    {
+        auto* session = client.scanner.session(client.pid);
+        return reply(session ? session->size() : 0);
+    }
+
+    if(command == "fetch")
+    {
+        auto* session = client.scanner.session(client.pid);
+
+        if(!session)
+            return failure("no scan results");
+
+        std::span<const ScanResult> results(session->getData());
+        auto pushed = client.ring.push(results.subspan(std::min(client.cursor, results.size())));
+
+        if(!pushed)
+            return failure(pushed.error() == DaemonError::RecordTooLarge ? "value too large for ring" : "ring corrupted");
+
+        client.cursor += *pushed;
+
+        return "ok " + std::to_string(*pushed) + " " + std::to_string(results.size() - std::min(client.cursor, results.size())) + "\n";
+    }
+
+    return failure("unknown command");
+}
+
+/**
+ * @brief Регионы процесса из кэша или заново из /proc/pid/maps
+ *
+ * Запись кэша сверяется с starttime из /proc/pid/stat: pid мог достаться новому процессу,
+ * и его регионы не имеют ничего общего с закэшированными
+ *
+ * @param refresh перечитать регионы, даже если они уже есть в кэше
+ */
+std::optional<std::vector<MemoryRegion>> ScanDaemon::regionsOf(pid_t pid, bool refresh)
+{
+    auto key = ProcessCache::keyOf(pid);
+
+    if(!key)
+        return std::nullopt;
+
+    {
+        std::lock_guard lock(cacheMutex);
+
+        if(auto it = regionCache.find(pid); it != regionCache.end())
+        {
+            if(it->second.key == *key && !refresh)
+                return it->second.regions;
+
+            regionCache.erase(it);
+        }
+    }
+
+    auto parsed = parser.parse(pid);
+
+    if(!parsed)
+        return std::nullopt;
+
+    classifier.classify(*parsed);
+    (void)classifier.attachUsage(pid, *parsed);
+
+    auto filtered = filter.filter(*parsed, config);
+
+    if(!filtered)
+        return std::nullopt;
+
+    std::lock_guard lock(cacheMutex);
+    regionCache[pid] = {*key, *filtered};
+
+    return std::move(*filtered);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../Process/ModuleFilter.hpp"
+#include "../Process/ModuleMapParser.hpp"
+#include "../Process/ProcessCache.hpp"
+#include "../Process/ProcessReader.hpp"
+#include "../Process/RegionClassifier.hpp"
+#include "../Scanner/multiScanner.hpp"
+#include "../Scanner/scanner.hpp"
+#include "../Scanner/threadPool.hpp"
+#include "../Scanner/value.hpp"
+#include "resultRing.hpp"
+
+/**
+ * @brief Долгоживущий локальный сервер сканирования
+ *
+ * Держит пул потоков, сканер и кэш отфильтрованных регионов между запросами.
+ * Клиенты подключаются к Unix-сокету и получают при подключении memfd своего
+ * ResultRing (SCM_RIGHTS). Команды и ответы -- текстовые строки, сами результаты
+ * идут только через общую память.
+ *
+ * Команды (ответ "ok [данные]" или "err <текст>"):
+ *
+ *     attach <pid>      -- ok <регионов>, регионы берутся из кэша
+ *     refresh <pid>     -- ok <регионов>, перечитать регионы мимо кэша
+ *     type <имя>        -- тип значения как в Value::typeFromName
+ *     scan <value>      -- ok <найдено>
+ *     next <value>      -- ok <осталось>
+ *     count             -- ok <результатов>
+ *     fetch             -- ok <записано> <ещё не отдано>, пишет в кольцо сколько поместится;
+ *                          err, если клиент испортил заголовок кольца
+ *     quit
+ *
+ * Каждый клиент обслуживается своим потоком, сканирование идёт в общем пуле,
+ * каждый запрос ждёт только свои задачи пула (TaskGroup)
+ */
+class ScanDaemon
+{
+public:
+    ScanDaemon
+    (
+        std::filesystem::path socketPath,
+        ModuleFilterConfig config,
+        size_t threads = std::thread::hardware_concurrency(),
+        size_t ringCapacity = 16 << 20 // байт на кольцо клиента
+    );
+    ~ScanDaemon();
+
+    ScanDaemon(const ScanDaemon&) = delete;
+    ScanDaemon& operator=(const ScanDaemon&) = delete;
+
+    /**
+     * @brief Принимает подключения до запроса остановки
+     *
+     * Сокет создаётся с правами 0600, подключения от других пользователей отклоняются
+     *
+     * @param stop токен остановки
+     * @return std::expected<void, DaemonError> ничего при штатной остановке
+     * @retval DaemonError::SocketError если не удалось создать или привязать сокет
+     */
+    std::expected<void, DaemonError> run(std::stop_token stop);
+
+private:
+    /// @brief Состояние одного подключения
+    struct Client
+    {
+        int fd;
+        ResultRing ring;
+        MultiScanner scanner;
+        pid_t pid = 0;
+        std::vector<MemoryRegion> regions{};
+        Value::ValueType type = Value::ValueType::Int32;
+        std::optional<Value> value{};
+        size_t cursor = 0;
+    };
+
+    /// @brief Поток подключения, done выставляется перед выходом, чтобы run() мог его собрать
+    struct Connection
+    {
+        std::atomic<bool> done{false};
+        std::jthread thread{};
+    };
+
+    void serve(int clientFd, std::stop_token stop);
+    std::string execute(Client& client, std::string_view line);
+
+    [[nodiscard]] std::optional<std::vector<MemoryRegion>> regionsOf(pid_t pid, bool refresh);
+
+    std::filesystem::path socketPath;
+    ModuleFilterConfig config;
+    size_t ringCapacity;
+
+    ProcessReader reader{};
+    ModuleMapParser parser;
+    ModuleFilter filter{};
+    RegionClassifier classifier;
+    ThreadPool pool;
+    Scanner scanner{};
+
+    /// @brief Регионы процесса и ключ, под которым они прочитаны
+    struct CachedRegions
+    {
+        ProcessKey key;
+        std::vector<MemoryRegion> regions;
+    };
+
+    std::mutex cacheMutex{};
+    std::map<pid_t, CachedRegions> regionCache{}; // запись с другим starttime -- уже другой процесс
+
+    std::list<Connection> connections{};
+};
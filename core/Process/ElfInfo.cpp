@@ -0,0 +1,117 @@
+#include "ElfInfo.hpp"
+#include <algorithm>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    bool readAt(int fd, void* out, size_t size, off_t offset) noexcept
+    {
+        return ::pread(fd, out, size, offset) == static_cast<ssize_t>(size);
+    }
+
+    /// @brief Ищет NT_GNU_BUILD_ID в содержимом сегмента заметок
+    std::string findBuildId(const std::vector<unsigned char>& notes)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+        auto align = [](size_t size) { return (size + 3) & ~size_t{3}; };
+
+        size_t pos = 0;
+
+        while(pos + sizeof(Elf64_Nhdr) <= notes.size())
+        {
+            Elf64_Nhdr header;
+            std::copy_n(notes.data() + pos, sizeof(header), reinterpret_cast<unsigned char*>(&header));
+            pos += sizeof(header);
+
+            size_t name = pos;
+            size_t desc = name + align(header.n_namesz);
+            size_t next = desc + align(header.n_descsz);
+
+            if(next > notes.size())
+                break;
+
+            if(header.n_type == NT_GNU_BUILD_ID && header.n_namesz == 4 && std::equal(notes.begin() + name, notes.begin() + name + 4, "GNU"))
+            {
+                std::string id{};
+
+                for(size_t i = 0; i < header.n_descsz; ++i)
+                {
+                    id += hex[notes[desc + i] >> 4];
+                    id += hex[notes[desc + i] & 0xf];
+                }
+
+                return id;
+            }
+
+            pos = next;
+        }
+
+        return {};
+    }
+
+    /// @brief Обходит PT_NOTE программных заголовков ELF нужного класса
+    template <typename Ehdr, typename Phdr>
+    std::string scanNotes(int fd)
+    {
+        Ehdr header;
+
+        if(!readAt(fd, &header, sizeof(header), 0) || header.e_phentsize != sizeof(Phdr))
+            return {};
+
+        for(size_t i = 0; i < header.e_phnum; ++i)
+        {
+            Phdr segment;
+
+            if(!readAt(fd, &segment, sizeof(segment), static_cast<off_t>(header.e_phoff + i * sizeof(Phdr))))
+                return {};
+
+            // заметки модуля -- единицы килобайт, больше -- битый заголовок
+            if(segment.p_type != PT_NOTE || segment.p_filesz > 64 * 1024)
+                continue;
+
+            std::vector<unsigned char> notes(segment.p_filesz);
+
+            if(!readAt(fd, notes.data(), notes.size(), static_cast<off_t>(segment.p_offset)))
+                continue;
+
+            if(auto id = findBuildId(notes); !id.empty())
+                return id;
+        }
+
+        return {};
+    }
+}
+
+std::expected<std::string, ProcessError> ElfInfo::buildId(const std::filesystem::path& file)
+{
+    int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+        return std::unexpected{ProcessError::NotFound};
+
+    unsigned char ident[EI_NIDENT];
+    std::string id{};
+
+    if(readAt(fd, ident, sizeof(ident), 0) && std::equal(ident, ident + SELFMAG, ELFMAG))
+    {
+        if(ident[EI_CLASS] == ELFCLASS64)
+            id = scanNotes<Elf64_Ehdr, Elf64_Phdr>(fd);
+        else if(ident[EI_CLASS] == ELFCLASS32)
+            id = scanNotes<Elf32_Ehdr, Elf32_Phdr>(fd);
+    }
+
+    ::close(fd);
+
+    if(id.empty())
+        return std::unexpected{ProcessError::ReadError};
+
+    return id;
+}
+
+std::filesystem::path ElfInfo::processPath(pid_t pid, const std::string& pathname)
+{
+    return std::filesystem::path("/proc") / std::to_string(pid) / "root" / std::filesystem::path(pathname).relative_path();
+}
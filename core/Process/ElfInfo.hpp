@@ -0,0 +1,33 @@
+#pragma once
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <sys/types.h>
+#include "IProcess.hpp"
+
+/**
+ * @brief Сведения из заголовков ELF-файла модуля
+ */
+class ElfInfo
+{
+public:
+    /**
+     * @brief GNU build-id модуля из заметки NT_GNU_BUILD_ID
+     *
+     * Build-id меняется при любой пересборке и не зависит от пути и даты файла,
+     * поэтому годится как ключ для всего, что вычислено по коду модуля
+     *
+     * @param file путь к ELF-файлу
+     * @return std::expected<std::string, ProcessError> build-id в шестнадцатеричном виде
+     * @retval ProcessError::NotFound если файл не открывается
+     * @retval ProcessError::ReadError если это не ELF или заметки build-id нет
+     */
+    [[nodiscard]] static std::expected<std::string, ProcessError> buildId(const std::filesystem::path& file);
+
+    /**
+     * @brief Путь к файлу модуля так, как его видит процесс
+     *
+     * Через /proc/pid/root, чтобы у процесса в контейнере открывался его собственный файл
+     */
+    [[nodiscard]] static std::filesystem::path processPath(pid_t pid, const std::string& pathname);
+};
@@ -20,6 +20,7 @@ public:
     virtual std::expected<std::string, ProcessError> readProcessComm(pid_t pid) const = 0;
     virtual std::expected<std::string, ProcessError> readProcessCmdline(pid_t pid) const = 0;
     virtual std::expected<std::vector<std::string>, ProcessError> readProcessMaps(pid_t pid) const = 0;
+    virtual std::expected<std::vector<std::string>, ProcessError> readProcessSmaps(pid_t pid) const = 0;
 
     virtual ~IProcessReader() = default;
 };
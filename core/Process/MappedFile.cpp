@@ -0,0 +1,75 @@
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ElfInfo.hpp"
+
+MappedFile::MappedFile(void* base, size_t length) noexcept : base(base), length(length) {}
+
+MappedFile::~MappedFile()
+{
+    if(base)
+        ::munmap(base, length);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        if(base)
+            ::munmap(base, length);
+
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+std::expected<MappedFile, ProcessError> MappedFile::open(pid_t pid, const MemoryRegion& region)
+{
+    int fd = ::open(ElfInfo::processPath(pid, region.pathname).c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+        return std::unexpected{ProcessError::NotFound};
+
+    struct stat info{};
+
+    // inode уникален только в пределах устройства: файл с тем же номером на другой ФС
+    // (overlay, bind mount, корень контейнера) -- чужой, регион тогда читается из памяти
+    if(::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_ino != region.inode || info.st_dev != region.device)
+    {
+        ::close(fd);
+        return std::unexpected{ProcessError::NotFound};
+    }
+
+    auto fileSize = static_cast<uintptr_t>(info.st_size);
+
+    if(fileSize <= region.offset)
+    {
+        ::close(fd);
+        return std::unexpected{ProcessError::ReadError};
+    }
+
+    size_t length = std::min<size_t>(region.size(), fileSize - region.offset);
+    void* base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(region.offset));
+
+    ::close(fd);
+
+    if(base == MAP_FAILED)
+        return std::unexpected{ProcessError::ReadError};
+
+    ::madvise(base, length, MADV_SEQUENTIAL);
+
+    return MappedFile(base, length);
+}
+
+std::span<const std::byte> MappedFile::bytes() const noexcept
+{
+    return {static_cast<const std::byte*>(base), length};
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <sys/types.h>
+#include "IProcess.hpp"
+#include "ModuleMapParser.hpp"
+
+/**
+ * @brief Отображение в наш процесс той части файла, которую цель отобразила в регион
+ *
+ * Только для чтения, страницы общие с кешем страниц цели: байты не копируются
+ * и сама цель при чтении не затрагивается
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief Отображает файл региона с его смещения
+     *
+     * Файл открывается через /proc/pid/root и сверяется с устройством и inode из maps, чтобы не прочитать
+     * файл, подменённый по тому же пути. Если файл короче региона, отображается только
+     * его часть: хвост региона за концом файла читать из файла нечего
+     *
+     * @param pid процесс, которому принадлежит регион
+     * @param region регион файла
+     * @return std::expected<MappedFile, ProcessError> отображение
+     * @retval ProcessError::NotFound если файл не открывается или это уже другой файл
+     * @retval ProcessError::ReadError если регион начинается за концом файла или mmap не удался
+     */
+    static std::expected<MappedFile, ProcessError> open(pid_t pid, const MemoryRegion& region);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// @brief Байты с начала региона, не длиннее региона
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept;
+
+private:
+    MappedFile(void* base, size_t length) noexcept;
+
+    void* base = nullptr;
+    size_t length = 0;
+};
@@ -1,5 +1,8 @@
 #pragma once
 #include <sys/uio.h>
+#include <algorithm>
+#include <climits>
+#include <span>
 #include <type_traits>
 #include <expected>
 #include <cstdint>
@@ -15,6 +18,16 @@
 template <typename T>
 concept TriviallyCopyable = std::is_trivially_copyable_v<T>;
 
+/**
+ * @brief Участок памяти процесса для пакетного чтения
+ * 
+ */
+struct MemorySpan
+{
+    uintptr_t address;
+    size_t size;
+};
+
 /**
  * @brief Возможные ошибки сканирования памяти
  * 
@@ -22,7 +35,8 @@ concept TriviallyCopyable = std::is_trivially_copyable_v<T>;
 enum class MemoryError
 {
     InvalidIdentifier, // pid не инцелезированый 
-    ReadError // произошла ошибка при чтение памяти
+    ReadError, // произошла ошибка при чтение памяти
+    Unsupported // способ чтения недоступен в этом ядре или запрещён
 };
 
 /**
@@ -35,6 +49,9 @@ private:
 public:
 explicit Memory(pid_t pid) noexcept : pid(pid) {};
 
+/// @brief Индетификатор процесса, с памятью которого работает объект
+[[nodiscard]] pid_t getPid() const noexcept { return pid; }
+
 /**
  * @brief Чтение памяти процесса по указаному адресу
  * 
@@ -99,6 +116,40 @@ std::expected<void, MemoryError> writeProcess(const uintptr_t addr, const T& val
 
     if(process_vm_writev(pid, &local_iov, 1, &remote_iov, 1, 0) != sizeof(value))
         return std::unexpected{MemoryError::ReadError};
+
+    return {};
+}
+
+/**
+ * @brief Записывает кусок байтов в память процесса
+ * 
+ * @param addr куда записать
+ * @param size сколько байтов записать
+ * @param buffer откуда взять данные
+ * @return std::expected<void, MemoryError> 
+ * При удачной записи ничего не возвращает, при ошибке записи ReadError
+ */
+std::expected<void, MemoryError> writeBlock(const uintptr_t addr, size_t size, const std::byte* buffer) const
+{
+    if(pid <= 0)
+        return std::unexpected{MemoryError::InvalidIdentifier};
+
+    iovec local = 
+    {
+        .iov_base = const_cast<std::byte*>(buffer),
+        .iov_len = size
+    };
+
+    iovec remote = 
+    {
+        .iov_base = reinterpret_cast<void*>(addr),
+        .iov_len = size
+    };
+
+    if(process_vm_writev(pid, &local, 1, &remote, 1, 0) != static_cast<ssize_t>(size))
+        return std::unexpected{MemoryError::ReadError};
+
+    return {};
 }
 
 /**
@@ -130,4 +181,68 @@ std::expected<void, MemoryError> writeProcess(const uintptr_t addr, const T& val
 
     return static_cast<size_t>(readSize);
 }
+
+/**
+ * @brief Читает много участков памяти пачками по IOV_MAX за один process_vm_readv
+ * 
+ * Участки складываются в buffer подряд. Если участок не читается,
+ * он помечается в valid нулём и чтение продолжается со следующего
+ * 
+ * @param ranges адреса и размеры участков
+ * @param buffer куда записать данные, не меньше суммы размеров участков
+ * @param valid флаги удачного чтения по каждому участку, ranges.size() элементов
+ * @return std::expected<size_t, MemoryError> 
+ * сколько участков прочитано, InvalidIdentifier при неинициализированном pid
+ */
+[[nodiscard]] std::expected<size_t, MemoryError> readScatter(std::span<const MemorySpan> ranges, std::byte* buffer, uint8_t* valid) const
+{
+    if(pid <= 0)
+        return std::unexpected{MemoryError::InvalidIdentifier};
+
+    iovec remote[IOV_MAX];
+    size_t done = 0;
+    size_t total = 0;
+    std::byte* out = buffer;
+
+    while(done < ranges.size())
+    {
+        size_t count = std::min<size_t>(IOV_MAX, ranges.size() - done);
+        size_t bytes = 0;
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            remote[i] = {reinterpret_cast<void*>(ranges[done + i].address), ranges[done + i].size};
+            bytes += ranges[done + i].size;
+        }
+
+        iovec local = 
+        {
+            .iov_base = out,
+            .iov_len = bytes
+        };
+
+        ssize_t readSize = process_vm_readv(pid, &local, 1, remote, count, 0);
+        size_t left = readSize > 0 ? static_cast<size_t>(readSize) : 0;
+        size_t complete = 0;
+
+        while(complete < count && ranges[done + complete].size <= left)
+        {
+            left -= ranges[done + complete].size;
+            out += ranges[done + complete].size;
+            valid[done + complete++] = 1;
+        }
+
+        total += complete;
+        done += complete;
+
+        // первый не прочитанный участок пропускается, остальные пробуются заново
+        if(complete < count)
+        {
+            out += ranges[done].size;
+            valid[done++] = 0;
+        }
+    }
+
+    return total;
+}
 };
\ No newline at end of file
@@ -3,141 +3,124 @@
 /**
  * @brief Фильтрует регионы памяти по правилам из ModuleFilterConfig
  *
- * Проходит по всем регионам и оставляет только те, которые удовлетворяют
- * включённым фильтрам: writable, executable, system, anonymous, drivers, TemporaryFile
+ * Флаги конфига компилируются в RegionRuleSet и фильтрация идёт общей программой правил:
+ * writable, executable, system, anonymous, drivers, TemporaryFile, resident
  *
  * @param regions Вектор всех MemoryRegion, полученных от парсера
  * @param config Конфигурация фильтрации
  * @return std::expected<std::vector<MemoryRegion>, FilterError>
  * Отфильтрованный вектор регионов при успехе,
  * std::unexpected с FilterError при пустом входном или результативном векторе
+ * или FilterError::InvalidRules, если правила флагов не разобрались
  */
 std::expected<std::vector<MemoryRegion>, FilterError> ModuleFilter::filter(const std::vector<MemoryRegion>& regions, const ModuleFilterConfig& config) const
+{
+    auto rules = compile(config);
+
+    if(!rules)
+        return std::unexpected{FilterError::InvalidRules};
+
+    return filter(regions, *rules);
+}
+
+/**
+ * @brief Фильтрует регионы памяти скомпилированным набором правил
+ *
+ * @param regions Вектор всех MemoryRegion, полученных от парсера
+ * @param rules Скомпилированные правила
+ * @return std::expected<std::vector<MemoryRegion>, FilterError>
+ * Отфильтрованный вектор регионов при успехе,
+ * std::unexpected с FilterError при пустом входном или результативном векторе
+ */
+std::expected<std::vector<MemoryRegion>, FilterError> ModuleFilter::filter(const std::vector<MemoryRegion>& regions, const RegionRuleSet& rules) const
 {
     if(regions.empty())
         return std::unexpected{FilterError::InvalidIdentifier};
 
-    std::vector<MemoryRegion> resultRegion{};
+    auto resultRegion = rules.apply(regions);
 
-    for(const auto& region : regions)   
-    {
-        if(!matchWritable(region, config)) continue;
-        if(!matchExecutable(region, config)) continue;
-        if(!matchSystem(region, config)) continue;
-        if(!matchAnonymous(region, config)) continue;
-        if(!matchDrivers(region, config)) continue;
-        if(!matchTemporaryFile(region, config)) continue;
-
-        resultRegion.push_back(region);
-    }
     if(resultRegion.empty())
         return std::unexpected{FilterError::FilteringError};
 
     return resultRegion;
 }
 
-/**
- * @brief Проверяет, удовлетворяет ли регион фильтру по праву на запись
- *
- * Если в конфиге onlyWritable == false, регион всегда считается прошедшим фильтр
- * Если onlyWritable == true, проверяет, есть ли флаг 'w' во втором символе permissions
- *
- * @param region Проверяемый MemoryRegion
- * @param config Конфигурация фильтрации
- * @return true Регион проходит фильтр
- * @return false Регион не проходит фильтр
- */
-bool ModuleFilter::matchWritable(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept
+namespace
 {
-    if(!config.onlyWritable) return true;
+    /// @brief Правила каждого флага, разобранные один раз на процесс
+    struct ConfigRules
+    {
+        std::expected<RegionRuleSet, RuleError> writable;
+        std::expected<RegionRuleSet, RuleError> executable;
+        std::expected<RegionRuleSet, RuleError> system;
+        std::expected<RegionRuleSet, RuleError> anonymous;
+        std::expected<RegionRuleSet, RuleError> drivers;
+        std::expected<RegionRuleSet, RuleError> temporary;
+        std::expected<RegionRuleSet, RuleError> resident;
+    };
+
+    const ConfigRules& configRules()
+    {
+        static const ConfigRules rules{
+            RegionRuleSet::compile("exclude !perms=?w"),
+            RegionRuleSet::compile("exclude !perms=??x"),
+            RegionRuleSet::compile("exclude path=/usr/lib*\nexclude path=/lib*"),
+            RegionRuleSet::compile("exclude path="),
+            RegionRuleSet::compile("exclude path=/dev/*"),
+            RegionRuleSet::compile("exclude path=*(deleted)\nexclude path=*memfd*"),
+            RegionRuleSet::compile("exclude !resident")
+        };
 
-    return region.permissions.size() > 1 && region.permissions[1] == 'w';
+        return rules;
+    }
 }
 
 /**
- * @brief Проверяет, удовлетворяет ли регион фильтру по праву на исполнение 
- * 
- * Если в confige onlyExecutable == false, регион всегда сщитается прошедшем фильтер
- * Если в onlyExecutable == true, проверяет, есть ли флаг 'x' во третьем символе permissions
- * 
- * @param region Проверяемый MemoryRegion
+ * @brief Переводит флаги ModuleFilterConfig в правила
+ *
+ * onlyWritable -- регион без 'w' исключается
+ * onlyExecutable -- регион без 'x' исключается
+ * excludeSystemLibs -- исключаются пути, начинающиеся с /usr/lib и /lib
+ * includeAnonymous == false -- исключаются регионы с пустым pathname
+ * includeDrivers == false -- исключаются пути внутри /dev
+ * includeTemporaryFile == false -- исключаются "(deleted)" и memfd
+ * skipNonResident -- исключаются регионы с Rss == 0
+ *
+ * Текст правил разбирается один раз при первом вызове, дальше наборы только склеиваются
+ *
  * @param config Конфигурация фильтрации
- * @return true Регион проходит фильтр
- * @return false Регион не проходит фильтр
+ * @return std::expected<RegionRuleSet, RuleError> набор правил с default include или ошибка разбора
  */
-bool ModuleFilter::matchExecutable(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept
+std::expected<RegionRuleSet, RuleError> ModuleFilter::compile(const ModuleFilterConfig& config)
 {
-    if(!config.onlyExecutable) return true;
+    const auto& parts = configRules();
+    RegionRuleSet rules{};
 
-    return region.permissions.size() > 2 && region.permissions[2] == 'x';
-}
+    auto add = [&](bool enabled, const std::expected<RegionRuleSet, RuleError>& part) -> std::expected<void, RuleError>
+    {
+        if(!enabled)
+            return {};
 
-/**
- * @brief Проверяет является ли регион системной библиотекой
- * 
- * Если в confige excludeSystemLibs == false, регион всегда сщитается прошедшем фильтер
- * Если в excludeSystemLibs == true, проверяет, срабатывает ли паттерн для фильтра в pathname региона
- * паттерн("/usr/lib" && "/lib")
- * 
- * @param region Проверяемый MemoryRegion
- * @param config Конфигурация фильтрации
- * @return true Регион проходит фильтр
- * @return false Регион не проходит фильтр
- */
-bool ModuleFilter::matchSystem(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept
-{
-    if(!config.excludeSystemLibs) return true;
+        if(!part)
+            return std::unexpected{part.error()};
 
-    return !region.pathname.starts_with("/usr/lib") && !region.pathname.starts_with("/lib");
-}
+        rules.append(*part);
+        return {};
+    };
 
-/**
- * @brief проверяет анонимный ли регион
- * 
- * Если config.includeAnonymous == true, регион всегда сщитается прошедшим фильтр
- * Если config.includeAnonymous == false, проверяет пустой ли pathname модуля
- * 
- * @param region Проверяемый MemoryRegion
- * @param config Конфигурация фильтрации
- * @return true Eсли регион НЕ анонимный
- * @return false Если регион анонимный
- */
-bool ModuleFilter::matchAnonymous(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept
-{
-    return config.includeAnonymous ||  !region.pathname.empty();
-}
+    for(auto added : {
+        add(config.onlyWritable, parts.writable),
+        add(config.onlyExecutable, parts.executable),
+        add(config.excludeSystemLibs, parts.system),
+        add(!config.includeAnonymous, parts.anonymous),
+        add(!config.includeDrivers, parts.drivers),
+        add(!config.includeTemporaryFile, parts.temporary),
+        add(config.skipNonResident, parts.resident)
+    })
+    {
+        if(!added)
+            return std::unexpected{added.error()};
+    }
 
-/**
- * @brief Проверяет является ли регион драйвером
- * 
- * Если в confige includeDrivers == true, регион всегда сщитается прошедшем фильтер
- * Если в includeDrivers == false, проверяет, срабатывает ли паттерн для фильтра в pathname региона
- * паттерн("/dev/")
- * 
- * @param region Проверяемый MemoryRegion
- * @param config Конфигурация фильтрации
- * @return true Регион проходит фильтр
- * @return false Регион не проходит фильтр
- */
-bool ModuleFilter::matchDrivers(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept
-{
-    return config.includeDrivers || !region.pathname.starts_with("/dev/");
+    return rules;
 }
-
-/**
- * @brief Проверяет является ли регион временым файлом в памяти
- * 
- * Если в confige includeTemporaryFile == true, регион всегда сщитается прошедшем фильтер
- * Если в includeTemporaryFile == false, проверяет, срабатывает ли паттерн для фильтра в pathname региона
- * паттерн((delete) && "memfd")
- * 
- * @param region Проверяемый MemoryRegion
- * @param config Конфигурация фильтрации
- * @return true Регион проходит фильтр
- * @return false Регион не проходит фильтр
- */
-bool ModuleFilter::matchTemporaryFile(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept
-{
-    return config.includeTemporaryFile || (!region.pathname.ends_with("(deleted)") &&
-    region.pathname.find("memfd") == std::string::npos);
-}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <expected>
 #include <cstdint>
 #include "ModuleMapParser.hpp"
+#include "RegionRules.hpp"
 
 /**
  * @brief Возможные ошибки фильтрации модулей
@@ -12,7 +13,8 @@
 enum class FilterError
 {
     FilteringError, // Входной Ошибка фильтрации, после прохода нет регионов
-    InvalidIdentifier //Входной вектор регионов пуст
+    InvalidIdentifier, //Входной вектор регионов пуст
+    InvalidRules // правила конфигурации не разобрались
 };
 
 /**
@@ -26,7 +28,9 @@ enum class FilterError
  * includeAnonymous -- включать анонимные регионы ([heap], [stack])
  * includeDrivers -- включать регион, пренадлежищий к драйверу (/dev/)
  * includeTemporaryFile -- включать временые файлы ((deleted))
- * processName -- имя процесса
+ * skipNonResident -- пропускать регионы без резидентных страниц (по данным smaps, см. RegionClassifier)
+ *
+ * Это готовый набор типовых правил; произвольные условия задаются через RegionRuleSet
  */
 struct ModuleFilterConfig
 {
@@ -36,7 +40,7 @@ struct ModuleFilterConfig
     bool includeAnonymous = true;
     bool includeDrivers = false;
     bool includeTemporaryFile = false;
-    std::string processName{};
+    bool skipNonResident = false;
 };
 
 class IModuleFilter
@@ -45,6 +49,9 @@ public:
     virtual std::expected<std::vector<MemoryRegion>, FilterError>
     filter(const std::vector<MemoryRegion>& regions, const ModuleFilterConfig& config) const = 0;
 
+    virtual std::expected<std::vector<MemoryRegion>, FilterError>
+    filter(const std::vector<MemoryRegion>& regions, const RegionRuleSet& rules) const = 0;
+
     ~IModuleFilter() = default;
 };
 
@@ -67,22 +74,21 @@ public:
     std::expected<std::vector<MemoryRegion>, FilterError>
     filter(const std::vector<MemoryRegion>& regions, const ModuleFilterConfig& config) const override;
 
-private:
-    /// @brief Проверка на право записи (rw)
-    bool matchWritable(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept;
-
-    /// @brief Проверка на право исполнения (x)
-    bool matchExecutable(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept;
-
-    /// @brief Проверка, что регион не является системной библиотекой
-    bool matchSystem(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept;
-
-    /// @brief Проверка, что регион не является анонимным
-    bool matchAnonymous(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept;
-
-    /// @brief Проверка, что регион не относится к драйверам (/dev/)
-    bool matchDrivers(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept;
+    /**
+     * @brief Фильтрует регионы памяти скомпилированным набором правил
+     * @param regions Вектор всех MemoryRegion
+     * @param rules Скомпилированные правила
+     * @return std::expected<std::vector<MemoryRegion>, FilterError>
+     * Вектор отфильтрованных регионов или ошибка FilterError
+     */
+    std::expected<std::vector<MemoryRegion>, FilterError>
+    filter(const std::vector<MemoryRegion>& regions, const RegionRuleSet& rules) const override;
 
-    /// @brief Проверка, что регион не является временным файлом памяти (memfd, (deleted))
-    bool matchTemporaryFile(const MemoryRegion& region, const ModuleFilterConfig& config) const noexcept;
+    /**
+     * @brief Переводит булевы флаги ModuleFilterConfig в набор правил
+     * @param config Конфигурация фильтрации
+     * @return std::expected<RegionRuleSet, RuleError> эквивалентный набор правил
+     * @retval ошибка RegionRuleSet::compile() если правило флага не разобралось
+     */
+    [[nodiscard]] static std::expected<RegionRuleSet, RuleError> compile(const ModuleFilterConfig& config);
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "ModuleMapParser.hpp"
-#include <sstream>
 #include <charconv>
+#include <string_view>
+#include <sys/sysmacros.h>
 
 ModuleMapParser::ModuleMapParser(const IProcessReader& reader) : reader(reader) {}
 
@@ -18,6 +19,7 @@ std::expected<std::vector<MemoryRegion>, ProcessError> ModuleMapParser::parse(pi
         return std::unexpected{ProcessError::SourceUnavailable};
 
     std::vector<MemoryRegion> region{};
+    region.reserve(vecModulesMap->size());
 
     for(const auto& module : *vecModulesMap)
     {
@@ -34,24 +36,50 @@ std::expected<std::vector<MemoryRegion>, ProcessError> ModuleMapParser::parse(pi
     return region;
 }
 
-std::expected<MemoryRegion, ProcessError> ModuleMapParser::parseLine(const std::string& line) const
+std::expected<MemoryRegion, ProcessError> ModuleMapParser::parseLine(std::string_view line)
 {
     if(line.empty())
         return std::unexpected{ProcessError::InvalidIdentifier};
 
     //7f6f8a200000-7f6f8a225000 r--p 00000000 08:01 131075  /usr/lib/Dalbaeb
 
-    std::stringstream cinString(line);
-    std::string addres, perms, offsets, dev, inode, path;
+    // поля режутся string_view по месту, без stringstream и временных строк на каждое поле
+    std::string_view rest(line);
 
-    if(!(cinString >> addres >> perms >> offsets >> dev >> inode))
+    auto nextField = [&rest]() -> std::string_view
+    {
+        auto begin = rest.find_first_not_of(" \t");
+
+        if(begin == std::string_view::npos)
+            return {};
+
+        rest.remove_prefix(begin);
+
+        auto field = rest.substr(0, rest.find_first_of(" \t"));
+        rest.remove_prefix(field.size());
+
+        return field;
+    };
+
+    auto addres = nextField();
+    auto perms = nextField();
+    auto offsets = nextField();
+    auto device = nextField();
+    auto inode = nextField();
+
+    if(inode.empty())
         return std::unexpected{ProcessError::ReadError};
 
-    std::getline(cinString >> std::ws, path);
+    if(auto begin = rest.find_first_not_of(" \t"); begin != std::string_view::npos)
+        rest.remove_prefix(begin);
+    else
+        rest = {};
+
+    auto dashPos = addres.find('-');
+
+    if(dashPos == std::string_view::npos || dashPos == 0)
+        return std::unexpected{ProcessError::ReadError};
 
-    if(auto dashPos = addres.find("-");
-    dashPos != std::string::npos || dashPos > 0)
-    {
     uintptr_t startAddr = 0, endAddr = 0, resOffsets = 0;
 
     if(auto [ptr, ec] = std::from_chars(addres.data(), addres.data() + dashPos, startAddr, 16);
@@ -63,8 +91,27 @@ std::expected<MemoryRegion, ProcessError> ModuleMapParser::parseLine(const std::
     if(auto [ptrOffsets, ecOffsets] = std::from_chars(offsets.data(), offsets.data() + offsets.size(), resOffsets, 16);
     ecOffsets != std::errc{}) return std::unexpected{ProcessError::ReadError};
 
-    return MemoryRegion{ startAddr, endAddr, perms, resOffsets, path};
-    }
+    uint64_t inodeNumber = 0;
+
+    if(auto [ptrInode, ecInode] = std::from_chars(inode.data(), inode.data() + inode.size(), inodeNumber);
+    ecInode != std::errc{}) return std::unexpected{ProcessError::ReadError};
+
+    // устройство -- "major:minor" в шестнадцатеричном виде
+    auto colonPos = device.find(':');
+    unsigned int major = 0, minor = 0;
+
+    if(colonPos == std::string_view::npos)
+        return std::unexpected{ProcessError::ReadError};
 
-    return std::unexpected{ProcessError::ReadError};
-}
\ No newline at end of file
+    if(auto [ptrMajor, ecMajor] = std::from_chars(device.data(), device.data() + colonPos, major, 16);
+    ecMajor != std::errc{}) return std::unexpected{ProcessError::ReadError};
+
+    if(auto [ptrMinor, ecMinor] = std::from_chars(device.data() + colonPos + 1, device.data() + device.size(), minor, 16);
+    ecMinor != std::errc{}) return std::unexpected{ProcessError::ReadError};
+
+    MemoryRegion region{ startAddr, endAddr, std::string(perms), resOffsets, std::string(rest)};
+    region.inode = inodeNumber;
+    region.device = makedev(major, minor);
+
+    return region;
+}
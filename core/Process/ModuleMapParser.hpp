@@ -1,6 +1,43 @@
 #pragma once
 #include "IProcess.hpp"
 #include <cstdint>
+#include <sys/types.h>
+#include <string_view>
+
+/**
+ * @brief Назначение региона памяти, определяется RegionClassifier
+ * 
+ */
+enum class RegionKind : uint8_t
+{
+    Unknown,
+    MainHeap, // [heap], куча brk
+    MallocArena, // арены glibc malloc, выровненные на 64 МБ анонимные mmap
+    AnonymousMapping, // прочие анонимные mmap
+    MainStack, // [stack]
+    ThreadStack, // стек потока, анонимный rw сразу после guard-страницы
+    GuardPage, // ---p, недоступная для чтения резервация
+    Vdso, // [vdso], [vvar], [vsyscall]
+    FileCode, // исполняемый образ модуля
+    FileReadOnly, // константы и .rodata модуля
+    FileData, // .data модуля
+    FileBss, // .bss модуля, анонимный регион сразу за образом файла
+    SharedMemory, // /dev/shm, SysV, memfd
+    Device // GPU и прочие драйверы (/dev/)
+};
+
+/**
+ * @brief Использование памяти региона из /proc/pid/smaps, в байтах
+ * 
+ * known == false пока smaps не прочитан, тогда остальные поля не имеют смысла
+ */
+struct RegionUsage
+{
+    bool known = false;
+    size_t rss = 0;
+    size_t anonymous = 0;
+    size_t swap = 0;
+};
 
 struct MemoryRegion 
 {
@@ -9,6 +46,10 @@ struct MemoryRegion
     std::string permissions;
     uintptr_t offset;
     std::string pathname;
+    RegionKind kind = RegionKind::Unknown;
+    RegionUsage usage{};
+    uint64_t inode = 0; // inode файла, 0 у анонимных регионов
+    dev_t device = 0; // устройство файла major:minor, inode уникален только в его пределах
 
     size_t size() const
     {
@@ -31,7 +72,15 @@ public:
 
     std::expected<std::vector<MemoryRegion>, ProcessError> parse(pid_t pid) const override;
 
+    /**
+     * @brief Разбирает одну строку /proc/pid/maps
+     *
+     * @param line строка без перевода строки
+     * @retval ProcessError::InvalidIdentifier если строка пустая
+     * @retval ProcessError::ReadError если поля не разобраны
+     */
+    static std::expected<MemoryRegion, ProcessError> parseLine(std::string_view line);
+
 private:
-    std::expected<MemoryRegion, ProcessError> parseLine(const std::string& line) const;
     const IProcessReader& reader;
 };
@@ -0,0 +1,206 @@
+#include "PageMap.hpp"
+#include <bit>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+    /// Сколько записей pagemap читается за один pread (64 КБ буфер, 32 МБ адресов)
+    constexpr size_t batchEntries = 8192;
+
+    constexpr uint64_t pagePresent = 1ull << 63;
+    constexpr uint64_t pageSwapped = 1ull << 62;
+    constexpr uint64_t pageFileOrShared = 1ull << 61;
+    constexpr uint64_t pfnMask = (1ull << 55) - 1;
+
+    /**
+     * @brief Находит PFN общей нулевой страницы ядра
+     *
+     * Чтение не тронутой анонимной памяти (в т.ч. нашим же process_vm_readv) отображает
+     * в неё нулевую страницу, и pagemap начинает показывать её как присутствующую.
+     * PFN виден только с CAP_SYS_ADMIN, без него возвращается 0 и проверка отключается
+     */
+    uint64_t detectZeroPfn(size_t pageSize) noexcept
+    {
+        void* probe = ::mmap(nullptr, pageSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(probe == MAP_FAILED)
+            return 0;
+
+        volatile auto touch = *static_cast<volatile const char*>(probe);
+        (void)touch;
+
+        uint64_t entry = 0;
+        int fd = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+
+        if(fd >= 0)
+        {
+            off_t offset = static_cast<off_t>(reinterpret_cast<uintptr_t>(probe) / pageSize * sizeof(uint64_t));
+
+            if(::pread(fd, &entry, sizeof(entry), offset) != sizeof(entry))
+                entry = 0;
+
+            ::close(fd);
+        }
+
+        ::munmap(probe, pageSize);
+
+        return (entry & pagePresent) ? (entry & pfnMask) : 0;
+    }
+}
+
+size_t PageResidency::backedPages() const noexcept
+{
+    size_t count = 0;
+
+    for(auto word : backed)
+        count += std::popcount(word);
+
+    return count;
+}
+
+PageMap::PageMap(int fd) noexcept : fd(fd), pageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE)))
+{
+    zeroPfn = detectZeroPfn(pageSize);
+}
+
+PageMap::~PageMap()
+{
+    if(fd >= 0)
+        ::close(fd);
+}
+
+PageMap::PageMap(PageMap&& other) noexcept : fd(other.fd), pageSize(other.pageSize), zeroPfn(other.zeroPfn)
+{
+    other.fd = -1;
+}
+
+PageMap& PageMap::operator=(PageMap&& other) noexcept
+{
+    if(this != &other)
+    {
+        if(fd >= 0)
+            ::close(fd);
+
+        fd = other.fd;
+        pageSize = other.pageSize;
+        zeroPfn = other.zeroPfn;
+        other.fd = -1;
+    }
+    return *this;
+}
+
+std::expected<PageMap, ProcessError> PageMap::open(pid_t pid)
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    std::string path = "/proc/" + std::to_string(pid) + "/pagemap";
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+    {
+        switch (errno)
+        {
+            case ENOENT: return std::unexpected{ProcessError::NotFound};
+            case EACCES: return std::unexpected{ProcessError::AccessDenied};
+            default: return std::unexpected{ProcessError::SourceUnavailable};
+        }
+    }
+
+    return PageMap(fd);
+}
+
+template <typename T>
+std::expected<void, ProcessError> PageMap::forEachEntry(uintptr_t start, size_t pages, T&& callBack) const
+{
+    std::vector<uint64_t> entries(std::min(batchEntries, pages));
+
+    size_t firstPage = start / pageSize;
+
+    for(size_t done = 0; done < pages;)
+    {
+        size_t count = std::min(entries.size(), pages - done);
+        off_t offset = static_cast<off_t>((firstPage + done) * sizeof(uint64_t));
+
+        ssize_t readSize = ::pread(fd, entries.data(), count * sizeof(uint64_t), offset);
+
+        if(readSize <= 0 || readSize % sizeof(uint64_t) != 0)
+            return std::unexpected{ProcessError::ReadError};
+
+        size_t got = static_cast<size_t>(readSize) / sizeof(uint64_t);
+
+        for(size_t i = 0; i < got; ++i)
+            callBack(done + i, entries[i]);
+
+        done += got;
+    }
+
+    return {};
+}
+
+/**
+ * @brief Читает записи pagemap для диапазона пачками по batchEntries
+ *
+ * Страница считается заполненной, если она присутствует в RAM (бит 63)
+ * или выгружена в swap (бит 62). Если PFN доступен (CAP_SYS_ADMIN), страницы,
+ * отображённые на общую нулевую страницу, тоже считаются не тронутыми.
+ */
+std::expected<PageResidency, ProcessError> PageMap::residency(uintptr_t start, size_t size) const
+{
+    PageResidency result{};
+    result.start = start;
+    result.pageSize = pageSize;
+    result.pages = (size + pageSize - 1) / pageSize;
+    result.backed.assign((result.pages + 63) / 64, 0);
+
+    auto status = forEachEntry(start, result.pages, [&](size_t page, uint64_t entry)
+    {
+        bool zeroPage = zeroPfn != 0 && (entry & pagePresent) && (entry & pfnMask) == zeroPfn;
+
+        if((entry & (pagePresent | pageSwapped)) && !zeroPage)
+            result.backed[page / 64] |= 1ull << (page % 64);
+    });
+
+    if(!status)
+        return std::unexpected{status.error()};
+
+    return result;
+}
+
+/**
+ * @brief Считает страницы диапазона по битам pagemap
+ *
+ * Общая нулевая страница, как и в smaps, в Rss не входит (если её PFN виден)
+ */
+std::expected<RegionUsage, ProcessError> PageMap::usage(uintptr_t start, size_t size) const
+{
+    RegionUsage result{};
+
+    auto status = forEachEntry(start, (size + pageSize - 1) / pageSize, [&](size_t, uint64_t entry)
+    {
+        if(entry & pageSwapped)
+        {
+            result.swap += pageSize;
+            return;
+        }
+
+        if(!(entry & pagePresent) || (zeroPfn != 0 && (entry & pfnMask) == zeroPfn))
+            return;
+
+        result.rss += pageSize;
+
+        if(!(entry & pageFileOrShared))
+            result.anonymous += pageSize;
+    });
+
+    if(!status)
+        return std::unexpected{status.error()};
+
+    result.known = true;
+    return result;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <vector>
+#include <sys/types.h>
+#include "IProcess.hpp"
+#include "ModuleMapParser.hpp"
+
+/**
+ * @brief Битовая карта страниц диапазона: 1 -- у страницы есть содержимое (в RAM или в swap)
+ *
+ * Страницы с 0 ни разу не трогались процессом, для анонимной памяти это гарантированные нули
+ */
+struct PageResidency
+{
+    uintptr_t start = 0;
+    size_t pageSize = 4096;
+    size_t pages = 0;
+    std::vector<uint64_t> backed{};
+
+    [[nodiscard]] bool isBacked(size_t page) const noexcept
+    {
+        return (backed[page / 64] >> (page % 64)) & 1;
+    }
+
+    [[nodiscard]] size_t backedPages() const noexcept;
+
+    /**
+     * @brief Обходит диапазон сплошными участками одинаковой резидентности
+     *
+     * @param callBack вызывается как callBack(адрес, размер в байтах, backed)
+     */
+    template <typename T>
+    void forEachRun(T&& callBack) const
+    {
+        size_t page = 0;
+
+        while(page < pages)
+        {
+            bool state = isBacked(page);
+            size_t runEnd = page + 1;
+
+            while(runEnd < pages)
+            {
+                // целые слова из одинаковых битов пропускаются без побитового обхода
+                if(runEnd % 64 == 0 && runEnd + 64 <= pages && backed[runEnd / 64] == (state ? ~0ull : 0ull))
+                {
+                    runEnd += 64;
+                    continue;
+                }
+
+                if(isBacked(runEnd) != state)
+                    break;
+
+                ++runEnd;
+            }
+
+            callBack(start + page * pageSize, (runEnd - page) * pageSize, state);
+            page = runEnd;
+        }
+    }
+};
+
+/**
+ * @brief Читает /proc/pid/pagemap пачками и строит карту резидентных страниц
+ *
+ * Держит открытый дескриптор pagemap на время жизни объекта
+ */
+class PageMap
+{
+public:
+    /**
+     * @brief Открывает /proc/pid/pagemap
+     *
+     * @param pid индетификатор процесса
+     * @return std::expected<PageMap, ProcessError> открытая карта страниц
+     * @retval ProcessError::InvalidIdentifier если pid не положительный
+     * @retval ProcessError::NotFound если процесс не существует
+     * @retval ProcessError::AccessDenied при недостатке прав
+     * @retval ProcessError::SourceUnavailable по другим причинам
+     */
+    [[nodiscard]] static std::expected<PageMap, ProcessError> open(pid_t pid);
+
+    ~PageMap();
+
+    PageMap(const PageMap&) = delete;
+    PageMap& operator=(const PageMap&) = delete;
+
+    PageMap(PageMap&& other) noexcept;
+    PageMap& operator=(PageMap&& other) noexcept;
+
+    /**
+     * @brief Строит карту резидентности для диапазона адресов
+     *
+     * @param start начало диапазона, выровнено на страницу
+     * @param size размер диапазона в байтах
+     * @return std::expected<PageResidency, ProcessError> карта страниц
+     * @retval ProcessError::ReadError если pagemap не удалось прочитать
+     */
+    [[nodiscard]] std::expected<PageResidency, ProcessError> residency(uintptr_t start, size_t size) const;
+
+    /**
+     * @brief Оценивает Rss/Anonymous/Swap диапазона так, как их считает smaps
+     *
+     * Нужен, когда smaps не читается (RegionStream): присутствующая страница -- Rss,
+     * без бита файловой/общей страницы -- ещё и Anonymous, выгруженная -- Swap
+     *
+     * @param start начало диапазона, выровнено на страницу
+     * @param size размер диапазона в байтах
+     * @return std::expected<RegionUsage, ProcessError> usage с known == true
+     * @retval ProcessError::ReadError если pagemap не удалось прочитать
+     */
+    [[nodiscard]] std::expected<RegionUsage, ProcessError> usage(uintptr_t start, size_t size) const;
+
+private:
+    explicit PageMap(int fd) noexcept;
+
+    /// @brief Читает записи pagemap диапазона пачками, callBack(номер страницы от start, запись)
+    template <typename T>
+    [[nodiscard]] std::expected<void, ProcessError> forEachEntry(uintptr_t start, size_t pages, T&& callBack) const;
+
+    int fd = -1;
+    size_t pageSize = 4096;
+    uint64_t zeroPfn = 0;
+};
@@ -0,0 +1,276 @@
+#include "ProcessCache.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /// @brief "/proc/<pid>/<name>" без выделения памяти
+    struct ProcPath
+    {
+        char text[64];
+
+        ProcPath(pid_t pid, std::string_view name) noexcept
+        {
+            constexpr std::string_view prefix = "/proc/";
+
+            char* out = std::copy(prefix.begin(), prefix.end(), text);
+            out = std::to_chars(out, text + sizeof(text), pid).ptr;
+            *out++ = '/';
+            out = std::copy(name.begin(), name.end(), out);
+            *out = '\0';
+        }
+    };
+
+    ProcessError openError() noexcept
+    {
+        switch(errno)
+        {
+            case ENOENT: case ESRCH: return ProcessError::NotFound;
+            case EACCES: case EPERM: return ProcessError::AccessDenied;
+            default: return ProcessError::SourceUnavailable;
+        }
+    }
+
+    /// @brief Следующее поле stat через пробел
+    std::string_view nextField(std::string_view& rest) noexcept
+    {
+        auto begin = rest.find_first_not_of(' ');
+
+        if(begin == std::string_view::npos)
+        {
+            rest = {};
+            return {};
+        }
+
+        rest.remove_prefix(begin);
+
+        auto field = rest.substr(0, rest.find(' '));
+        rest.remove_prefix(field.size());
+
+        return field;
+    }
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& number) noexcept
+    {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+        return ec == std::errc{} && ptr == text.data() + text.size() && !text.empty();
+    }
+
+    /// @brief Читает файл /proc целиком, cmdline может быть длиннее страницы
+    std::string readAll(const char* path)
+    {
+        std::string content{};
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+        if(fd < 0)
+            return content;
+
+        char buffer[4096];
+        ssize_t got = 0;
+
+        while((got = ::read(fd, buffer, sizeof(buffer))) > 0)
+            content.append(buffer, static_cast<size_t>(got));
+
+        ::close(fd);
+        return content;
+    }
+
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+ProcessCache::ProcessCache(const IProcessScanner& scanner) : scanner(scanner) {}
+
+bool ProcessCache::parseStat(std::string_view text, ProcessMetadata& entry)
+{
+    // comm в скобках может содержать пробелы и скобки, поэтому ищется последняя ')'
+    auto open = text.find('(');
+    auto close = text.rfind(')');
+
+    if(open == std::string_view::npos || close == std::string_view::npos || close < open)
+        return false;
+
+    entry.comm.assign(text.substr(open + 1, close - open - 1));
+
+    // после ')' идут поля с 3-го (state); starttime -- 22-е, rss -- 24-е
+    std::string_view rest = text.substr(close + 1);
+    uint64_t rssPages = 0;
+
+    for(int field = 3; field <= 24; ++field)
+    {
+        auto value = nextField(rest);
+
+        if(value.empty())
+            return false;
+
+        if(field == 22 && !parseNumber(value, entry.key.startTime))
+            return false;
+
+        if(field == 24 && !parseNumber(value, rssPages))
+            return false;
+    }
+
+    entry.rssBytes = rssPages * pageSize;
+    return true;
+}
+
+std::expected<ProcessMetadata*, ProcessError> ProcessCache::load(pid_t pid)
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    ProcPath path(pid, "stat");
+    int fd = ::open(path.text, O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+        return std::unexpected{openError()};
+
+    struct stat owner{};
+    char buffer[1024];
+
+    bool statOk = ::fstat(fd, &owner) == 0;
+    ssize_t got = ::read(fd, buffer, sizeof(buffer));
+
+    ::close(fd);
+
+    if(got <= 0 || !statOk)
+        return std::unexpected{ProcessError::NotFound};
+
+    ProcessMetadata fresh{};
+    fresh.key.pid = pid;
+
+    if(!parseStat(std::string_view(buffer, static_cast<size_t>(got)), fresh))
+        return std::unexpected{ProcessError::ReadError};
+
+    fresh.uid = owner.st_uid;
+
+    auto& slot = processes[pid];
+
+    if(slot.key == fresh.key)
+    {
+        slot.uid = fresh.uid;
+        slot.rssBytes = fresh.rssBytes;
+        slot.comm = std::move(fresh.comm);
+    }
+    else
+    {
+        slot = std::move(fresh);
+    }
+
+    return &slot;
+}
+
+std::expected<size_t, ProcessError> ProcessCache::refresh()
+{
+    auto pids = scanner.enumerateProcessPid();
+
+    if(!pids)
+        return std::unexpected{pids.error()};
+
+    std::vector<pid_t> seen{};
+    seen.reserve(pids->size());
+
+    for(pid_t pid : *pids)
+    {
+        // процесс мог завершиться между перечислением и чтением
+        if(load(pid))
+            seen.push_back(pid);
+    }
+
+    std::ranges::sort(seen);
+
+    std::erase_if(processes, [&](const auto& item) { return !std::ranges::binary_search(seen, item.first); });
+
+    return processes.size();
+}
+
+std::expected<const ProcessMetadata*, ProcessError> ProcessCache::get(pid_t pid)
+{
+    auto loaded = load(pid);
+
+    if(!loaded)
+    {
+        processes.erase(pid);
+        return std::unexpected{loaded.error()};
+    }
+
+    return *loaded;
+}
+
+const ProcessMetadata& ProcessCache::details(const ProcessMetadata& entry)
+{
+    auto it = processes.find(entry.key.pid);
+
+    if(it == processes.end() || it->second.key != entry.key)
+        return entry;
+
+    auto& slot = it->second;
+
+    if(slot.detailsLoaded)
+        return slot;
+
+    slot.cmdline = readAll(ProcPath(slot.key.pid, "cmdline").text);
+
+    // аргументы разделены '\0', последний тоже завершён '\0'
+    while(!slot.cmdline.empty() && slot.cmdline.back() == '\0')
+        slot.cmdline.pop_back();
+
+    std::ranges::replace(slot.cmdline, '\0', ' ');
+
+    char target[PATH_MAX];
+    ssize_t length = ::readlink(ProcPath(slot.key.pid, "exe").text, target, sizeof(target));
+
+    slot.exe.assign(target, length > 0 ? static_cast<size_t>(length) : 0);
+    slot.detailsLoaded = true;
+
+    return slot;
+}
+
+std::expected<ProcessKey, ProcessError> ProcessCache::keyOf(pid_t pid)
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    ProcPath path(pid, "stat");
+    int fd = ::open(path.text, O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+        return std::unexpected{openError()};
+
+    char buffer[1024];
+    ssize_t got = ::read(fd, buffer, sizeof(buffer));
+
+    ::close(fd);
+
+    ProcessMetadata current{};
+
+    if(got <= 0 || !parseStat(std::string_view(buffer, static_cast<size_t>(got)), current))
+        return std::unexpected{ProcessError::ReadError};
+
+    current.key.pid = pid;
+    return current.key;
+}
+
+bool ProcessCache::isAlive(const ProcessKey& key)
+{
+    auto current = keyOf(key.pid);
+    return current && *current == key;
+}
+
+std::vector<const ProcessMetadata*> ProcessCache::entries() const
+{
+    std::vector<const ProcessMetadata*> sorted{};
+    sorted.reserve(processes.size());
+
+    for(const auto& [pid, entry] : processes)
+        sorted.push_back(&entry);
+
+    std::ranges::sort(sorted, {}, [](const ProcessMetadata* entry) { return entry->key.pid; });
+
+    return sorted;
+}
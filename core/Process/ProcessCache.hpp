@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+#include "IProcess.hpp"
+
+/**
+ * @brief Процесс однозначно: pid плюс время старта, pid после перезапуска переиспользуется
+ */
+struct ProcessKey
+{
+    pid_t pid = 0;
+    uint64_t startTime = 0; // тики с загрузки системы, поле 22 /proc/pid/stat
+
+    bool operator==(const ProcessKey&) const = default;
+};
+
+/**
+ * @brief Данные процесса из /proc
+ *
+ * comm, uid, rssBytes и startTime обновляются при каждом refresh(),
+ * cmdline и exe читаются лениво при первом обращении и живут, пока жив ключ
+ */
+struct ProcessMetadata
+{
+    ProcessKey key{};
+    uid_t uid = 0;
+    size_t rssBytes = 0;
+    std::string comm{};
+    std::string cmdline{}; // аргументы через пробел
+    std::string exe{}; // пустая, если ссылка не читается (нет прав, ядерный поток)
+
+    bool detailsLoaded = false;
+};
+
+/**
+ * @brief Кеш метаданных процессов
+ *
+ * /proc/pid/stat читается одним read() в буфер на стеке и разбирается без iostream,
+ * uid берётся fstat того же дескриптора. Запись с тем же (pid, starttime) обновляется
+ * по месту, с другим starttime -- заменяется целиком: это уже другой процесс
+ */
+class ProcessCache
+{
+public:
+    explicit ProcessCache(const IProcessScanner& scanner);
+
+    /**
+     * @brief Перечитывает stat всех процессов, удаляет завершившиеся
+     *
+     * @return std::expected<size_t, ProcessError> сколько процессов в кеше
+     * @retval enumerateProcessPid().error() если /proc не перечисляется
+     */
+    std::expected<size_t, ProcessError> refresh();
+
+    /**
+     * @brief Актуальные данные одного процесса, с перечитыванием его stat
+     *
+     * @param pid индетификатор процесса
+     * @return std::expected<const ProcessMetadata*, ProcessError> запись кеша, действительна до следующего изменения кеша
+     * @retval ProcessError::InvalidIdentifier если pid не положительный
+     * @retval ProcessError::NotFound если процесса нет
+     * @retval ProcessError::ReadError если stat не разбирается
+     */
+    std::expected<const ProcessMetadata*, ProcessError> get(pid_t pid);
+
+    /**
+     * @brief Дочитывает cmdline и exe, если они ещё не прочитаны для этого ключа
+     */
+    const ProcessMetadata& details(const ProcessMetadata& entry);
+
+    /**
+     * @brief Ключ процесса, который сейчас носит pid, без записи в кеш
+     *
+     * @retval ProcessError::InvalidIdentifier если pid не положительный
+     * @retval ProcessError::NotFound если процесса нет
+     * @retval ProcessError::ReadError если stat не разбирается
+     */
+    [[nodiscard]] static std::expected<ProcessKey, ProcessError> keyOf(pid_t pid);
+
+    /// @brief Жив ли ещё именно этот процесс, а не новый с тем же pid
+    [[nodiscard]] static bool isAlive(const ProcessKey& key);
+
+    /// @brief Записи в порядке возрастания pid на момент последнего refresh()
+    [[nodiscard]] std::vector<const ProcessMetadata*> entries() const;
+
+    /**
+     * @brief Разбирает содержимое /proc/pid/stat
+     *
+     * @param text содержимое файла
+     * @param entry куда записать comm, startTime и rssBytes
+     * @return bool false если формат не распознан
+     */
+    static bool parseStat(std::string_view text, ProcessMetadata& entry);
+
+private:
+    /// @brief Перечитывает stat процесса в запись, сохраняя детали при том же ключе
+    std::expected<ProcessMetadata*, ProcessError> load(pid_t pid);
+
+    const IProcessScanner& scanner;
+    std::unordered_map<pid_t, ProcessMetadata> processes{};
+};
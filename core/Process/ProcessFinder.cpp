@@ -1,6 +1,7 @@
 #include "ProcessFinder.hpp"
 #include <ranges>
 #include <algorithm>
+#include <cctype>
 
 ProcessFinder::ProcessFinder(
         const IProcessReader& reader,
@@ -68,10 +69,10 @@ std::expected<std::string, ProcessError> ProcessFinder::tolowerString(std::strin
  * @brief ищет все совпавшие процессы по фильтру в comm
  * 
  * @param pid индетификатор процесса
- * @param name фильтр, по которому надо искать
+ * @param name фильтр в нижнем регистре, по которому надо искать
  * @return std::expected<std::string, ProcessError> строку при удачном нахождении процесса
  * @retval ProcessError::InvalidIdentifier если пид не положительный
- * @retval readProcessComm.error() || tolowerString.error() если возникла ошибка при чтении названия процесса или конвертации строки в нижний регистер
+ * @retval readProcessComm.error() если возникла ошибка при чтении названия процесса
  * @retval ProcessError::NotFound еслии небыло совпадений
  */
 std::expected<std::string, ProcessError> ProcessFinder::matchesProcessName(pid_t pid, const std::string& name) const
@@ -86,13 +87,52 @@ std::expected<std::string, ProcessError> ProcessFinder::matchesProcessName(pid_t
     if(nameComm->empty())
         return std::unexpected{ProcessError::NotFound};
 
-    auto tolowerName = tolowerString(*nameComm);
+    // comm сравнивается без учёта регистра по месту, без строки в нижнем регистре на каждый pid
+    auto found = std::ranges::search(*nameComm, name, {}, [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
 
-    if(!tolowerName)
-        return std::unexpected{tolowerName.error()};
-
-    if(tolowerName->find(name) != std::string::npos)
+    if(!found.empty())
         return *nameComm;
 
     return std::unexpected{ProcessError::NotFound};
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Ищет процессы по подстроке в выбранном поле через кеш метаданных
+ * 
+ * @param filter подстрока, сравнивается без учёта регистра
+ * @param field где искать: comm, cmdline или exe
+ * @param cache кеш процессов, перед поиском обновляется; cmdline и exe дочитываются только при поиске по ним
+ * @return std::expected<std::vector<ProcessInfo>, ProcessError> совпавшие процессы (имя, pid, время старта)
+ * @retval ProcessError::InvalidIdentifier если фильтр пуст
+ * @retval cache.refresh().error() если /proc не перечисляется
+ */
+std::expected<std::vector<ProcessInfo>, ProcessError> ProcessFinder::searchCached(std::string_view filter, MatchField field, ProcessCache& cache) const
+{
+    if(filter.empty())
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    if(auto refreshed = cache.refresh(); !refreshed)
+        return std::unexpected{refreshed.error()};
+
+    auto lower = [](unsigned char c) { return static_cast<char>(std::tolower(c)); };
+    auto contains = [&](std::string_view text) { return !std::ranges::search(text, filter, {}, lower, lower).empty(); };
+
+    std::vector<ProcessInfo> found{};
+
+    for(const auto* entry : cache.entries())
+    {
+        bool matched = false;
+
+        switch(field)
+        {
+            case MatchField::Comm: matched = contains(entry->comm); break;
+            case MatchField::Cmdline: matched = contains(cache.details(*entry).cmdline); break;
+            case MatchField::Exe: matched = contains(cache.details(*entry).exe); break;
+        }
+
+        if(matched)
+            found.push_back({entry->comm, entry->key.pid, entry->key.startTime});
+    }
+
+    return found;
+}
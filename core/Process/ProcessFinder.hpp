@@ -1,12 +1,25 @@
 #pragma once
 #include <expected>
+#include <string_view>
 #include <vector>
 #include "IProcess.hpp"
+#include "ProcessCache.hpp"
 
 struct ProcessInfo 
 {
     std::string name;
     pid_t pid = 0;
+    uint64_t startTime = 0; // 0 -- неизвестно; вместе с pid отличает перезапущенный процесс
+};
+
+/**
+ * @brief По какому полю искать процесс в ProcessFinder::searchCached
+ */
+enum class MatchField
+{
+    Comm,
+    Cmdline,
+    Exe
 };
 
 class ProcessFinder
@@ -24,6 +37,21 @@ public:
      * @retval ProcessError при ошибке
      */
     std::expected<std::vector<ProcessInfo>, ProcessError>searhProcessInfoByFilter(std::string& name) const;
+
+    /**
+     * @brief Ищет процессы по подстроке в comm, cmdline или пути exe через кеш метаданных
+     *
+     * Кеш обновляется одним проходом по stat; cmdline и exe читаются только для
+     * новых процессов, поэтому повторные поиски по тысячам процессов дешёвые
+     *
+     * @param filter подстрока, регистр не учитывается
+     * @param field где искать
+     * @param cache кеш метаданных
+     * @return std::expected<std::vector<ProcessInfo>, ProcessError> совпавшие процессы со временем старта
+     * @retval ProcessError::InvalidIdentifier если фильтр пуст
+     * @retval cache.refresh().error() если /proc не перечисляется
+     */
+    std::expected<std::vector<ProcessInfo>, ProcessError> searchCached(std::string_view filter, MatchField field, ProcessCache& cache) const;
 private:
     const IProcessReader& reader;
     const IProcessScanner& scanner;
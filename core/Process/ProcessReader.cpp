@@ -1,6 +1,8 @@
 #include "ProcessReader.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 
 /**
  * @brief читает имя процесса в /proc/pid/comm
@@ -69,13 +71,15 @@ std::expected<std::string, ProcessError> ProcessReader::readProcessCmdline(pid_t
         }
     }
 
-    std::string fullName;
-    std::string bufferName;
+    // файл читается целиком, разделители '\0' заменяются пробелами по месту;
+    // как и прежде, за каждым аргументом идёт пробел, в том числе за последним
+    std::string fullName(std::istreambuf_iterator<char>(file), {});
+
+    if(!fullName.empty() && fullName.back() != '\0')
+        fullName.push_back('\0');
+
+    std::ranges::replace(fullName, '\0', ' ');
 
-    while(std::getline(file, bufferName, '\0'))
-    {
-        fullName += bufferName + " ";
-    }
     if(fullName.empty())
         return std::unexpected{ProcessError::NotFound};
 
@@ -154,4 +158,46 @@ std::expected<std::vector<std::string>, ProcessError> ProcessReader::readProcess
         return std::unexpected{ProcessError::NotFound};
 
     return modules;
+}
+
+/**
+ * @brief читает /proc/pid/smaps построчно
+ * 
+ * @param pid индетификатор процесса
+ * @return std::expected<std::vector<std::string>, ProcessError> строки заголовков регионов и их полей (Rss, Swap, ...)
+ * @retval NotFound если фаил не найден или smaps пустой
+ * @retval AccessDenied при не достатке прав
+ * @retval SourceUnavailable и InvalidIdentifier если пид не положительный и по другим причинам
+ */
+std::expected<std::vector<std::string>, ProcessError> ProcessReader::readProcessSmaps(pid_t pid) const
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    std::filesystem::path smapsPath = std::filesystem::path("/proc") / std::to_string(pid) / "smaps";
+
+    std::ifstream file(smapsPath);
+
+    if(!file.is_open())
+    {
+        switch (errno)
+        {
+            case ENOENT: return std::unexpected{ProcessError::NotFound};
+            case EACCES: return std::unexpected{ProcessError::AccessDenied};
+            default: return std::unexpected{ProcessError::SourceUnavailable};
+        }
+    }
+
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(file, line))
+    {
+        if(!line.empty())
+            lines.push_back(std::move(line));
+    }
+
+    if(lines.empty())
+        return std::unexpected{ProcessError::NotFound};
+
+    return lines;
 }
\ No newline at end of file
@@ -13,4 +13,5 @@ public:
     std::expected<std::string, ProcessError> readProcessComm(pid_t pid) const override;
     std::expected<std::string, ProcessError> readProcessCmdline(pid_t pid) const override;
     std::expected<std::vector<std::string>, ProcessError> readProcessMaps(pid_t pid) const override;
+    std::expected<std::vector<std::string>, ProcessError> readProcessSmaps(pid_t pid) const override;
 };
\ No newline at end of file
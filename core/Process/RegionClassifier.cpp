@@ -0,0 +1,221 @@
+#include "RegionClassifier.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace
+{
+    /// Размер резервации кучи одной арены glibc (HEAP_MAX_SIZE на 64-битных системах)
+    constexpr uintptr_t mallocHeapMaxSize = 64ull * 1024 * 1024;
+
+    bool isAnonymous(const MemoryRegion& region) noexcept
+    {
+        return region.pathname.empty();
+    }
+
+    bool isFileBacked(const MemoryRegion& region) noexcept
+    {
+        return region.pathname.starts_with("/") && !region.pathname.starts_with("/dev/")
+            && !region.pathname.starts_with("/SYSV") && !region.pathname.starts_with("/memfd:");
+    }
+
+    bool isInaccessible(const MemoryRegion& region) noexcept
+    {
+        return region.permissions.starts_with("---");
+    }
+
+    bool isReadWritePrivate(const MemoryRegion& region) noexcept
+    {
+        return region.permissions == "rw-p";
+    }
+
+    bool adjacent(const MemoryRegion& lower, const MemoryRegion& upper) noexcept
+    {
+        return lower.end == upper.start;
+    }
+}
+
+RegionClassifier::RegionClassifier(const IProcessReader& reader) : reader(reader) {}
+
+void RegionClassifier::classify(std::vector<MemoryRegion>& regions) const noexcept
+{
+    for(size_t i = 0; i < regions.size(); ++i)
+    {
+        const MemoryRegion* prev = i > 0 ? &regions[i - 1] : nullptr;
+        const MemoryRegion* next = i + 1 < regions.size() ? &regions[i + 1] : nullptr;
+
+        regions[i].kind = kindOf(prev, regions[i], next);
+    }
+}
+
+/**
+ * @brief Определяет вид одного региона с учётом его соседей
+ *
+ * Анонимные регионы не подписаны в maps, поэтому различаются по косвенным признакам:
+ * арена malloc выровнена на 64 МБ и за ней идёт ---p остаток резервации,
+ * стек потока лежит сразу за guard-страницей ---p,
+ * .bss лежит сразу за последним сегментом образа файла.
+ *
+ * @param prev предыдущий регион карты или nullptr
+ * @param region классифицируемый регион
+ * @param next следующий регион карты или nullptr
+ * @return RegionKind вид региона
+ */
+RegionKind RegionClassifier::kindOf(const MemoryRegion* prev, const MemoryRegion& region, const MemoryRegion* next) noexcept
+{
+    const auto& path = region.pathname;
+
+    if(path == "[heap]") return RegionKind::MainHeap;
+    if(path == "[stack]") return RegionKind::MainStack;
+    if(path == "[vdso]" || path.starts_with("[vvar") || path == "[vsyscall]") return RegionKind::Vdso;
+
+    if(path.starts_with("/dev/shm/") || path.starts_with("/SYSV") || path.starts_with("/memfd:"))
+        return RegionKind::SharedMemory;
+
+    if(path.starts_with("/dev/zero"))
+        return RegionKind::AnonymousMapping;
+
+    if(path.starts_with("/dev/"))
+        return RegionKind::Device;
+
+    if(isInaccessible(region))
+        return RegionKind::GuardPage;
+
+    if(isFileBacked(region))
+    {
+        if(region.permissions.size() > 2 && region.permissions[2] == 'x') return RegionKind::FileCode;
+        if(region.permissions.size() > 1 && region.permissions[1] == 'w') return RegionKind::FileData;
+
+        return RegionKind::FileReadOnly;
+    }
+
+    if(!isAnonymous(region))
+        return RegionKind::Unknown;
+
+    if(isReadWritePrivate(region) && region.start % mallocHeapMaxSize == 0)
+    {
+        bool reserveFollows = next && adjacent(region, *next) && isAnonymous(*next) && isInaccessible(*next);
+
+        if(reserveFollows || region.size() == mallocHeapMaxSize)
+            return RegionKind::MallocArena;
+    }
+
+    if(prev && adjacent(*prev, region))
+    {
+        if(isAnonymous(*prev) && isInaccessible(*prev) && isReadWritePrivate(region))
+            return RegionKind::ThreadStack;
+
+        if(isFileBacked(*prev) && isReadWritePrivate(region))
+            return RegionKind::FileBss;
+    }
+
+    return RegionKind::AnonymousMapping;
+}
+
+std::expected<void, ProcessError> RegionClassifier::attachUsage(pid_t pid, std::vector<MemoryRegion>& regions) const
+{
+    auto lines = reader.readProcessSmaps(pid);
+
+    if(!lines)
+        return std::unexpected{lines.error()};
+
+    // разбор идёт во временный массив: при ошибке посреди smaps регионы остаются нетронутыми
+    std::vector<RegionUsage> usage(regions.size());
+    RegionUsage* current = nullptr;
+
+    for(const auto& line : *lines)
+    {
+        auto colon = line.find(':');
+        auto space = line.find(' ');
+
+        // Строка заголовка региона: "start-end perms offset dev inode path"
+        if(colon == std::string::npos || (space != std::string::npos && space < colon))
+        {
+            uintptr_t start = 0;
+            auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), start, 16);
+
+            if(ec != std::errc{} || ptr == line.data() + line.size() || *ptr != '-')
+                return std::unexpected{ProcessError::ReadError};
+
+            auto it = std::ranges::lower_bound(regions, start, {}, &MemoryRegion::start);
+
+            current = (it != regions.end() && it->start == start) ? &usage[static_cast<size_t>(it - regions.begin())] : nullptr;
+
+            if(current)
+                *current = RegionUsage{.known = true};
+
+            continue;
+        }
+
+        if(!current)
+            continue;
+
+        size_t* field = nullptr;
+        std::string_view key(line.data(), colon);
+
+        if(key == "Rss") field = &current->rss;
+        else if(key == "Anonymous") field = &current->anonymous;
+        else if(key == "Swap") field = &current->swap;
+        else continue;
+
+        auto valueBegin = line.find_first_not_of(' ', colon + 1);
+
+        if(valueBegin == std::string::npos)
+            return std::unexpected{ProcessError::ReadError};
+
+        size_t kilobytes = 0;
+
+        if(auto [ptr, ec] = std::from_chars(line.data() + valueBegin, line.data() + line.size(), kilobytes);
+        ec != std::errc{}) return std::unexpected{ProcessError::ReadError};
+
+        *field = kilobytes * 1024;
+    }
+
+    for(size_t i = 0; i < regions.size(); ++i)
+    {
+        if(usage[i].known)
+            regions[i].usage = usage[i];
+    }
+
+    return {};
+}
+
+bool RegionClassifier::isResident(const MemoryRegion& region) noexcept
+{
+    return !region.usage.known || region.usage.rss > 0;
+}
+
+bool RegionClassifier::isZeroFill(const MemoryRegion& region) noexcept
+{
+    bool isPrivate = region.permissions.size() > 3 && region.permissions[3] == 'p';
+
+    return isPrivate && (region.pathname.empty() || region.pathname == "[heap]" || region.pathname == "[stack]");
+}
+
+bool RegionClassifier::isFileImage(const MemoryRegion& region) noexcept
+{
+    bool readable = !region.permissions.empty() && region.permissions[0] == 'r';
+    bool file = region.inode != 0 && region.pathname.starts_with('/') && !region.pathname.ends_with("(deleted)");
+
+    return readable && file && region.usage.known && region.usage.anonymous == 0 && region.usage.swap == 0;
+}
+
+std::string_view RegionClassifier::kindName(RegionKind kind) noexcept
+{
+    switch (kind)
+    {
+        case RegionKind::MainHeap: return "heap";
+        case RegionKind::MallocArena: return "arena";
+        case RegionKind::AnonymousMapping: return "anon";
+        case RegionKind::MainStack: return "stack";
+        case RegionKind::ThreadStack: return "thread-stack";
+        case RegionKind::GuardPage: return "guard";
+        case RegionKind::Vdso: return "vdso";
+        case RegionKind::FileCode: return "code";
+        case RegionKind::FileReadOnly: return "rodata";
+        case RegionKind::FileData: return "data";
+        case RegionKind::FileBss: return "bss";
+        case RegionKind::SharedMemory: return "shm";
+        case RegionKind::Device: return "device";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <expected>
+#include <string_view>
+#include <vector>
+#include "IProcess.hpp"
+#include "ModuleMapParser.hpp"
+
+/**
+ * @brief Определяет назначение регионов памяти и их резидентность
+ *
+ * classify() работает только по данным maps (права, путь, соседние регионы),
+ * attachUsage() дополнительно читает /proc/pid/smaps и заполняет MemoryRegion::usage,
+ * чтобы сканер мог пропускать регионы без резидентных страниц.
+ */
+class RegionClassifier
+{
+public:
+    explicit RegionClassifier(const IProcessReader& reader);
+
+    /**
+     * @brief Проставляет MemoryRegion::kind каждому региону
+     *
+     * @param regions регионы в порядке возрастания адресов, как в /proc/pid/maps
+     */
+    void classify(std::vector<MemoryRegion>& regions) const noexcept;
+
+    /**
+     * @brief Вид одного региона по нему самому и соседям в карте
+     *
+     * Для потока регионов: вызывающий держит один регион в запасе, чтобы знать следующий
+     *
+     * @param prev предыдущий регион карты или nullptr
+     * @param region классифицируемый регион
+     * @param next следующий регион карты или nullptr
+     */
+    [[nodiscard]] static RegionKind kindOf(const MemoryRegion* prev, const MemoryRegion& region, const MemoryRegion* next) noexcept;
+
+    /**
+     * @brief Заполняет MemoryRegion::usage из /proc/pid/smaps
+     *
+     * Данные применяются, только если smaps разобран целиком: при ошибке usage не меняется
+     *
+     * @param pid индетификатор процесса
+     * @param regions регионы в порядке возрастания адресов
+     * @return std::expected<void, ProcessError> ничего при успехе
+     * @retval ошибка readProcessSmaps() если smaps не удалось прочитать
+     * @retval ProcessError::ReadError если в smaps встретилась некорректная строка
+     */
+    std::expected<void, ProcessError> attachUsage(pid_t pid, std::vector<MemoryRegion>& regions) const;
+
+    /**
+     * @brief Есть ли у региона резидентные страницы
+     *
+     * Регион без данных smaps считается резидентным, чтобы не потерять его при сканировании
+     */
+    [[nodiscard]] static bool isResident(const MemoryRegion& region) noexcept;
+
+    /**
+     * @brief Заполняется ли регион нулями при первом обращении
+     *
+     * Верно для приватной анонимной памяти (в т.ч. [heap] и [stack]):
+     * ни разу не тронутые страницы такого региона гарантированно содержат нули
+     */
+    [[nodiscard]] static bool isZeroFill(const MemoryRegion& region) noexcept;
+
+    /**
+     * @brief Совпадает ли содержимое региона с файлом на диске
+     *
+     * Верно для читаемого региона файла, у которого по smaps нет ни одной анонимной
+     * страницы (копии при записи) и ничего не ушло в swap. Без данных smaps -- false
+     */
+    [[nodiscard]] static bool isFileImage(const MemoryRegion& region) noexcept;
+
+    /// @brief Короткое имя вида региона для вывода
+    [[nodiscard]] static std::string_view kindName(RegionKind kind) noexcept;
+
+private:
+    const IProcessReader& reader;
+};
@@ -0,0 +1,465 @@
+#include "RegionRules.hpp"
+#include "RegionClassifier.hpp"
+#include <algorithm>
+#include <charconv>
+#include <unordered_map>
+#include <fnmatch.h>
+
+namespace
+{
+    /**
+     * @brief Делит строку правила на токены по пробелам, учитывая кавычки
+     *
+     * path="/tmp/a b (deleted)" остаётся одним токеном, сами кавычки выбрасываются
+     */
+    std::vector<std::string> tokenize(std::string_view line)
+    {
+        std::vector<std::string> tokens{};
+        std::string current{};
+        bool quoted = false;
+
+        for(char c : line)
+        {
+            if(c == '"')
+            {
+                quoted = !quoted;
+                continue;
+            }
+
+            if(!quoted && (c == ' ' || c == '\t'))
+            {
+                if(!current.empty())
+                    tokens.push_back(std::move(current));
+
+                current.clear();
+                continue;
+            }
+
+            current += c;
+        }
+
+        if(!current.empty())
+            tokens.push_back(std::move(current));
+
+        return tokens;
+    }
+
+    std::expected<uint64_t, RuleError> parseSize(std::string_view text)
+    {
+        uint64_t number = 0;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+
+        if(ec != std::errc{} || ptr == text.data())
+            return std::unexpected{RuleError::InvalidPattern};
+
+        std::string_view suffix(ptr, text.data() + text.size() - ptr);
+
+        if(suffix.empty()) return number;
+        if(suffix == "K") return number << 10;
+        if(suffix == "M") return number << 20;
+        if(suffix == "G") return number << 30;
+
+        return std::unexpected{RuleError::InvalidPattern};
+    }
+
+    std::expected<uint64_t, RuleError> parseHex(std::string_view text)
+    {
+        if(text.starts_with("0x"))
+            text.remove_prefix(2);
+
+        uint64_t number = 0;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number, 16);
+
+        if(ec != std::errc{} || ptr != text.data() + text.size())
+            return std::unexpected{RuleError::InvalidPattern};
+
+        return number;
+    }
+
+    std::expected<uint64_t, RuleError> parseKinds(std::string_view text)
+    {
+        uint64_t kinds = 0;
+
+        while(!text.empty())
+        {
+            auto comma = text.find(',');
+            auto name = text.substr(0, comma);
+            bool found = false;
+
+            for(uint8_t k = 0; k <= static_cast<uint8_t>(RegionKind::Device); ++k)
+            {
+                if(RegionClassifier::kindName(static_cast<RegionKind>(k)) == name)
+                {
+                    kinds |= 1ull << k;
+                    found = true;
+                }
+            }
+
+            if(!found)
+                return std::unexpected{RuleError::UnknownCondition};
+
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+        }
+
+        return kinds;
+    }
+}
+
+uint8_t RegionPermission::fromString(std::string_view permissions) noexcept
+{
+    uint8_t bits = 0;
+
+    if(permissions.size() > 0 && permissions[0] == 'r') bits |= Read;
+    if(permissions.size() > 1 && permissions[1] == 'w') bits |= Write;
+    if(permissions.size() > 2 && permissions[2] == 'x') bits |= Execute;
+    if(permissions.size() > 3 && permissions[3] == 'p') bits |= Private;
+    if(permissions.size() > 3 && permissions[3] == 's') bits |= Shared;
+
+    return bits;
+}
+
+std::expected<RegionRuleSet, RuleError> RegionRuleSet::compile(std::string_view text)
+{
+    RegionRuleSet rules{};
+
+    while(!text.empty())
+    {
+        auto newline = text.find('\n');
+        auto line = text.substr(0, newline);
+
+        if(auto added = rules.addRule(line); !added)
+            return std::unexpected{added.error()};
+
+        text = newline == std::string_view::npos ? std::string_view{} : text.substr(newline + 1);
+    }
+
+    return rules;
+}
+
+std::expected<void, RuleError> RegionRuleSet::addRule(std::string_view line)
+{
+    if(auto hash = line.find('#'); hash != std::string_view::npos)
+        line = line.substr(0, hash);
+
+    auto tokens = tokenize(line);
+
+    if(tokens.empty())
+        return {};
+
+    if(tokens[0] == "default")
+    {
+        if(tokens.size() != 2 || (tokens[1] != "include" && tokens[1] != "exclude"))
+            return std::unexpected{RuleError::SyntaxError};
+
+        includeByDefault = tokens[1] == "include";
+        return {};
+    }
+
+    if(tokens[0] != "include" && tokens[0] != "exclude")
+        return std::unexpected{RuleError::SyntaxError};
+
+    std::vector<Instr> rule{};
+
+    for(size_t i = 1; i < tokens.size(); ++i)
+    {
+        if(auto added = addCondition(tokens[i], rule); !added)
+            return std::unexpected{added.error()};
+    }
+
+    rule.push_back({Op::Decide, false, 0, tokens[0] == "include" ? 1u : 0u, 0});
+
+    auto next = static_cast<uint32_t>(program.size() + rule.size());
+
+    for(auto& instr : rule)
+    {
+        instr.fail = next;
+        program.push_back(instr);
+    }
+
+    return {};
+}
+
+/**
+ * @brief Компилирует одно условие правила в инструкцию
+ *
+ * @param token условие вида key=value, key~value, key>=value или key<=value
+ * @param out инструкции текущего правила
+ * @return std::expected<void, RuleError> ничего при успехе или ошибку разбора
+ */
+std::expected<void, RuleError> RegionRuleSet::addCondition(std::string_view token, std::vector<Instr>& out)
+{
+    bool negate = token.starts_with('!');
+
+    if(negate)
+        token.remove_prefix(1);
+
+    if(token == "resident")
+    {
+        out.push_back({Op::Resident, negate, 0, 0, 0});
+        return {};
+    }
+
+    auto opPos = token.find_first_of("=~<>");
+
+    if(opPos == std::string_view::npos)
+        return std::unexpected{RuleError::UnknownCondition};
+
+    auto key = token.substr(0, opPos);
+    auto rest = token.substr(opPos);
+
+    if(key == "perms" && rest.starts_with('='))
+    {
+        auto pattern = rest.substr(1);
+        uint64_t mask = 0, want = 0;
+        constexpr uint8_t bitsAt[] = {RegionPermission::Read, RegionPermission::Write, RegionPermission::Execute};
+
+        if(pattern.size() > 4)
+            return std::unexpected{RuleError::InvalidPattern};
+
+        for(size_t i = 0; i < pattern.size(); ++i)
+        {
+            char c = pattern[i];
+
+            if(c == '?') continue;
+
+            if(i < 3)
+            {
+                if(c != "rwx"[i] && c != '-')
+                    return std::unexpected{RuleError::InvalidPattern};
+
+                mask |= bitsAt[i];
+                if(c != '-') want |= bitsAt[i];
+            }
+            else if(c == 'p' || c == 's')
+            {
+                auto bit = c == 'p' ? RegionPermission::Private : RegionPermission::Shared;
+                mask |= bit;
+                want |= bit;
+            }
+            else if(c == '-')
+            {
+                mask |= RegionPermission::Private | RegionPermission::Shared;
+            }
+            else return std::unexpected{RuleError::InvalidPattern};
+        }
+
+        out.push_back({Op::Perms, negate, 0, mask, want});
+        return {};
+    }
+
+    if(key == "path" && (rest.starts_with('=') || rest.starts_with('~')))
+    {
+        PathPredicate predicate{};
+        predicate.isRegex = rest.starts_with('~');
+
+        if(predicate.isRegex)
+        {
+            try
+            {
+                predicate.regex = std::regex(std::string(rest.substr(1)), std::regex::ECMAScript | std::regex::optimize);
+            }
+            catch(const std::regex_error&)
+            {
+                return std::unexpected{RuleError::InvalidPattern};
+            }
+        }
+        else predicate.glob = std::string(rest.substr(1));
+
+        pathPredicates.push_back(std::move(predicate));
+        out.push_back({Op::Path, negate, 0, pathPredicates.size() - 1, 0});
+        return {};
+    }
+
+    if(key == "size" && (rest.starts_with(">=") || rest.starts_with("<=")))
+    {
+        auto size = parseSize(rest.substr(2));
+
+        if(!size)
+            return std::unexpected{size.error()};
+
+        out.push_back({rest.starts_with(">=") ? Op::SizeMin : Op::SizeMax, negate, 0, *size, 0});
+        return {};
+    }
+
+    if(key == "addr" && rest.starts_with('='))
+    {
+        auto range = rest.substr(1);
+        auto dash = range.find('-');
+
+        if(dash == std::string_view::npos)
+            return std::unexpected{RuleError::InvalidPattern};
+
+        auto from = parseHex(range.substr(0, dash));
+        auto to = parseHex(range.substr(dash + 1));
+
+        if(!from || !to || *from >= *to)
+            return std::unexpected{RuleError::InvalidPattern};
+
+        out.push_back({Op::Addr, negate, 0, *from, *to});
+        return {};
+    }
+
+    if(key == "kind" && rest.starts_with('='))
+    {
+        auto kinds = parseKinds(rest.substr(1));
+
+        if(!kinds)
+            return std::unexpected{kinds.error()};
+
+        out.push_back({Op::Kind, negate, 0, *kinds, 0});
+        return {};
+    }
+
+    return std::unexpected{RuleError::UnknownCondition};
+}
+
+void RegionRuleSet::append(const RegionRuleSet& other)
+{
+    auto base = static_cast<uint32_t>(program.size());
+    auto pathBase = pathPredicates.size();
+
+    for(auto instr : other.program)
+    {
+        instr.fail += base;
+
+        if(instr.op == Op::Path)
+            instr.a += pathBase;
+
+        program.push_back(instr);
+    }
+
+    pathPredicates.insert(pathPredicates.end(), other.pathPredicates.begin(), other.pathPredicates.end());
+}
+
+std::vector<MemoryRegion> RegionRuleSet::apply(const std::vector<MemoryRegion>& regions) const
+{
+    // Интернирование путей: каждый уникальный pathname получает индекс,
+    // условия по path потом кэшируются по этому индексу
+    std::unordered_map<std::string_view, uint32_t> pathIds{};
+    std::vector<std::string_view> paths{};
+    std::vector<RegionView> views{};
+    views.reserve(regions.size());
+
+    for(const auto& region : regions)
+    {
+        auto [it, inserted] = pathIds.try_emplace(region.pathname, static_cast<uint32_t>(paths.size()));
+
+        if(inserted)
+            paths.push_back(region.pathname);
+
+        views.push_back({
+            RegionPermission::fromString(region.permissions),
+            it->second,
+            region.kind,
+            region.start,
+            region.end,
+            RegionClassifier::isResident(region)
+        });
+    }
+
+    // 0 -- ещё не считано, 1 -- не совпало, 2 -- совпало
+    std::vector<uint8_t> pathCache(pathPredicates.size() * paths.size(), 0);
+
+    std::vector<uint8_t> included(regions.size());
+    size_t count = 0;
+
+    for(size_t i = 0; i < regions.size(); ++i)
+    {
+        included[i] = evaluate(views[i], pathCache, paths);
+        count += included[i];
+    }
+
+    std::vector<MemoryRegion> result{};
+    result.reserve(count);
+
+    for(size_t i = 0; i < regions.size(); ++i)
+    {
+        if(included[i])
+            result.push_back(regions[i]);
+    }
+
+    return result;
+}
+
+bool RegionRuleSet::includes(const MemoryRegion& region) const
+{
+    std::vector<std::string_view> paths{region.pathname};
+    std::vector<uint8_t> pathCache(pathPredicates.size(), 0);
+
+    RegionView view{
+        RegionPermission::fromString(region.permissions),
+        0,
+        region.kind,
+        region.start,
+        region.end,
+        RegionClassifier::isResident(region)
+    };
+
+    return evaluate(view, pathCache, paths);
+}
+
+bool RegionRuleSet::empty() const noexcept
+{
+    return program.empty();
+}
+
+bool RegionRuleSet::usesResidency() const noexcept
+{
+    return std::ranges::any_of(program, [](const Instr& instr) { return instr.op == Op::Resident; });
+}
+
+/**
+ * @brief Выполняет программу правил для одного региона
+ *
+ * @return true регион включается
+ * @return false регион исключается
+ */
+bool RegionRuleSet::evaluate(const RegionView& view, std::vector<uint8_t>& pathCache, const std::vector<std::string_view>& paths) const
+{
+    size_t pc = 0;
+
+    while(pc < program.size())
+    {
+        const auto& instr = program[pc];
+        bool ok = false;
+
+        switch (instr.op)
+        {
+            case Op::Decide: return instr.a != 0;
+            case Op::Perms: ok = (view.permissions & instr.a) == instr.b; break;
+            case Op::SizeMin: ok = view.end - view.start >= instr.a; break;
+            case Op::SizeMax: ok = view.end - view.start <= instr.a; break;
+            case Op::Addr: ok = view.start < instr.b && view.end > instr.a; break;
+            case Op::Kind: ok = (instr.a >> static_cast<uint8_t>(view.kind)) & 1; break;
+            case Op::Resident: ok = view.resident; break;
+            case Op::Path:
+            {
+                auto& cached = pathCache[instr.a * paths.size() + view.pathId];
+
+                if(cached == 0)
+                    cached = matchPath(static_cast<uint32_t>(instr.a), paths[view.pathId]) ? 2 : 1;
+
+                ok = cached == 2;
+                break;
+            }
+        }
+
+        pc = (ok != instr.negate) ? pc + 1 : instr.fail;
+    }
+
+    return includeByDefault;
+}
+
+bool RegionRuleSet::matchPath(uint32_t predicate, std::string_view path) const
+{
+    const auto& pred = pathPredicates[predicate];
+    std::string owned(path);
+
+    if(pred.isRegex)
+        return std::regex_search(owned, pred.regex);
+
+    if(pred.glob.empty())
+        return owned.empty();
+
+    return ::fnmatch(pred.glob.c_str(), owned.c_str(), 0) == 0;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ModuleMapParser.hpp"
+
+/**
+ * @brief Возможные ошибки разбора правил фильтрации
+ *
+ */
+enum class RuleError
+{
+    SyntaxError, // строка правила не разобрана
+    UnknownCondition, // неизвестное условие или вид региона
+    InvalidPattern, // некорректное регулярное выражение, число или диапазон
+    SourceUnavailable, // фаил политик не открылся
+    NotFound // политика с таким именем не найдена
+};
+
+/**
+ * @brief Права региона в виде битовой маски вместо строки "rwxp"
+ *
+ */
+namespace RegionPermission
+{
+    constexpr uint8_t Read = 1 << 0;
+    constexpr uint8_t Write = 1 << 1;
+    constexpr uint8_t Execute = 1 << 2;
+    constexpr uint8_t Private = 1 << 3;
+    constexpr uint8_t Shared = 1 << 4;
+
+    [[nodiscard]] uint8_t fromString(std::string_view permissions) noexcept;
+}
+
+/**
+ * @brief Скомпилированный набор правил фильтрации регионов
+ *
+ * Текст правил, по одному на строку, проверяется сверху вниз, первое сработавшее решает:
+ *
+ *     default include|exclude
+ *     include|exclude <условие> [<условие> ...]
+ *
+ * Условия внутри правила объединяются через И, префикс '!' инвертирует условие:
+ *
+ *     perms=rw?p           -- буква: право обязательно, '-': обязательно отсутствует, '?': не важно;
+ *                             на каждой позиции допустима только своя буква (r, w, x, p|s)
+ *     path=<glob>          -- glob по pathname (* и ?), "path=" -- анонимный регион
+ *     path~<regex>         -- регулярное выражение ECMAScript по pathname
+ *     size>=<n> size<=<n>  -- размер региона, допускаются суффиксы K, M, G
+ *     addr=<hex>-<hex>     -- регион пересекается с диапазоном [from, to)
+ *     kind=heap,arena,...  -- вид региона из RegionClassifier::kindName
+ *     resident             -- у региона есть резидентные страницы (см. RegionClassifier::isResident)
+ *
+ * Правила компилируются в плоскую программу, которая работает по битовой маске прав
+ * и индексам путей: условия по path считаются один раз на уникальный pathname,
+ * поэтому фильтрация карты из 100к регионов не разбирает строки на каждый регион.
+ */
+class RegionRuleSet
+{
+public:
+    RegionRuleSet() = default;
+
+    /**
+     * @brief Компилирует текст правил
+     *
+     * @param text правила, пустые строки и комментарии '#' пропускаются
+     * @return std::expected<RegionRuleSet, RuleError> скомпилированный набор
+     * @retval RuleError::SyntaxError если строка не начинается с include/exclude/default
+     * @retval RuleError::UnknownCondition если встретилось неизвестное условие
+     * @retval RuleError::InvalidPattern если не разобрано значение условия
+     */
+    [[nodiscard]] static std::expected<RegionRuleSet, RuleError> compile(std::string_view text);
+
+    /**
+     * @brief Добавляет одно правило в конец набора
+     *
+     * @param line строка правила в том же формате, что и compile()
+     * @return std::expected<void, RuleError> ничего при успехе или ошибку разбора
+     */
+    std::expected<void, RuleError> addRule(std::string_view line);
+
+    /**
+     * @brief Дописывает правила другого набора в конец этого
+     *
+     * Правило default другого набора не переносится
+     *
+     * @param other уже скомпилированный набор
+     */
+    void append(const RegionRuleSet& other);
+
+    /**
+     * @brief Оставляет регионы, которые набор правил включает
+     *
+     * @param regions все регионы процесса
+     * @return std::vector<MemoryRegion> включённые регионы в исходном порядке
+     */
+    [[nodiscard]] std::vector<MemoryRegion> apply(const std::vector<MemoryRegion>& regions) const;
+
+    /**
+     * @brief Включает ли набор правил один регион
+     *
+     * Для потока регионов, когда всей карты ещё нет; условия по path здесь
+     * не кэшируются между вызовами
+     */
+    [[nodiscard]] bool includes(const MemoryRegion& region) const;
+
+    [[nodiscard]] bool empty() const noexcept;
+
+    /// @brief Есть ли в наборе условие resident, то есть нужны ли ему usage регионов
+    [[nodiscard]] bool usesResidency() const noexcept;
+
+private:
+    enum class Op : uint8_t
+    {
+        Perms, SizeMin, SizeMax, Addr, Kind, Path, Resident, Decide
+    };
+
+    /// @brief Одна инструкция программы; при провале условия выполнение прыгает на fail
+    struct Instr
+    {
+        Op op;
+        bool negate;
+        uint32_t fail;
+        uint64_t a;
+        uint64_t b;
+    };
+
+    /// @brief Условие по pathname, считается один раз на уникальный путь
+    struct PathPredicate
+    {
+        bool isRegex;
+        std::string glob;
+        std::regex regex;
+    };
+
+    /// @brief Данные региона, по которым работает программа
+    struct RegionView
+    {
+        uint8_t permissions;
+        uint32_t pathId;
+        RegionKind kind;
+        uintptr_t start;
+        uintptr_t end;
+        bool resident;
+    };
+
+    std::expected<void, RuleError> addCondition(std::string_view token, std::vector<Instr>& out);
+    [[nodiscard]] bool evaluate(const RegionView& view, std::vector<uint8_t>& pathCache, const std::vector<std::string_view>& paths) const;
+    [[nodiscard]] bool matchPath(uint32_t predicate, std::string_view path) const;
+
+    std::vector<Instr> program{};
+    std::vector<PathPredicate> pathPredicates{};
+    bool includeByDefault = true;
+};
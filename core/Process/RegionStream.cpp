@@ -0,0 +1,198 @@
+#include "RegionStream.hpp"
+#include <cerrno>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include "RegionClassifier.hpp"
+
+RegionStream::RegionStream(int fd, pid_t pid, RegionRuleSet rules, std::optional<PageMap> pageMap, std::chrono::nanoseconds attach)
+    : fd(fd), pid(pid), rules(std::move(rules)), pageMap(std::move(pageMap)), attach(attach) {}
+
+RegionStream::~RegionStream()
+{
+    if(fd >= 0)
+        ::close(fd);
+}
+
+RegionStream::RegionStream(RegionStream&& other) noexcept
+    : fd(std::exchange(other.fd, -1)),
+      pid(other.pid),
+      rules(std::move(other.rules)),
+      pageMap(std::move(other.pageMap)),
+      buffer(std::move(other.buffer)),
+      consumed(other.consumed),
+      eof(other.eof),
+      previous(std::move(other.previous)),
+      pending(std::move(other.pending)),
+      lines(other.lines),
+      given(other.given),
+      attach(other.attach) {}
+
+std::expected<RegionStream, ProcessError> RegionStream::open(pid_t pid, RegionRuleSet rules, bool usage)
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    auto begin = std::chrono::steady_clock::now();
+    std::string path = "/proc/" + std::to_string(pid) + "/maps";
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+    {
+        switch(errno)
+        {
+            case ENOENT: case ESRCH: return std::unexpected{ProcessError::NotFound};
+            case EACCES: case EPERM: return std::unexpected{ProcessError::AccessDenied};
+            default: return std::unexpected{ProcessError::SourceUnavailable};
+        }
+    }
+
+    // без pagemap поток работает как без usage, это видно по usageKnown()
+    std::optional<PageMap> pageMap{};
+
+    if(usage)
+    {
+        if(auto opened = PageMap::open(pid))
+            pageMap.emplace(std::move(*opened));
+    }
+
+    return RegionStream(fd, pid, std::move(rules), std::move(pageMap), std::chrono::steady_clock::now() - begin);
+}
+
+std::expected<bool, ProcessError> RegionStream::readLine(std::string_view& line)
+{
+    while(true)
+    {
+        auto newline = buffer.find('\n', consumed);
+
+        if(newline != std::string::npos)
+        {
+            line = std::string_view(buffer).substr(consumed, newline - consumed);
+            consumed = newline + 1;
+            return true;
+        }
+
+        if(eof)
+        {
+            // последняя строка без '\n'
+            if(consumed < buffer.size())
+            {
+                line = std::string_view(buffer).substr(consumed);
+                consumed = buffer.size();
+                return true;
+            }
+            return false;
+        }
+
+        // разобранное начало выбрасывается, недочитанная строка остаётся в начале буфера
+        buffer.erase(0, consumed);
+        consumed = 0;
+
+        size_t kept = buffer.size();
+        buffer.resize(kept + readSize);
+
+        ssize_t got = 0;
+
+        do
+            got = ::read(fd, buffer.data() + kept, readSize);
+        while(got < 0 && errno == EINTR);
+
+        if(got < 0)
+            return std::unexpected{ProcessError::ReadError};
+
+        buffer.resize(kept + static_cast<size_t>(got));
+        eof = got == 0;
+    }
+}
+
+std::expected<const MemoryRegion*, ProcessError> RegionStream::next()
+{
+    while(true)
+    {
+        std::string_view line{};
+        auto more = readLine(line);
+
+        if(!more)
+            return std::unexpected{more.error()};
+
+        std::optional<MemoryRegion> incoming{};
+
+        if(*more)
+        {
+            if(line.empty())
+                continue;
+
+            auto region = ModuleMapParser::parseLine(line);
+
+            if(!region)
+                return std::unexpected{ProcessError::ReadError};
+
+            incoming.emplace(std::move(*region));
+            lines++;
+        }
+
+        if(!pending)
+        {
+            if(!incoming)
+                return nullptr;
+
+            pending = std::move(incoming);
+            continue;
+        }
+
+        pending->kind = RegionClassifier::kindOf(previous ? &*previous : nullptr, *pending, incoming ? &*incoming : nullptr);
+
+        previous = std::move(pending);
+        pending = std::move(incoming);
+
+        // правилам с resident usage нужен до проверки, остальным -- только для
+        // отданных регионов (образы файлов у сканера)
+        bool residency = pageMap && rules.usesResidency();
+
+        if(residency)
+            loadUsage(*previous);
+
+        if(!rules.includes(*previous))
+            continue;
+
+        if(pageMap && !residency)
+            loadUsage(*previous);
+
+        given++;
+        return &*previous;
+    }
+}
+
+pid_t RegionStream::getPid() const noexcept
+{
+    return pid;
+}
+
+size_t RegionStream::parsed() const noexcept
+{
+    return lines;
+}
+
+size_t RegionStream::included() const noexcept
+{
+    return given;
+}
+
+void RegionStream::loadUsage(MemoryRegion& region) const
+{
+    // не прочитанный pagemap оставляет usage неизвестным, как без smaps
+    if(auto usage = pageMap->usage(region.start, region.size()))
+        region.usage = *usage;
+}
+
+bool RegionStream::usageKnown() const noexcept
+{
+    return pageMap.has_value();
+}
+
+std::chrono::nanoseconds RegionStream::attachTime() const noexcept
+{
+    return attach;
+}
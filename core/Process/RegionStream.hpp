@@ -0,0 +1,108 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include "IProcess.hpp"
+#include "ModuleMapParser.hpp"
+#include "PageMap.hpp"
+#include "RegionRules.hpp"
+
+/**
+ * @brief Ленивое подключение к процессу: регионы из /proc/pid/maps по одному
+ *
+ * open() только открывает maps и сразу возвращает поток. Строки читаются блоками
+ * по мере вызовов next(), каждая разбирается, классифицируется и проверяется правилами,
+ * так что сканер начинает первый регион, пока ядро ещё не сформировало остаток карты.
+ * Для классификации один регион держится в запасе: виду региона нужен следующий сосед.
+ *
+ * smaps не читается: это самая медленная часть подключения. Если нужны usage
+ * регионов (правило resident, сканирование образов файлов), они считаются
+ * по /proc/pid/pagemap только для регионов, которые прошли остальные правила.
+ * Без этого или без доступа к pagemap все регионы считаются резидентными,
+ * а регионы файлов читаются из процесса, а не с диска
+ */
+class RegionStream
+{
+public:
+    /**
+     * @brief Открывает /proc/pid/maps
+     *
+     * @param pid индетификатор процесса
+     * @param rules какие регионы отдавать
+     * @param usage заполнять MemoryRegion::usage по pagemap
+     * @return std::expected<RegionStream, ProcessError> поток регионов
+     * @retval ProcessError::InvalidIdentifier если pid не положительный
+     * @retval ProcessError::NotFound если процесса нет
+     * @retval ProcessError::AccessDenied если maps закрыт для нас
+     * @retval ProcessError::SourceUnavailable при прочих ошибках open()
+     */
+    static std::expected<RegionStream, ProcessError> open(pid_t pid, RegionRuleSet rules, bool usage = false);
+
+    ~RegionStream();
+
+    RegionStream(const RegionStream&) = delete;
+    RegionStream& operator=(const RegionStream&) = delete;
+
+    RegionStream(RegionStream&& other) noexcept;
+    RegionStream& operator=(RegionStream&&) = delete;
+
+    /**
+     * @brief Следующий регион, который включают правила
+     *
+     * @return std::expected<const MemoryRegion*, ProcessError> регион, действителен до следующего вызова;
+     * nullptr, когда карта кончилась
+     * @retval ProcessError::ReadError если строка maps не разобрана или read() не удался
+     */
+    std::expected<const MemoryRegion*, ProcessError> next();
+
+    [[nodiscard]] pid_t getPid() const noexcept;
+
+    /// @brief Сколько строк maps уже разобрано
+    [[nodiscard]] size_t parsed() const noexcept;
+
+    /// @brief Сколько регионов уже отдано
+    [[nodiscard]] size_t included() const noexcept;
+
+    /// @brief Заполняются ли usage регионов: запрошены в open() и pagemap открылся
+    [[nodiscard]] bool usageKnown() const noexcept;
+
+    /// @brief Сколько заняло подключение в open()
+    [[nodiscard]] std::chrono::nanoseconds attachTime() const noexcept;
+
+private:
+    RegionStream(int fd, pid_t pid, RegionRuleSet rules, std::optional<PageMap> pageMap, std::chrono::nanoseconds attach);
+
+    /**
+     * @brief Следующая строка maps, дочитывая файл блоками
+     *
+     * @param line строка без '\n', действительна до следующего вызова
+     * @return false если файл кончился
+     */
+    std::expected<bool, ProcessError> readLine(std::string_view& line);
+
+    /// @brief Заполняет usage региона по pagemap
+    void loadUsage(MemoryRegion& region) const;
+
+    /// Сколько читать за один read(): ядро формирует maps по мере чтения
+    static constexpr size_t readSize = 8192;
+
+    int fd = -1;
+    pid_t pid = 0;
+    RegionRuleSet rules{};
+    std::optional<PageMap> pageMap{}; // есть, только если нужны usage
+
+    std::string buffer{};
+    size_t consumed = 0; // сколько байт buffer уже разобрано
+    bool eof = false;
+
+    std::optional<MemoryRegion> previous{}; // последний классифицированный регион
+    std::optional<MemoryRegion> pending{}; // разобран, ждёт следующего соседа для классификации
+
+    size_t lines = 0;
+    size_t given = 0;
+    std::chrono::nanoseconds attach{};
+};
@@ -0,0 +1,118 @@
+#include "TargetLoad.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    bool parseUnsigned(std::string_view text, unsigned& number)
+    {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+        return ec == std::errc{} && ptr == text.data() + text.size() && !text.empty();
+    }
+}
+
+std::expected<cpu_set_t, ProcessError> TargetLoad::parseCpuList(std::string_view list)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    while(!list.empty())
+    {
+        auto item = list.substr(0, list.find(','));
+        list.remove_prefix(std::min(list.size(), item.size() + 1));
+
+        auto dash = item.find('-');
+        unsigned first = 0;
+        unsigned last = 0;
+
+        if(!parseUnsigned(item.substr(0, dash), first))
+            return std::unexpected{ProcessError::ReadError};
+
+        last = first;
+
+        if(dash != std::string_view::npos && !parseUnsigned(item.substr(dash + 1), last))
+            return std::unexpected{ProcessError::ReadError};
+
+        if(last < first || last >= CPU_SETSIZE)
+            return std::unexpected{ProcessError::ReadError};
+
+        for(unsigned cpu = first; cpu <= last; ++cpu)
+            CPU_SET(cpu, &set);
+    }
+
+    if(CPU_COUNT(&set) == 0)
+        return std::unexpected{ProcessError::ReadError};
+
+    return set;
+}
+
+std::expected<cpu_set_t, ProcessError> TargetLoad::allowedCpus(pid_t pid)
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    std::ifstream file(std::filesystem::path("/proc") / std::to_string(pid) / "status");
+
+    if(!file.is_open())
+        return std::unexpected{errno == ENOENT ? ProcessError::NotFound : ProcessError::SourceUnavailable};
+
+    constexpr std::string_view key = "Cpus_allowed_list:";
+    std::string line;
+
+    while(std::getline(file, line))
+    {
+        if(!line.starts_with(key))
+            continue;
+
+        std::string_view list(line);
+        list.remove_prefix(key.size());
+
+        auto begin = list.find_first_not_of(" \t");
+
+        if(begin == std::string_view::npos)
+            break;
+
+        return parseCpuList(list.substr(begin));
+    }
+
+    return std::unexpected{ProcessError::ReadError};
+}
+
+std::expected<SchedCounters, ProcessError> TargetLoad::schedCounters(pid_t pid)
+{
+    if(pid <= 0)
+        return std::unexpected{ProcessError::InvalidIdentifier};
+
+    std::error_code ec;
+    std::filesystem::directory_iterator tasks(std::filesystem::path("/proc") / std::to_string(pid) / "task", ec);
+
+    if(ec)
+        return std::unexpected{ProcessError::NotFound};
+
+    SchedCounters total{};
+    size_t counted = 0;
+
+    for(const auto& task : tasks)
+    {
+        // поток мог завершиться между обходом каталога и чтением
+        std::ifstream file(task.path() / "schedstat");
+        uint64_t run = 0;
+        uint64_t wait = 0;
+
+        if(file >> run >> wait)
+        {
+            total.runNs += run;
+            total.waitNs += wait;
+            ++counted;
+        }
+    }
+
+    if(counted == 0)
+        return std::unexpected{ProcessError::SourceUnavailable};
+
+    return total;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <sched.h>
+#include <sys/types.h>
+#include "IProcess.hpp"
+
+/**
+ * @brief Счётчики планировщика процесса, сумма по всем его потокам
+ *
+ * runNs -- сколько наносекунд потоки выполнялись на CPU
+ * waitNs -- сколько наносекунд потоки были готовы к работе, но ждали в очереди планировщика
+ */
+struct SchedCounters
+{
+    uint64_t runNs = 0;
+    uint64_t waitNs = 0;
+};
+
+/**
+ * @brief Чтение нагрузки и привязки к CPU процесса-цели из /proc
+ */
+class TargetLoad
+{
+public:
+    /**
+     * @brief Процессоры, на которых разрешено работать процессу (Cpus_allowed_list из /proc/pid/status)
+     *
+     * Учитывает и taskset, и cpuset cgroup цели
+     *
+     * @param pid индетификатор процесса
+     * @return std::expected<cpu_set_t, ProcessError> набор процессоров
+     * @retval ProcessError::InvalidIdentifier если pid не положительный
+     * @retval ProcessError::NotFound если процесс не существует
+     * @retval ProcessError::ReadError если строки Cpus_allowed_list нет или она не разбирается
+     */
+    [[nodiscard]] static std::expected<cpu_set_t, ProcessError> allowedCpus(pid_t pid);
+
+    /**
+     * @brief Суммирует /proc/pid/task/<tid>/schedstat по всем потокам процесса
+     *
+     * @param pid индетификатор процесса
+     * @return std::expected<SchedCounters, ProcessError> счётчики
+     * @retval ProcessError::InvalidIdentifier если pid не положительный
+     * @retval ProcessError::NotFound если процесс не существует
+     * @retval ProcessError::SourceUnavailable если ядро собрано без schedstat
+     */
+    [[nodiscard]] static std::expected<SchedCounters, ProcessError> schedCounters(pid_t pid);
+
+    /**
+     * @brief Разбирает список процессоров вида "0-3,8,10-11"
+     *
+     * @return std::expected<cpu_set_t, ProcessError> набор или ReadError при ошибке формата
+     */
+    [[nodiscard]] static std::expected<cpu_set_t, ProcessError> parseCpuList(std::string_view list);
+};
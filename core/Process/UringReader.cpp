@@ -0,0 +1,251 @@
+#include "UringReader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    int uringSetup(unsigned entries, io_uring_params* params) noexcept
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) noexcept
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    /// @brief Указатель на поле кольца по смещению из io_uring_params
+    template <typename T>
+    T* ringField(void* ring, uint32_t offset) noexcept
+    {
+        return reinterpret_cast<T*>(static_cast<std::byte*>(ring) + offset);
+    }
+
+    uint32_t loadAcquire(const uint32_t* p) noexcept
+    {
+        return std::atomic_ref(*const_cast<uint32_t*>(p)).load(std::memory_order_acquire);
+    }
+
+    void storeRelease(uint32_t* p, uint32_t value) noexcept
+    {
+        std::atomic_ref(*p).store(value, std::memory_order_release);
+    }
+}
+
+std::expected<UringReader, MemoryError> UringReader::open(pid_t pid, unsigned depth)
+{
+    if(pid <= 0)
+        return std::unexpected{MemoryError::InvalidIdentifier};
+
+    UringReader reader{};
+
+    std::string path = "/proc/" + std::to_string(pid) + "/mem";
+    reader.memFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(reader.memFd < 0)
+        return std::unexpected{MemoryError::ReadError};
+
+    io_uring_params params{};
+    reader.ringFd = uringSetup(depth, &params);
+
+    // IORING_FEAT_RW_CUR_POS появился вместе с IORING_OP_READ (5.6)
+    if(reader.ringFd < 0 || !(params.features & IORING_FEAT_RW_CUR_POS))
+        return std::unexpected{MemoryError::Unsupported};
+
+    reader.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    reader.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+    if(singleMap)
+        reader.sqRingSize = reader.cqRingSize = std::max(reader.sqRingSize, reader.cqRingSize);
+
+    reader.sqRing = ::mmap(nullptr, reader.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, reader.ringFd, IORING_OFF_SQ_RING);
+
+    if(reader.sqRing == MAP_FAILED)
+    {
+        reader.sqRing = nullptr;
+        return std::unexpected{MemoryError::Unsupported};
+    }
+
+    if(singleMap)
+    {
+        reader.cqRing = reader.sqRing;
+    }
+    else
+    {
+        reader.cqRing = ::mmap(nullptr, reader.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, reader.ringFd, IORING_OFF_CQ_RING);
+
+        if(reader.cqRing == MAP_FAILED)
+        {
+            reader.cqRing = nullptr;
+            return std::unexpected{MemoryError::Unsupported};
+        }
+    }
+
+    reader.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, reader.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, reader.ringFd, IORING_OFF_SQES);
+
+    if(sqes == MAP_FAILED)
+        return std::unexpected{MemoryError::Unsupported};
+
+    reader.sqes = static_cast<io_uring_sqe*>(sqes);
+
+    reader.sqHead = ringField<uint32_t>(reader.sqRing, params.sq_off.head);
+    reader.sqTail = ringField<uint32_t>(reader.sqRing, params.sq_off.tail);
+    reader.sqArray = ringField<uint32_t>(reader.sqRing, params.sq_off.array);
+    reader.sqMask = *ringField<uint32_t>(reader.sqRing, params.sq_off.ring_mask);
+    reader.sqEntries = params.sq_entries;
+
+    reader.cqHead = ringField<uint32_t>(reader.cqRing, params.cq_off.head);
+    reader.cqTail = ringField<uint32_t>(reader.cqRing, params.cq_off.tail);
+    reader.cqes = ringField<io_uring_cqe>(reader.cqRing, params.cq_off.cqes);
+    reader.cqMask = *ringField<uint32_t>(reader.cqRing, params.cq_off.ring_mask);
+
+    return reader;
+}
+
+UringReader::~UringReader()
+{
+    // ядро ещё может писать в буферы незабранных чтений
+    while(pending > 0)
+    {
+        ReadCompletion drained[32];
+
+        if(reap(drained) == 0 && !flush(1))
+            break;
+    }
+
+    unmap();
+
+    if(ringFd >= 0)
+        ::close(ringFd);
+
+    if(memFd >= 0)
+        ::close(memFd);
+}
+
+void UringReader::unmap() noexcept
+{
+    if(sqes)
+        ::munmap(sqes, sqesSize);
+
+    if(cqRing && cqRing != sqRing)
+        ::munmap(cqRing, cqRingSize);
+
+    if(sqRing)
+        ::munmap(sqRing, sqRingSize);
+
+    sqes = nullptr;
+    sqRing = cqRing = nullptr;
+}
+
+UringReader::UringReader(UringReader&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+UringReader& UringReader::operator=(UringReader&& other) noexcept
+{
+    if(this != &other)
+    {
+        std::swap(ringFd, other.ringFd);
+        std::swap(memFd, other.memFd);
+        std::swap(sqRing, other.sqRing);
+        std::swap(sqRingSize, other.sqRingSize);
+        std::swap(cqRing, other.cqRing);
+        std::swap(cqRingSize, other.cqRingSize);
+        std::swap(sqes, other.sqes);
+        std::swap(sqesSize, other.sqesSize);
+        std::swap(sqHead, other.sqHead);
+        std::swap(sqTail, other.sqTail);
+        std::swap(sqArray, other.sqArray);
+        std::swap(sqMask, other.sqMask);
+        std::swap(sqEntries, other.sqEntries);
+        std::swap(cqHead, other.cqHead);
+        std::swap(cqTail, other.cqTail);
+        std::swap(cqes, other.cqes);
+        std::swap(cqMask, other.cqMask);
+        std::swap(queued, other.queued);
+        std::swap(pending, other.pending);
+    }
+    return *this;
+}
+
+bool UringReader::submit(uint64_t tag, uintptr_t address, size_t size, std::byte* buffer) noexcept
+{
+    uint32_t tail = *sqTail;
+
+    if(tail - loadAcquire(sqHead) >= sqEntries)
+        return false;
+
+    uint32_t index = tail & sqMask;
+    io_uring_sqe& sqe = sqes[index];
+
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = memFd;
+    sqe.off = address;
+    sqe.addr = reinterpret_cast<uint64_t>(buffer);
+    sqe.len = static_cast<uint32_t>(size);
+    sqe.user_data = tag;
+
+    sqArray[index] = index;
+    storeRelease(sqTail, tail + 1);
+
+    ++queued;
+    ++pending;
+    return true;
+}
+
+bool UringReader::flush(unsigned waitFor) noexcept
+{
+    if(queued == 0 && waitFor == 0)
+        return true;
+
+    unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int submitted = uringEnter(ringFd, queued, waitFor, flags);
+
+    if(submitted < 0)
+        return errno == EINTR;
+
+    queued -= std::min<uint32_t>(queued, static_cast<uint32_t>(submitted));
+    return true;
+}
+
+size_t UringReader::reap(std::span<ReadCompletion> out) noexcept
+{
+    uint32_t head = *cqHead;
+    uint32_t tail = loadAcquire(cqTail);
+    size_t count = 0;
+
+    while(head != tail && count < out.size())
+    {
+        const io_uring_cqe& cqe = cqes[head & cqMask];
+        out[count++] = {cqe.user_data, cqe.res};
+        ++head;
+    }
+
+    storeRelease(cqHead, head);
+    pending -= count;
+
+    return count;
+}
+
+size_t UringReader::inFlight() const noexcept
+{
+    return pending;
+}
+
+unsigned UringReader::depth() const noexcept
+{
+    return sqEntries;
+}
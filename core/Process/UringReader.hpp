@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <sys/types.h>
+#include <linux/io_uring.h>
+
+#include "MemoryReader.hpp"
+
+/**
+ * @brief Завершённое чтение: метка из submit() и результат read (байты или -errno)
+ */
+struct ReadCompletion
+{
+    uint64_t tag = 0;
+    int64_t result = 0;
+};
+
+/**
+ * @brief Асинхронное чтение /proc/pid/mem через io_uring
+ *
+ * Работает напрямую через системные вызовы io_uring_setup/io_uring_enter,
+ * без liburing. Чтения ставятся в очередь submit(), уходят в ядро одним
+ * вызовом flush() и забираются reap() в порядке завершения.
+ * Буферы поставленных чтений должны жить, пока их завершение не забрано
+ */
+class UringReader
+{
+public:
+    /**
+     * @brief Создаёт кольцо и открывает /proc/pid/mem
+     *
+     * @param pid индетификатор процесса
+     * @param depth глубина очереди, округляется ядром до степени двойки
+     * @return std::expected<UringReader, MemoryError> готовый читатель
+     * @retval MemoryError::InvalidIdentifier если pid не положительный
+     * @retval MemoryError::ReadError если /proc/pid/mem не открывается
+     * @retval MemoryError::Unsupported если io_uring нет, он запрещён или не умеет IORING_OP_READ
+     */
+    [[nodiscard]] static std::expected<UringReader, MemoryError> open(pid_t pid, unsigned depth = 32);
+
+    ~UringReader();
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    UringReader(UringReader&& other) noexcept;
+    UringReader& operator=(UringReader&& other) noexcept;
+
+    /**
+     * @brief Ставит чтение в очередь отправки
+     *
+     * @param tag метка, вернётся в ReadCompletion
+     * @param address адрес в процессе
+     * @param size сколько байт прочитать
+     * @param buffer куда читать
+     * @return bool false если очередь отправки заполнена
+     */
+    bool submit(uint64_t tag, uintptr_t address, size_t size, std::byte* buffer) noexcept;
+
+    /**
+     * @brief Отправляет поставленные чтения в ядро
+     *
+     * @param waitFor сколько завершений дождаться перед возвратом
+     * @return bool false при ошибке io_uring_enter
+     */
+    bool flush(unsigned waitFor = 0) noexcept;
+
+    /**
+     * @brief Забирает готовые завершения без ожидания
+     *
+     * @param out куда сложить завершения
+     * @return size_t сколько забрано
+     */
+    size_t reap(std::span<ReadCompletion> out) noexcept;
+
+    /// @brief Сколько чтений отправлено или поставлено и ещё не забрано
+    [[nodiscard]] size_t inFlight() const noexcept;
+
+    [[nodiscard]] unsigned depth() const noexcept;
+
+private:
+    UringReader() = default;
+
+    void unmap() noexcept;
+
+    int ringFd = -1;
+    int memFd = -1;
+
+    void* sqRing = nullptr;
+    size_t sqRingSize = 0;
+    void* cqRing = nullptr;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    uint32_t* sqHead = nullptr;
+    uint32_t* sqTail = nullptr;
+    uint32_t* sqArray = nullptr;
+    uint32_t sqMask = 0;
+    unsigned sqEntries = 0;
+
+    uint32_t* cqHead = nullptr;
+    uint32_t* cqTail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    uint32_t cqMask = 0;
+
+    uint32_t queued = 0; // поставлено, но ещё не отправлено
+    size_t pending = 0; // поставлено и не забрано
+};
@@ -0,0 +1,152 @@
+#include "addressResolver.hpp"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+AddressResolver::AddressResolver(const std::vector<MemoryRegion>& regions)
+{
+    std::map<std::string, uint32_t, std::less<>> moduleIndex{};
+    std::map<std::tuple<uint32_t, uintptr_t>, uint32_t> ordinals{};
+
+    entries.reserve(regions.size());
+
+    for(size_t i = 0; i < regions.size(); ++i)
+    {
+        const auto& reg = regions[i];
+        std::string_view name = reg.pathname;
+        uintptr_t regionOffset = reg.offset;
+
+        // .bss: анонимный регион сразу за регионом файла продолжает его смещения
+        if(name.empty() && !entries.empty() && entries.back().end == reg.start && !modules[entries.back().module].empty()
+           && !modules[entries.back().module].starts_with('['))
+        {
+            const auto& previous = entries.back();
+            name = modules[previous.module];
+            regionOffset = previous.regionOffset + (previous.end - previous.start);
+        }
+
+        auto it = moduleIndex.find(name);
+
+        if(it == moduleIndex.end())
+        {
+            it = moduleIndex.emplace(std::string(name), static_cast<uint32_t>(modules.size())).first;
+            modules.emplace_back(name);
+        }
+
+        uint32_t module = it->second;
+        uint32_t ordinal = ordinals[{module, regionOffset}]++;
+
+        entries.push_back({reg.start, reg.end, module, ordinal, regionOffset});
+    }
+
+    // /proc/pid/maps уже отсортирован, но регионы могли прийти и из другого источника
+    std::ranges::sort(entries, {}, &Entry::start);
+
+    byKey.resize(entries.size());
+    std::iota(byKey.begin(), byKey.end(), 0);
+
+    std::ranges::sort(byKey, {}, [this](uint32_t i)
+    {
+        const auto& e = entries[i];
+        return std::tuple(std::string_view(modules[e.module]), e.regionOffset, e.ordinal);
+    });
+}
+
+std::optional<ModuleAddress> AddressResolver::annotate(uintptr_t address) const
+{
+    auto index = findEntry(address);
+
+    if(!index)
+        return std::nullopt;
+
+    return toModule(entries[*index], address);
+}
+
+std::vector<std::optional<ModuleAddress>> AddressResolver::annotate(std::span<const ScanResult> results) const
+{
+    std::vector<std::optional<ModuleAddress>> annotated(results.size());
+    size_t cursor = 0;
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        uintptr_t address = results[i].address;
+
+        // вперёд -- линейно, назад -- двоичным поиском
+        if(cursor < entries.size() && address < entries[cursor].start)
+        {
+            auto index = findEntry(address);
+
+            if(!index) continue;
+
+            cursor = *index;
+        }
+
+        while(cursor < entries.size() && address >= entries[cursor].end)
+            ++cursor;
+
+        if(cursor == entries.size() || address < entries[cursor].start)
+            continue;
+
+        annotated[i] = toModule(entries[cursor], address);
+    }
+
+    return annotated;
+}
+
+std::string_view AddressResolver::moduleName(uint32_t module) const
+{
+    return modules.at(module);
+}
+
+std::optional<uintptr_t> AddressResolver::resolve(std::string_view module, uintptr_t regionOffset, uint32_t ordinal, uintptr_t offset) const
+{
+    auto key = std::tuple(module, regionOffset, ordinal);
+
+    auto it = std::ranges::lower_bound(byKey, key, {}, [this](uint32_t i)
+    {
+        const auto& e = entries[i];
+        return std::tuple(std::string_view(modules[e.module]), e.regionOffset, e.ordinal);
+    });
+
+    if(it == byKey.end())
+        return std::nullopt;
+
+    const auto& entry = entries[*it];
+
+    if(modules[entry.module] != module || entry.regionOffset != regionOffset || entry.ordinal != ordinal)
+        return std::nullopt;
+
+    if(offset >= entry.end - entry.start)
+        return std::nullopt;
+
+    return entry.start + offset;
+}
+
+std::optional<uintptr_t> AddressResolver::resolve(const ModuleAddress& address) const
+{
+    if(address.module >= modules.size())
+        return std::nullopt;
+
+    return resolve(modules[address.module], address.regionOffset, address.ordinal, address.offset);
+}
+
+std::optional<size_t> AddressResolver::findEntry(uintptr_t address) const noexcept
+{
+    auto it = std::ranges::upper_bound(entries, address, {}, &Entry::start);
+
+    if(it == entries.begin())
+        return std::nullopt;
+
+    --it;
+
+    if(address >= it->end)
+        return std::nullopt;
+
+    return static_cast<size_t>(it - entries.begin());
+}
+
+ModuleAddress AddressResolver::toModule(const Entry& entry, uintptr_t address) const noexcept
+{
+    return {entry.module, entry.ordinal, entry.regionOffset, address - entry.start};
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Process/ModuleMapParser.hpp"
+#include "scanSession.hpp"
+
+/**
+ * @brief Адрес, не зависящий от ASLR: регион модуля и смещение в нём
+ *
+ * module -- индекс имени в таблице AddressResolver::moduleName(),
+ * regionOffset -- смещение региона в файле (MemoryRegion::offset),
+ * ordinal -- номер среди регионов с тем же модулем и regionOffset,
+ * offset -- смещение адреса от начала региона
+ */
+struct ModuleAddress
+{
+    uint32_t module = 0;
+    uint32_t ordinal = 0;
+    uintptr_t regionOffset = 0;
+    uintptr_t offset = 0;
+};
+
+/**
+ * @brief Переводит абсолютные адреса в ModuleAddress и обратно для одной раскладки памяти
+ *
+ * Анонимный регион, вплотную продолжающий регион файла (.bss за .data),
+ * считается продолжением этого файла со смещением сразу за ним, поэтому
+ * глобальные переменные переживают перезапуск процесса. Остальные анонимные
+ * регионы различаются только порядковым номером и переносятся на свой страх.
+ */
+class AddressResolver
+{
+public:
+    /**
+     * @param regions регионы процесса в порядке возрастания адресов, лучше неотфильтрованные
+     */
+    explicit AddressResolver(const std::vector<MemoryRegion>& regions);
+
+    /// @brief Адрес в модульном виде или nullopt, если он не попадает ни в один регион
+    [[nodiscard]] std::optional<ModuleAddress> annotate(uintptr_t address) const;
+
+    /**
+     * @brief Переводит результаты сканирования одним проходом
+     *
+     * Результаты сессии идут по возрастанию адресов, поэтому регионы обходятся
+     * встречным курсором, а двоичный поиск нужен только при откате назад
+     */
+    [[nodiscard]] std::vector<std::optional<ModuleAddress>> annotate(std::span<const ScanResult> results) const;
+
+    /// @brief Имя модуля по индексу из ModuleAddress::module
+    [[nodiscard]] std::string_view moduleName(uint32_t module) const;
+
+    /**
+     * @brief Абсолютный адрес в этой раскладке
+     *
+     * @param module имя модуля, как его вернул moduleName() в другой раскладке
+     * @return std::optional<uintptr_t> nullopt если региона нет или он стал короче
+     */
+    [[nodiscard]] std::optional<uintptr_t> resolve(std::string_view module, uintptr_t regionOffset, uint32_t ordinal, uintptr_t offset) const;
+
+    /// @brief Абсолютный адрес для ModuleAddress, полученного от этого же резолвера
+    [[nodiscard]] std::optional<uintptr_t> resolve(const ModuleAddress& address) const;
+
+private:
+    struct Entry
+    {
+        uintptr_t start;
+        uintptr_t end;
+        uint32_t module;
+        uint32_t ordinal;
+        uintptr_t regionOffset;
+    };
+
+    [[nodiscard]] std::optional<size_t> findEntry(uintptr_t address) const noexcept;
+    [[nodiscard]] ModuleAddress toModule(const Entry& entry, uintptr_t address) const noexcept;
+
+    std::vector<std::string> modules{};
+    std::vector<Entry> entries{};
+    std::vector<uint32_t> byKey{}; // индексы entries по (имя модуля, regionOffset, ordinal)
+};
@@ -0,0 +1,467 @@
+#include "changeMonitor.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr size_t pageSize = 4096;
+    constexpr uintptr_t pageMask = ~static_cast<uintptr_t>(pageSize - 1);
+
+    /// Ключи полос накопителя: хеш не должен обнуляться на страницах из одинаковых слов
+    alignas(16) constexpr uint64_t keys[8] =
+    {
+        0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+        0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull, 0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull
+    };
+
+    /**
+     * @brief 64-битный хеш страницы
+     *
+     * Накопление как у XXH3: полоса j получает (слово ^ ключ).lo32 * (слово ^ ключ).hi32
+     * и само соседнее слово, так что любое изменение одного слова меняет хеш.
+     * На SSE2 -- две полосы в регистре, _mm_mul_epu32 даёт оба произведения сразу
+     */
+    uint64_t hashPage(const std::byte* page) noexcept
+    {
+        uint64_t acc[8] = {};
+
+#if defined(__SSE2__)
+        __m128i lanes[4];
+        __m128i secret[4];
+
+        for(size_t l = 0; l < 4; ++l)
+        {
+            lanes[l] = _mm_setzero_si128();
+            secret[l] = _mm_load_si128(reinterpret_cast<const __m128i*>(keys) + l);
+        }
+
+        for(size_t pos = 0; pos < pageSize; pos += 64)
+        {
+            for(size_t l = 0; l < 4; ++l)
+            {
+                __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(page + pos) + l);
+                __m128i mixed = _mm_xor_si128(data, secret[l]);
+                __m128i product = _mm_mul_epu32(mixed, _mm_shuffle_epi32(mixed, _MM_SHUFFLE(0, 3, 0, 1)));
+                __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+                lanes[l] = _mm_add_epi64(lanes[l], _mm_add_epi64(product, swapped));
+            }
+        }
+
+        for(size_t l = 0; l < 4; ++l)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + l, lanes[l]);
+#else
+        for(size_t pos = 0; pos < pageSize; pos += 64)
+        {
+            uint64_t data[8];
+            std::memcpy(data, page + pos, sizeof(data));
+
+            for(size_t j = 0; j < 8; ++j)
+            {
+                uint64_t mixed = data[j] ^ keys[j];
+                acc[j] += (mixed & 0xffffffffull) * (mixed >> 32) + data[j ^ 1];
+            }
+        }
+#endif
+
+        uint64_t h = 0x9E3779B97F4A7C15ull;
+
+        for(size_t j = 0; j < 8; ++j)
+            h = std::rotl((h ^ acc[j]) * 0xff51afd7ed558ccdull, 29);
+
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+    uint64_t elapsedNs(std::chrono::steady_clock::time_point origin) noexcept
+    {
+        return static_cast<uint64_t>((std::chrono::steady_clock::now() - origin).count());
+    }
+}
+
+ChangeMonitor::ChangeMonitor(Memory mem, const Value& type)
+    : mem(std::move(mem)), type(type), valSize(std::max<size_t>(type.size(), 1)), origin(std::chrono::steady_clock::now()) {}
+
+ChangeMonitor::~ChangeMonitor()
+{
+    stop();
+}
+
+size_t ChangeMonitor::watch(uintptr_t address)
+{
+    std::lock_guard lock(mutex);
+
+    addresses.push_back(address);
+    return addresses.size() - 1;
+}
+
+void ChangeMonitor::watch(std::span<const ScanResult> results)
+{
+    std::lock_guard lock(mutex);
+
+    for(const auto& result : results)
+        addresses.push_back(result.address);
+}
+
+void ChangeMonitor::clear()
+{
+    std::lock_guard lock(mutex);
+
+    addresses.clear();
+    baseline.clear();
+    done.clear();
+    pages.clear();
+    found.clear();
+    cursor = 0;
+    finished = 0;
+    counters = {};
+}
+
+/**
+ * @brief Читает исходные значения и строит список страниц
+ *
+ * Значение, пересекающее границу страниц, числится за обеими. Адрес, который
+ * не прочитался целиком, сразу помечается проверенным и не наблюдается
+ */
+std::expected<size_t, MemoryError> ChangeMonitor::arm()
+{
+    std::lock_guard lock(mutex);
+
+    baseline.assign(addresses.size() * valSize, std::byte{0});
+    done.assign(addresses.size(), 0);
+    found.clear();
+    pages.clear();
+    cursor = 0;
+    finished = 0;
+    counters = {};
+    origin = std::chrono::steady_clock::now();
+
+    std::vector<uint32_t> order(addresses.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, {}, [&](uint32_t i) { return addresses[i]; });
+
+    size_t readable = 0;
+
+    for(uint32_t i : order)
+    {
+        auto read = mem.readBlock(addresses[i], valSize, baseline.data() + i * valSize);
+
+        if(!read)
+        {
+            if(read.error() == MemoryError::InvalidIdentifier)
+                return std::unexpected{read.error()};
+
+            done[i] = 1;
+            continue;
+        }
+
+        if(*read < valSize)
+        {
+            done[i] = 1;
+            continue;
+        }
+
+        ++readable;
+
+        for(uintptr_t page = addresses[i] & pageMask; page < addresses[i] + valSize; page += pageSize)
+        {
+            auto it = std::ranges::lower_bound(pages, page, {}, &Page::address);
+
+            if(it == pages.end() || it->address != page)
+                it = pages.insert(it, Page{page});
+
+            it->slots.push_back(i);
+            it->waiting++;
+        }
+    }
+
+    // исходные хеши: без них первый тик принял бы каждую страницу за изменённую
+    spans.resize(pages.size());
+    spanValid.assign(pages.size(), 0);
+    readBuffer.resize(pages.size() * pageSize);
+
+    for(size_t p = 0; p < pages.size(); ++p)
+        spans[p] = {pages[p].address, pageSize};
+
+    if(auto read = mem.readScatter(spans, readBuffer.data(), spanValid.data()); !read)
+        return std::unexpected{read.error()};
+
+    uint64_t nowNs = elapsedNs(origin);
+
+    for(size_t p = 0; p < pages.size(); ++p)
+    {
+        pages[p].hash = spanValid[p] ? hashPage(readBuffer.data() + p * pageSize) : 0;
+        pages[p].seenNs = nowNs;
+    }
+
+    counters.activePages = pages.size();
+    return readable;
+}
+
+/**
+ * @brief Опрашивает срез страниц, начиная с cursor
+ *
+ * Размер среза -- сколько страниц укладывается в половину периода по сглаженной цене
+ * страницы, но не меньше одной. Соседние страницы среза склеиваются в один iovec
+ */
+std::expected<size_t, MemoryError> ChangeMonitor::pollOnce()
+{
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<ChangeHit> fresh{};
+    std::function<void(const ChangeHit&)> handler{};
+
+    {
+        std::lock_guard lock(mutex);
+
+        if(finished > 0)
+            dropFinished();
+
+        if(pages.empty())
+            return 0;
+
+        size_t budget = pageCostNs > 0.0
+            ? static_cast<size_t>(static_cast<double>(period.count()) / 2.0 / pageCostNs)
+            : pages.size();
+
+        size_t count = std::clamp<size_t>(budget, 1, pages.size());
+        size_t first = cursor % pages.size();
+
+        spans.clear();
+
+        // срез может перейти через конец списка, тогда склейка рвётся на переходе
+        for(size_t n = 0; n < count; ++n)
+        {
+            uintptr_t address = pages[(first + n) % pages.size()].address;
+
+            if(!spans.empty() && spans.back().address + spans.back().size == address)
+                spans.back().size += pageSize;
+            else
+                spans.push_back({address, pageSize});
+        }
+
+        spanValid.assign(spans.size(), 0);
+        readBuffer.resize(count * pageSize);
+
+        uint64_t readNs = elapsedNs(origin);
+
+        if(auto read = mem.readScatter(spans, readBuffer.data(), spanValid.data()); !read)
+            return std::unexpected{read.error()};
+
+        // склеенный участок не читается целиком из-за одной снятой страницы,
+        // поэтому его страницы дочитываются по одной
+        pageValid.assign(count, 0);
+
+        for(size_t span = 0, n = 0; span < spans.size(); n += spans[span].size / pageSize, ++span)
+        {
+            size_t spanPages = spans[span].size / pageSize;
+
+            if(spanValid[span])
+            {
+                std::fill_n(pageValid.begin() + static_cast<ptrdiff_t>(n), spanPages, 1);
+                continue;
+            }
+
+            for(size_t k = 0; spanPages > 1 && k < spanPages; ++k)
+            {
+                auto read = mem.readBlock(spans[span].address + k * pageSize, pageSize, readBuffer.data() + (n + k) * pageSize);
+                pageValid[n + k] = read && *read == pageSize;
+            }
+        }
+
+        // срез не прочитался целиком: если процесса уже нет, опрашивать дальше нечего
+        if(std::none_of(pageValid.begin(), pageValid.end(), [](uint8_t valid) { return valid != 0; }) &&
+           ::kill(mem.getPid(), 0) != 0 && errno == ESRCH)
+            return std::unexpected{MemoryError::ReadError};
+
+        for(size_t n = 0; n < count; ++n)
+        {
+            // не прочитанная страница (регион снят) остаётся со старым хешем
+            if(!pageValid[n]) continue;
+
+            Page& page = pages[(first + n) % pages.size()];
+            uint64_t hash = hashPage(readBuffer.data() + n * pageSize);
+
+            if(hash != page.hash)
+            {
+                page.hash = hash;
+                counters.pagesChanged++;
+                checkPage(page, readNs, fresh);
+            }
+
+            page.seenNs = readNs;
+        }
+
+        cursor = (first + count) % pages.size();
+
+        auto cost = std::chrono::steady_clock::now() - begin;
+        double perPage = static_cast<double>(cost.count()) / static_cast<double>(count);
+
+        pageCostNs = pageCostNs > 0.0 ? pageCostNs * 0.875 + perPage * 0.125 : perPage;
+
+        counters.ticks++;
+        counters.pagesPolled += count;
+        counters.pagesPerTick = count;
+        counters.tickCost = cost;
+        counters.sweep = period * static_cast<int64_t>((pages.size() + count - 1) / count);
+
+        found.insert(found.end(), fresh.begin(), fresh.end());
+
+        // копия под mutex: setOnChange() из другого потока не заменит функцию во время вызова
+        if(!fresh.empty())
+            handler = onChange;
+    }
+
+    if(handler)
+    {
+        for(const auto& hit : fresh)
+            handler(hit);
+    }
+
+    return fresh.size();
+}
+
+void ChangeMonitor::checkPage(Page& page, uint64_t nowNs, std::vector<ChangeHit>& out)
+{
+    std::byte current[64];
+    std::vector<std::byte> large{};
+    std::byte* bytes = current;
+
+    if(valSize > sizeof(current))
+    {
+        large.resize(valSize);
+        bytes = large.data();
+    }
+
+    for(uint32_t slot : page.slots)
+    {
+        if(done[slot]) continue;
+
+        auto read = mem.readBlock(addresses[slot], valSize, bytes);
+
+        if(!read || *read < valSize) continue;
+
+        std::span<const std::byte> before(baseline.data() + slot * valSize, valSize);
+        std::span<const std::byte> after(bytes, valSize);
+
+        if(std::ranges::equal(before, after)) continue;
+
+        done[slot] = 1;
+
+        out.push_back({slot, addresses[slot], std::chrono::nanoseconds(page.seenNs), std::chrono::nanoseconds(nowNs),
+                       type.fromMemory(before), type.fromMemory(after)});
+
+        // значение на стыке страниц ждёт и на соседней
+        auto it = std::ranges::lower_bound(pages, addresses[slot] & pageMask, {}, &Page::address);
+
+        for(; it != pages.end() && it->address < addresses[slot] + valSize; ++it)
+        {
+            if(--it->waiting == 0)
+                ++finished;
+        }
+    }
+}
+
+void ChangeMonitor::dropFinished()
+{
+    uintptr_t next = pages.empty() ? 0 : pages[cursor % pages.size()].address;
+
+    std::erase_if(pages, [](const Page& page) { return page.waiting == 0; });
+
+    // опрос продолжается с той же страницы, а не с начала
+    cursor = static_cast<size_t>(std::ranges::lower_bound(pages, next, {}, &Page::address) - pages.begin());
+    finished = 0;
+    counters.activePages = pages.size();
+}
+
+void ChangeMonitor::start(std::chrono::microseconds period)
+{
+    stop();
+    setPeriod(period);
+
+    {
+        std::lock_guard lock(mutex);
+        pollFailure.reset();
+    }
+
+    poller = std::jthread([this, period](std::stop_token stop)
+    {
+        auto next = std::chrono::steady_clock::now();
+
+        while(!stop.stop_requested())
+        {
+            // процесс завершился или память больше не читается: опрашивать нечего
+            if(auto polled = pollOnce(); !polled &&
+               (polled.error() == MemoryError::InvalidIdentifier || polled.error() == MemoryError::ReadError))
+            {
+                std::lock_guard lock(mutex);
+                pollFailure = polled.error();
+                return;
+            }
+
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+
+            // опоздавший тик не догоняется пачкой: срез и так подобран под период
+            if(next < now)
+                next = now;
+            else
+                std::this_thread::sleep_until(next);
+        }
+    });
+}
+
+void ChangeMonitor::stop()
+{
+    if(poller.joinable())
+    {
+        poller.request_stop();
+        poller.join();
+    }
+}
+
+void ChangeMonitor::setOnChange(std::function<void(const ChangeHit&)> callBack)
+{
+    std::lock_guard lock(mutex);
+    onChange = std::move(callBack);
+}
+
+std::vector<ChangeHit> ChangeMonitor::hits() const
+{
+    std::lock_guard lock(mutex);
+    return found;
+}
+
+size_t ChangeMonitor::pending() const
+{
+    std::lock_guard lock(mutex);
+    return static_cast<size_t>(std::ranges::count(done, 0));
+}
+
+std::optional<MemoryError> ChangeMonitor::pollError() const
+{
+    std::lock_guard lock(mutex);
+    return pollFailure;
+}
+
+MonitorStats ChangeMonitor::stats() const
+{
+    std::lock_guard lock(mutex);
+    return counters;
+}
+
+void ChangeMonitor::setPeriod(std::chrono::microseconds period)
+{
+    std::lock_guard lock(mutex);
+    this->period = period;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "../Process/MemoryReader.hpp"
+#include "scanSession.hpp"
+#include "value.hpp"
+
+/**
+ * @brief Первое изменение значения по наблюдаемому адресу
+ *
+ * Запись произошла между before (последнее чтение страницы, где значение было прежним)
+ * и time (чтение, заметившее изменение), оба момента -- от arm()
+ */
+struct ChangeHit
+{
+    size_t index;
+    uintptr_t address;
+    std::chrono::nanoseconds before;
+    std::chrono::nanoseconds time;
+    Value previous;
+    Value current;
+};
+
+/**
+ * @brief Счётчики монитора
+ *
+ * ticks -- сколько срезов опрошено
+ * pagesPolled -- сколько страниц прочитано и захешировано
+ * pagesChanged -- у скольких из них сменился хеш
+ * activePages -- сколько страниц ещё опрашивается (у остальных все адреса уже изменились)
+ * pagesPerTick -- текущий размер среза
+ * sweep -- за сколько обходятся все активные страницы: граница задержки обнаружения
+ * tickCost -- сколько занял последний срез
+ */
+struct MonitorStats
+{
+    size_t ticks = 0;
+    size_t pagesPolled = 0;
+    size_t pagesChanged = 0;
+    size_t activePages = 0;
+    size_t pagesPerTick = 0;
+    std::chrono::nanoseconds sweep{};
+    std::chrono::nanoseconds tickCost{};
+};
+
+/**
+ * @brief Замена аппаратной точки останова на запись: частый опрос страниц с наблюдаемыми адресами
+ *
+ * Вместо повторного сканирования читаются только страницы, где лежат адреса, пачками
+ * через Memory::readScatter (соседние страницы -- одним iovec). Каждая страница хешируется
+ * (по 16 байт за шаг на SSE2, схема накопления как у XXH3), и только при смене хеша значения
+ * её адресов перечитываются через Memory::readBlock и сравниваются с исходными.
+ * Для каждого адреса запоминается лишь первое изменение, после него адрес больше
+ * не проверяется, а страница без непроверенных адресов выпадает из опроса.
+ *
+ * Период делится на срезы: за один тик читается столько страниц, сколько укладывается
+ * в половину периода по измеренной цене страницы, остальные -- в следующих тиках по кругу.
+ * Так тик не вылезает за период, а задержка обнаружения ограничена временем обхода
+ * (MonitorStats::sweep) даже для сотен страниц на одном ядре
+ */
+class ChangeMonitor
+{
+public:
+    /**
+     * @param mem память наблюдаемого процесса
+     * @param type значение, задающее тип и размер наблюдаемых данных
+     */
+    ChangeMonitor(Memory mem, const Value& type);
+    ~ChangeMonitor();
+
+    ChangeMonitor(const ChangeMonitor&) = delete;
+    ChangeMonitor& operator=(const ChangeMonitor&) = delete;
+
+    /// @brief Добавляет адрес в наблюдение, возвращает его индекс; действует с следующего arm()
+    size_t watch(uintptr_t address);
+
+    /// @brief Добавляет в наблюдение все адреса сессии
+    void watch(std::span<const ScanResult> results);
+
+    void clear();
+
+    /**
+     * @brief Запоминает исходные значения и хеши страниц, сбрасывает найденные изменения
+     *
+     * @return std::expected<size_t, MemoryError> сколько адресов удалось прочитать; не прочитанные не наблюдаются
+     * @retval ошибка readScatter() если pid не инициализирован
+     */
+    std::expected<size_t, MemoryError> arm();
+
+    /**
+     * @brief Один тик: опрашивает следующий срез страниц
+     *
+     * Склеенный участок, который не прочитался, дочитывается по страницам: снятая
+     * страница не прячет изменения на соседних
+     *
+     * @return std::expected<size_t, MemoryError> сколько адресов впервые изменилось
+     * @retval InvalidIdentifier если pid не инициализирован
+     * @retval ReadError если ни одна страница среза не прочиталась и процесс завершился
+     */
+    std::expected<size_t, MemoryError> pollOnce();
+
+    /**
+     * @brief Запускает фоновый опрос: тик каждые period
+     *
+     * Поток завершается сам, если тик вернул InvalidIdentifier или ReadError, ошибка -- в pollError()
+     *
+     * @param period период тика, например 1000 мкс для 1 кГц
+     */
+    void start(std::chrono::microseconds period);
+    void stop();
+
+    /// @brief Ошибка, на которой остановился фоновый опрос, или nullopt
+    [[nodiscard]] std::optional<MemoryError> pollError() const;
+
+    /// @brief Обработчик первых изменений, вызывается из потока опроса
+    void setOnChange(std::function<void(const ChangeHit&)> callBack);
+
+    /// @brief Найденные изменения в порядке обнаружения
+    [[nodiscard]] std::vector<ChangeHit> hits() const;
+
+    /// @brief Сколько адресов ещё не изменилось
+    [[nodiscard]] size_t pending() const;
+
+    [[nodiscard]] MonitorStats stats() const;
+
+    /// @brief Период, под который подбирается размер среза; до start() -- 1 мс
+    void setPeriod(std::chrono::microseconds period);
+
+private:
+    /// @brief Наблюдаемая страница: её адреса и хеш на последнем чтении
+    struct Page
+    {
+        uintptr_t address;
+        uint64_t hash = 0;
+        uint64_t seenNs = 0; // момент последнего чтения
+        std::vector<uint32_t> slots{}; // индексы адресов, задевающих страницу
+        uint32_t waiting = 0; // сколько из них ещё не изменилось
+    };
+
+    /// @brief Перечитывает значения адресов страницы, у которой сменился хеш
+    void checkPage(Page& page, uint64_t nowNs, std::vector<ChangeHit>& found);
+
+    /// @brief Убирает из опроса страницы без ожидающих адресов
+    void dropFinished();
+
+    Memory mem;
+    Value type;
+    size_t valSize;
+
+    std::vector<uintptr_t> addresses{};
+    std::vector<std::byte> baseline{}; // исходные байты, по valSize на адрес
+    std::vector<uint8_t> done{}; // 1 -- первое изменение найдено или адрес не читается
+
+    std::vector<Page> pages{}; // по возрастанию адресов
+    size_t cursor = 0; // с какой страницы начнётся следующий срез
+    size_t finished = 0; // сколько страниц опустело с прошлой чистки
+
+    std::vector<MemorySpan> spans{};
+    std::vector<uint8_t> spanValid{};
+    std::vector<uint8_t> pageValid{}; // по странице среза
+    std::vector<std::byte> readBuffer{};
+
+    std::vector<ChangeHit> found{};
+    std::function<void(const ChangeHit&)> onChange{};
+    std::optional<MemoryError> pollFailure{};
+
+    MonitorStats counters{};
+    double pageCostNs = 0.0; // сглаженная цена чтения и хеша одной страницы
+    std::chrono::nanoseconds period{std::chrono::milliseconds(1)};
+    std::chrono::steady_clock::time_point origin{};
+
+    mutable std::mutex mutex{};
+    std::jthread poller{};
+};
@@ -0,0 +1,392 @@
+#include "floatRange.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    /// @brief Границы в типе значения
+    template <typename T>
+    struct Bounds
+    {
+        T low;
+        T high;
+        bool denormals;
+    };
+
+    /// Сколько групп одного вызова векторного ядра
+    constexpr size_t kernelGroups = 32;
+
+    template <typename T>
+    bool isDenormal(T number) noexcept
+    {
+        return number != 0 && std::abs(number) < std::numeric_limits<T>::min();
+    }
+
+    template <typename T>
+    bool inRange(T number, const Bounds<T>& bounds) noexcept
+    {
+        // сравнения с NaN ложны, отдельная проверка не нужна
+        if(!(number >= bounds.low && number <= bounds.high))
+            return false;
+
+        return bounds.denormals || !isDenormal(number);
+    }
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& number) noexcept
+    {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+        return ec == std::errc{} && ptr == text.data() + text.size() && !text.empty() && !std::isnan(number);
+    }
+
+    /// @brief Наименьшее число типа T не меньше bound (при exclusive -- строго больше)
+    template <typename T>
+    T ceilTo(double bound, bool exclusive) noexcept
+    {
+        auto number = static_cast<T>(bound);
+
+        while(exclusive ? static_cast<double>(number) <= bound : static_cast<double>(number) < bound)
+            number = std::nextafter(number, std::numeric_limits<T>::infinity());
+
+        return number;
+    }
+
+    /// @brief Наибольшее число типа T не больше bound (при exclusive -- строго меньше)
+    template <typename T>
+    T floorTo(double bound, bool exclusive) noexcept
+    {
+        auto number = static_cast<T>(bound);
+
+        while(exclusive ? static_cast<double>(number) >= bound : static_cast<double>(number) > bound)
+            number = std::nextafter(number, -std::numeric_limits<T>::infinity());
+
+        return number;
+    }
+
+    /// @brief Сколько знаков после точки в записи числа
+    size_t decimals(std::string_view text) noexcept
+    {
+        auto point = text.find('.');
+        return point == std::string_view::npos ? 0 : text.size() - point - 1;
+    }
+
+    /// @brief Раздвигает 4 бита маски через один: 0b1011 -> 0b1000101
+    uint32_t spread(uint32_t mask) noexcept
+    {
+        static constexpr uint8_t table[16] = {0, 1, 4, 5, 16, 17, 20, 21, 64, 65, 68, 69, 80, 81, 84, 85};
+        return table[mask & 0xf];
+    }
+
+#if defined(__SSE2__)
+    /**
+     * @brief Маски совпадений для groups групп подряд (SSE2)
+     *
+     * Группа -- 4 позиции у float и 2 или 4 у double. Для double с шагом 4 вторая загрузка
+     * сдвинута на 4 байта и даёт нечётные позиции, маски чередуются через spread()
+     */
+    template <typename T>
+    void masksSse(const std::byte* data, size_t groups, size_t step, const Bounds<T>& bounds, uint32_t* masks) noexcept
+    {
+        if constexpr(std::is_same_v<T, float>)
+        {
+            const __m128 low = _mm_set1_ps(bounds.low);
+            const __m128 high = _mm_set1_ps(bounds.high);
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            const __m128 smallest = _mm_set1_ps(std::numeric_limits<float>::min());
+
+            for(size_t g = 0; g < groups; ++g, data += 16)
+            {
+                __m128 v = _mm_loadu_ps(reinterpret_cast<const float*>(data));
+                __m128 hit = _mm_and_ps(_mm_cmpge_ps(v, low), _mm_cmple_ps(v, high));
+
+                if(!bounds.denormals)
+                {
+                    __m128 magnitude = _mm_and_ps(v, absMask);
+                    hit = _mm_and_ps(hit, _mm_or_ps(_mm_cmpge_ps(magnitude, smallest), _mm_cmpeq_ps(magnitude, _mm_setzero_ps())));
+                }
+
+                masks[g] = static_cast<uint32_t>(_mm_movemask_ps(hit));
+            }
+        }
+        else
+        {
+            const __m128d low = _mm_set1_pd(bounds.low);
+            const __m128d high = _mm_set1_pd(bounds.high);
+            const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffff));
+            const __m128d smallest = _mm_set1_pd(std::numeric_limits<double>::min());
+
+            auto lanes = [&](const std::byte* at)
+            {
+                __m128d v = _mm_loadu_pd(reinterpret_cast<const double*>(at));
+                __m128d hit = _mm_and_pd(_mm_cmpge_pd(v, low), _mm_cmple_pd(v, high));
+
+                if(!bounds.denormals)
+                {
+                    __m128d magnitude = _mm_and_pd(v, absMask);
+                    hit = _mm_and_pd(hit, _mm_or_pd(_mm_cmpge_pd(magnitude, smallest), _mm_cmpeq_pd(magnitude, _mm_setzero_pd())));
+                }
+
+                return static_cast<uint32_t>(_mm_movemask_pd(hit));
+            };
+
+            for(size_t g = 0; g < groups; ++g, data += 16)
+                masks[g] = step == 8 ? lanes(data) : spread(lanes(data)) | spread(lanes(data + 4)) << 1;
+        }
+    }
+
+    /// @brief То же по 8 float или 4 double за раз, вызывается только при поддержке AVX
+    template <typename T>
+    __attribute__((target("avx")))
+    void masksAvx(const std::byte* data, size_t groups, size_t step, const Bounds<T>& bounds, uint32_t* masks) noexcept
+    {
+        if constexpr(std::is_same_v<T, float>)
+        {
+            const __m256 low = _mm256_set1_ps(bounds.low);
+            const __m256 high = _mm256_set1_ps(bounds.high);
+            const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+            const __m256 smallest = _mm256_set1_ps(std::numeric_limits<float>::min());
+
+            for(size_t g = 0; g < groups; ++g, data += 32)
+            {
+                __m256 v = _mm256_loadu_ps(reinterpret_cast<const float*>(data));
+                __m256 hit = _mm256_and_ps(_mm256_cmp_ps(v, low, _CMP_GE_OQ), _mm256_cmp_ps(v, high, _CMP_LE_OQ));
+
+                if(!bounds.denormals)
+                {
+                    __m256 magnitude = _mm256_and_ps(v, absMask);
+                    hit = _mm256_and_ps(hit, _mm256_or_ps(_mm256_cmp_ps(magnitude, smallest, _CMP_GE_OQ),
+                                                          _mm256_cmp_ps(magnitude, _mm256_setzero_ps(), _CMP_EQ_OQ)));
+                }
+
+                masks[g] = static_cast<uint32_t>(_mm256_movemask_ps(hit));
+            }
+        }
+        else
+        {
+            const __m256d low = _mm256_set1_pd(bounds.low);
+            const __m256d high = _mm256_set1_pd(bounds.high);
+            const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffff));
+            const __m256d smallest = _mm256_set1_pd(std::numeric_limits<double>::min());
+
+            for(size_t g = 0; g < groups; ++g, data += 32)
+            {
+                uint32_t lanes[2]{};
+
+                for(size_t half = 0; half < (step == 8 ? 1u : 2u); ++half)
+                {
+                    __m256d v = _mm256_loadu_pd(reinterpret_cast<const double*>(data + half * 4));
+                    __m256d hit = _mm256_and_pd(_mm256_cmp_pd(v, low, _CMP_GE_OQ), _mm256_cmp_pd(v, high, _CMP_LE_OQ));
+
+                    if(!bounds.denormals)
+                    {
+                        __m256d magnitude = _mm256_and_pd(v, absMask);
+                        hit = _mm256_and_pd(hit, _mm256_or_pd(_mm256_cmp_pd(magnitude, smallest, _CMP_GE_OQ),
+                                                              _mm256_cmp_pd(magnitude, _mm256_setzero_pd(), _CMP_EQ_OQ)));
+                    }
+
+                    lanes[half] = static_cast<uint32_t>(_mm256_movemask_pd(hit));
+                }
+
+                masks[g] = step == 8 ? lanes[0] : spread(lanes[0]) | spread(lanes[1]) << 1;
+            }
+        }
+    }
+
+    const bool hasAvx = __builtin_cpu_supports("avx");
+#endif
+
+    template <typename T>
+    size_t collect(const Bounds<T>& bounds, std::span<const std::byte> data, size_t from, size_t step, uint32_t* out, size_t& count) noexcept
+    {
+        count = 0;
+
+        if(data.size() < sizeof(T))
+            return data.size();
+
+        // последняя позиция, с которой значение ещё помещается в блок
+        size_t lastStart = data.size() - sizeof(T);
+        const std::byte* bytes = data.data();
+        size_t pos = from;
+
+#if defined(__SSE2__)
+        if(step == sizeof(T) || (sizeof(T) == 8 && step == 4))
+        {
+            // позиций в группе: одна загрузка на 16 или 32 байта, у double с шагом 4 -- две
+            size_t group = (hasAvx ? 32 : 16) / step;
+            uint32_t masks[kernelGroups];
+
+            while(pos + (group - 1) * step <= lastStart && count + group <= FloatRange::batch)
+            {
+                size_t groups = std::min({kernelGroups, (lastStart - pos - (group - 1) * step) / (group * step) + 1, (FloatRange::batch - count) / group});
+
+                if(hasAvx)
+                    masksAvx(bytes + pos, groups, step, bounds, masks);
+                else
+                    masksSse(bytes + pos, groups, step, bounds, masks);
+
+                for(size_t g = 0; g < groups; ++g, pos += group * step)
+                {
+                    for(uint32_t mask = masks[g]; mask; mask &= mask - 1)
+                        out[count++] = static_cast<uint32_t>(pos + std::countr_zero(mask) * step);
+                }
+            }
+        }
+#endif
+
+        for(; pos <= lastStart; pos += step)
+        {
+            if(count == FloatRange::batch)
+                return pos;
+
+            T number;
+            std::memcpy(&number, bytes + pos, sizeof(T));
+
+            if(inRange(number, bounds))
+                out[count++] = static_cast<uint32_t>(pos);
+        }
+
+        return data.size();
+    }
+
+    template <typename T>
+    std::expected<FloatRange, ValueError> shownAs(std::string_view text, FloatRange::Rounding rounding, unsigned ulps, auto make)
+    {
+        if(rounding == FloatRange::Rounding::Ulp)
+        {
+            T number{};
+
+            if(!parseNumber(text, number))
+                return std::unexpected{ValueError::InvalidFormat};
+
+            T low = number;
+            T high = number;
+
+            for(unsigned i = 0; i < ulps; ++i)
+            {
+                low = std::nextafter(low, -std::numeric_limits<T>::infinity());
+                high = std::nextafter(high, std::numeric_limits<T>::infinity());
+            }
+
+            return make(low, high);
+        }
+
+        double number = 0.0;
+
+        if(text.find_first_of("eE") != std::string_view::npos || !parseNumber(text, number))
+            return std::unexpected{ValueError::InvalidFormat};
+
+        double unit = std::pow(10.0, -static_cast<double>(decimals(text)));
+
+        if(rounding == FloatRange::Rounding::Rounded)
+            return make(ceilTo<T>(number - unit / 2, false), floorTo<T>(number + unit / 2, true));
+
+        // отбрасывание знаков идёт к нулю
+        if(text.starts_with('-'))
+            return make(ceilTo<T>(number - unit, true), floorTo<T>(number, false));
+
+        return make(ceilTo<T>(number, false), floorTo<T>(number + unit, true));
+    }
+
+    bool isFloating(Value::ValueType type) noexcept
+    {
+        return type == Value::ValueType::Float || type == Value::ValueType::Double;
+    }
+}
+
+FloatRange::FloatRange(Value::ValueType type, double low, double high, bool denormals) noexcept
+    : kind(type), low(low), high(high), denormals(denormals) {}
+
+std::expected<FloatRange, ValueError> FloatRange::between(Value::ValueType type, std::string_view minText, std::string_view maxText)
+{
+    auto build = [&]<typename T>() -> std::expected<FloatRange, ValueError>
+    {
+        T low{};
+        T high{};
+
+        if(!parseNumber(minText, low) || !parseNumber(maxText, high) || low > high)
+            return std::unexpected{ValueError::InvalidFormat};
+
+        return FloatRange(type, low, high, isDenormal(low) || isDenormal(high));
+    };
+
+    if(!isFloating(type))
+        return std::unexpected{ValueError::InvalidType};
+
+    return type == Value::ValueType::Float ? build.template operator()<float>() : build.template operator()<double>();
+}
+
+std::expected<FloatRange, ValueError> FloatRange::shown(Value::ValueType type, std::string_view text, Rounding rounding, unsigned ulps)
+{
+    if(!isFloating(type))
+        return std::unexpected{ValueError::InvalidType};
+
+    auto make = [&](auto low, auto high) -> std::expected<FloatRange, ValueError>
+    {
+        if(low > high)
+            return std::unexpected{ValueError::InvalidFormat};
+
+        return FloatRange(type, low, high, isDenormal(low) || isDenormal(high));
+    };
+
+    if(type == Value::ValueType::Float)
+        return shownAs<float>(text, rounding, ulps, make);
+
+    return shownAs<double>(text, rounding, ulps, make);
+}
+
+size_t FloatRange::size() const noexcept
+{
+    return kind == Value::ValueType::Float ? sizeof(float) : sizeof(double);
+}
+
+Value::ValueType FloatRange::type() const noexcept
+{
+    return kind;
+}
+
+double FloatRange::min() const noexcept
+{
+    return low;
+}
+
+double FloatRange::max() const noexcept
+{
+    return high;
+}
+
+Value FloatRange::value() const
+{
+    return kind == Value::ValueType::Float ? Value(static_cast<float>(low)) : Value(low);
+}
+
+bool FloatRange::match(std::span<const std::byte> memory, double) const noexcept
+{
+    if(kind == Value::ValueType::Float)
+    {
+        float number;
+        std::memcpy(&number, memory.data(), sizeof(number));
+
+        return inRange(number, Bounds<float>{static_cast<float>(low), static_cast<float>(high), denormals});
+    }
+
+    double number;
+    std::memcpy(&number, memory.data(), sizeof(number));
+
+    return inRange(number, Bounds<double>{low, high, denormals});
+}
+
+size_t FloatRange::candidates(std::span<const std::byte> data, size_t from, size_t step, uint32_t* out, size_t& count) const noexcept
+{
+    if(kind == Value::ValueType::Float)
+        return collect(Bounds<float>{static_cast<float>(low), static_cast<float>(high), denormals}, data, from, step, out, count);
+
+    return collect(Bounds<double>{low, high, denormals}, data, from, step, out, count);
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string_view>
+#include "value.hpp"
+
+/**
+ * @brief Поиск float/double по интервалу вместо сравнения с погрешностью
+ *
+ * Значение на экране обычно округлено, поэтому "12.3" -- это не одно число, а все числа
+ * типа, которые так отображаются. Интервал [min, max] хранится уже в точности типа,
+ * так что проверка -- два сравнения без погрешности.
+ * NaN не совпадает никогда. Денормализованные числа (частый мусор в неинициализированной
+ * памяти) отсекаются, если только сами границы не денормализованные
+ */
+class FloatRange
+{
+public:
+    /**
+     * @brief Как значение было получено из числа в памяти
+     *
+     * Truncated -- отброшены лишние знаки: "12.3" это [12.3, 12.4), для отрицательных (-12.4, -12.3]
+     * Rounded -- округлено до знаков текста: "12.3" это [12.25, 12.35)
+     * Ulp -- то же число с точностью до нескольких шагов сетки типа
+     */
+    enum class Rounding
+    {
+        Truncated,
+        Rounded,
+        Ulp
+    };
+
+    /// Сколько позиций собирает candidates() за один вызов
+    static constexpr size_t batch = 256;
+
+    /**
+     * @brief Интервал [min, max] включительно
+     *
+     * @param type Float или Double
+     * @param minText нижняя граница
+     * @param maxText верхняя граница
+     * @retval ValueError::InvalidType если тип не float/double
+     * @retval ValueError::InvalidFormat если граница не число, NaN или min > max
+     */
+    static std::expected<FloatRange, ValueError> between(Value::ValueType type, std::string_view minText, std::string_view maxText);
+
+    /**
+     * @brief Все числа типа, которые выглядят как text при заданном способе округления
+     *
+     * Для Truncated и Rounded число знаков берётся из текста ("12" -- целые, "12.30" -- сотые)
+     *
+     * @param type Float или Double
+     * @param text число, как оно показано
+     * @param rounding способ округления
+     * @param ulps допуск для Rounding::Ulp в шагах сетки типа
+     * @retval ValueError::InvalidType если тип не float/double
+     * @retval ValueError::InvalidFormat если текст не число или, кроме Ulp, записан с экспонентой
+     */
+    static std::expected<FloatRange, ValueError> shown(Value::ValueType type, std::string_view text, Rounding rounding, unsigned ulps = 4);
+
+    /// @brief Размер значения в байтах: 4 или 8
+    [[nodiscard]] size_t size() const noexcept;
+
+    [[nodiscard]] Value::ValueType type() const noexcept;
+
+    [[nodiscard]] double min() const noexcept;
+    [[nodiscard]] double max() const noexcept;
+
+    /// @brief Нижняя граница как Value: тип для вывода и дальнейших отсевов
+    [[nodiscard]] Value value() const;
+
+    /**
+     * @brief Проверяет одно значение
+     *
+     * @param memory байты значения, не меньше size()
+     * @param epsilon не используется: интервал уже учитывает округление
+     */
+    [[nodiscard]] bool match(std::span<const std::byte> memory, double epsilon = 0.0) const noexcept;
+
+    /**
+     * @brief Собирает позиции data с шагом step, где лежат значения из интервала
+     *
+     * Сравнивает по 8 значений за раз (AVX, если процессор его поддерживает, иначе SSE2 по 4).
+     * Векторный путь работает при шаге, равном размеру типа, и для double при шаге 4,
+     * остальное проверяется по одному
+     *
+     * @param from с какой позиции продолжать, кратна step
+     * @param out не меньше batch элементов
+     * @param count сколько позиций записано
+     * @return size_t позиция для следующего вызова, data.size() если блок пройден
+     */
+    size_t candidates(std::span<const std::byte> data, size_t from, size_t step, uint32_t* out, size_t& count) const noexcept;
+
+private:
+    FloatRange(Value::ValueType type, double low, double high, bool denormals) noexcept;
+
+    Value::ValueType kind;
+    double low;
+    double high;
+    bool denormals; // пропускать ли денормализованные числа
+};
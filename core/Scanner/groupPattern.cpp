@@ -0,0 +1,153 @@
+#include "groupPattern.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace
+{
+    /**
+     * @brief Грубая оценка избирательности поля: чем больше, тем реже совпадение
+     *
+     * Строки избирательнее чисел, длинные числа избирательнее коротких,
+     * float/double теряют часть бит на погрешности, а нулевые значения
+     * встречаются в памяти чаще всего и идут в конец
+     */
+    size_t selectivity(const Value& value)
+    {
+        size_t size = value.size();
+
+        if(value.textPattern())
+            return 1024 + size;
+
+        size_t score = size * 8;
+
+        if(value.type() == Value::ValueType::Float || value.type() == Value::ValueType::Double)
+            score -= 12;
+
+        std::vector<std::byte> bytes(size);
+        value.store(bytes.data());
+
+        if(std::ranges::all_of(bytes, [](std::byte b) { return b == std::byte{0}; }))
+            score /= 8;
+
+        return score;
+    }
+}
+
+std::expected<GroupPattern, ValueError> GroupPattern::parse(std::string_view text)
+{
+    std::vector<GroupField> fields{};
+
+    while(!text.empty())
+    {
+        auto begin = text.find_first_not_of(" \t");
+
+        if(begin == std::string_view::npos)
+            break;
+
+        text.remove_prefix(begin);
+
+        auto token = text.substr(0, text.find_first_of(" \t"));
+        text.remove_prefix(token.size());
+
+        // +смещение:тип:значение
+        auto firstColon = token.find(':');
+        auto secondColon = firstColon == std::string_view::npos ? firstColon : token.find(':', firstColon + 1);
+
+        if(!token.starts_with('+') || secondColon == std::string_view::npos)
+            return std::unexpected{ValueError::InvalidFormat};
+
+        auto offsetText = token.substr(1, firstColon - 1);
+        int base = 10;
+
+        if(offsetText.starts_with("0x") || offsetText.starts_with("0X"))
+        {
+            offsetText.remove_prefix(2);
+            base = 16;
+        }
+
+        size_t offset = 0;
+
+        if(auto [ptr, ec] = std::from_chars(offsetText.data(), offsetText.data() + offsetText.size(), offset, base);
+        ec != std::errc{} || ptr != offsetText.data() + offsetText.size()) return std::unexpected{ValueError::InvalidFormat};
+
+        auto type = Value::typeFromName(token.substr(firstColon + 1, secondColon - firstColon - 1));
+
+        if(!type)
+            return std::unexpected{type.error()};
+
+        auto value = Value::parse(*type, token.substr(secondColon + 1));
+
+        if(!value)
+            return std::unexpected{value.error()};
+
+        fields.push_back({offset, std::move(*value)});
+    }
+
+    return create(std::move(fields));
+}
+
+std::expected<GroupPattern, ValueError> GroupPattern::create(std::vector<GroupField> fields)
+{
+    if(fields.empty())
+        return std::unexpected{ValueError::InvalidFormat};
+
+    return GroupPattern(std::move(fields));
+}
+
+GroupPattern::GroupPattern(std::vector<GroupField> fields)
+{
+    // сортируются индексы, а не сами поля: перестановка Value с variant внутри
+    // дороже и сбивает анализ инициализации у GCC
+    std::vector<size_t> scores(fields.size());
+    std::vector<size_t> order(fields.size());
+
+    for(size_t i = 0; i < fields.size(); ++i)
+    {
+        scores[i] = selectivity(fields[i].value);
+        order[i] = i;
+    }
+
+    std::ranges::stable_sort(order, std::greater{}, [&](size_t i) { return scores[i]; });
+
+    ordered.reserve(fields.size());
+
+    for(size_t i : order)
+        ordered.push_back(std::move(fields[i]));
+
+    for(const auto& field : ordered)
+        span = std::max(span, field.offset + field.value.size());
+}
+
+size_t GroupPattern::size() const noexcept
+{
+    return span;
+}
+
+const GroupField& GroupPattern::anchor() const noexcept
+{
+    return ordered.front();
+}
+
+const std::vector<GroupField>& GroupPattern::fields() const noexcept
+{
+    return ordered;
+}
+
+bool GroupPattern::match(std::span<const std::byte> memory, double epsilon) const
+{
+    const auto& first = ordered.front();
+
+    return first.value.match(memory.subspan(first.offset, first.value.size()), epsilon) && matchRest(memory, epsilon);
+}
+
+bool GroupPattern::matchRest(std::span<const std::byte> memory, double epsilon) const
+{
+    for(size_t i = 1; i < ordered.size(); ++i)
+    {
+        const auto& field = ordered[i];
+
+        if(!field.value.match(memory.subspan(field.offset, field.value.size()), epsilon))
+            return false;
+    }
+    return true;
+}
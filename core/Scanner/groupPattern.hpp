@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "value.hpp"
+
+/**
+ * @brief Поле шаблона структуры: значение по смещению от начала структуры
+ */
+struct GroupField
+{
+    size_t offset = 0;
+    Value value;
+};
+
+/**
+ * @brief Шаблон структуры из нескольких типизированных полей
+ *
+ * Поля хранятся в порядке проверки: первым идёт самое избирательное (якорь),
+ * его ищет сканер, остальные проверяются в том же буфере.
+ * Совпадением считается адрес начала структуры, байты результата -- вся структура
+ */
+class GroupPattern
+{
+public:
+    /**
+     * @brief Разбирает шаблон вида "+0:f32:100 +8:i32:30"
+     *
+     * Поле -- "+смещение:тип:значение", смещение десятичное или с 0x,
+     * типы как в Value::typeFromName
+     *
+     * @param text поля через пробел
+     * @return std::expected<GroupPattern, ValueError> шаблон
+     * @retval ValueError::InvalidFormat если поле записано неверно или полей нет
+     * @retval ValueError::InvalidType если тип поля не известен
+     */
+    static std::expected<GroupPattern, ValueError> parse(std::string_view text);
+
+    /**
+     * @brief Создаёт шаблон из готовых полей
+     *
+     * @retval ValueError::InvalidFormat если полей нет
+     */
+    static std::expected<GroupPattern, ValueError> create(std::vector<GroupField> fields);
+
+    /// @brief Размер структуры: от начала до конца самого дальнего поля
+    [[nodiscard]] size_t size() const noexcept;
+
+    /// @brief Самое избирательное поле, по нему идёт поиск
+    [[nodiscard]] const GroupField& anchor() const noexcept;
+
+    /// @brief Поля в порядке проверки, anchor() первым
+    [[nodiscard]] const std::vector<GroupField>& fields() const noexcept;
+
+    /**
+     * @brief Проверяет все поля
+     *
+     * @param memory байты структуры, не меньше size()
+     * @param epsilon погрешность для float/double
+     */
+    [[nodiscard]] bool match(std::span<const std::byte> memory, double epsilon = 1e-6) const;
+
+    /// @brief Проверяет все поля, кроме якоря (он уже совпал)
+    [[nodiscard]] bool matchRest(std::span<const std::byte> memory, double epsilon = 1e-6) const;
+
+private:
+    explicit GroupPattern(std::vector<GroupField> fields);
+
+    std::vector<GroupField> ordered;
+    size_t span = 0;
+};
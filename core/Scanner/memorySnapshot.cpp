@@ -0,0 +1,268 @@
+#include "memorySnapshot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t pageSize = PageStore::pageSize;
+
+    /// @brief Одна и та же страница в двух снимках
+    struct PagePair
+    {
+        uintptr_t address;
+        PageStore::PageId older;
+        PageStore::PageId newer;
+    };
+
+    /// @brief Результаты сравнения одной пачки пар, пачки склеиваются по порядку
+    struct DiffBatch
+    {
+        std::vector<uintptr_t> pages{};
+        std::vector<uintptr_t> values{};
+    };
+
+    void comparePages(const PageStore& olderStore, const PageStore& newerStore, const PagePair& pair, size_t valueSize, DiffBatch& out)
+    {
+        alignas(8) std::array<std::byte, pageSize> before;
+        alignas(8) std::array<std::byte, pageSize> after;
+
+        // страница читалась только в одном из снимков -- изменилась, но значений не сравнить
+        bool hasBefore = olderStore.load(pair.older, before);
+        bool hasAfter = newerStore.load(pair.newer, after);
+
+        if(!hasBefore || !hasAfter)
+        {
+            if(hasBefore != hasAfter)
+                out.pages.push_back(pair.address);
+            return;
+        }
+
+        bool changed = false;
+
+        for(size_t offset = 0; offset < pageSize; offset += sizeof(uint64_t))
+        {
+            if(std::memcmp(before.data() + offset, after.data() + offset, sizeof(uint64_t)) == 0)
+                continue;
+
+            changed = true;
+
+            for(size_t k = 0; k < sizeof(uint64_t); k += valueSize)
+            {
+                if(std::memcmp(before.data() + offset + k, after.data() + offset + k, valueSize) != 0)
+                    out.values.push_back(pair.address + offset + k);
+            }
+        }
+
+        if(changed)
+            out.pages.push_back(pair.address);
+    }
+}
+
+MemorySnapshot::MemorySnapshot(std::shared_ptr<PageStore> store) noexcept : store(std::move(store)) {}
+
+MemorySnapshot::~MemorySnapshot()
+{
+    releasePages();
+}
+
+MemorySnapshot& MemorySnapshot::operator=(MemorySnapshot&& other) noexcept
+{
+    if(this != &other)
+    {
+        releasePages();
+        store = std::move(other.store);
+        regions = std::move(other.regions);
+    }
+    return *this;
+}
+
+void MemorySnapshot::releasePages() noexcept
+{
+    if(!store)
+        return;
+
+    for(const auto& region : regions)
+        store->release(region.pages);
+
+    regions.clear();
+}
+
+std::expected<MemorySnapshot, ScanError> MemorySnapshot::take
+(
+    const Memory& memory,
+    const std::vector<MemoryRegion>& regions,
+    std::shared_ptr<PageStore> store,
+    ThreadPool& pool,
+    size_t chunkSize
+)
+{
+    if(memory.getPid() <= 0)
+        return std::unexpected{ScanError::InvalidIdentifier};
+
+    MemorySnapshot snapshot(std::move(store));
+
+    struct Job
+    {
+        size_t region;
+        size_t firstPage;
+        size_t pages;
+    };
+
+    size_t chunkPages = std::max<size_t>(chunkSize / pageSize, 1);
+    std::vector<Job> jobs{};
+
+    for(const auto& reg : regions)
+    {
+        size_t pages = reg.size() / pageSize;
+
+        if(pages == 0) continue;
+
+        size_t index = snapshot.regions.size();
+        snapshot.regions.push_back({reg.start, std::vector<PageStore::PageId>(pages, PageStore::missingPage)});
+
+        for(size_t first = 0; first < pages; first += chunkPages)
+            jobs.push_back({index, first, std::min(chunkPages, pages - first)});
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> readPages{0};
+    size_t workerCount = std::min(pool.size(), std::max<size_t>(jobs.size(), 1));
+
+    TaskGroup group;
+
+    for(size_t w = 0; w < workerCount; ++w)
+    {
+        pool.submit([&]
+        {
+            std::vector<std::byte> buffer(chunkPages * pageSize);
+            size_t pagesDone = 0;
+
+            for(size_t i = next.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+                i = next.fetch_add(1, std::memory_order_relaxed))
+            {
+                const auto& job = jobs[i];
+                auto& ids = snapshot.regions[job.region].pages;
+                uintptr_t address = snapshot.regions[job.region].start + job.firstPage * pageSize;
+                size_t total = job.pages * pageSize;
+                size_t done = 0;
+
+                while(done < total)
+                {
+                    auto read = memory.readBlock(address + done, total - done, buffer.data() + done);
+                    size_t got = read ? *read - *read % pageSize : 0;
+
+                    for(size_t offset = done; offset < done + got; offset += pageSize)
+                    {
+                        ids[job.firstPage + offset / pageSize] =
+                            snapshot.store->intern(std::span<const std::byte, pageSize>(buffer.data() + offset, pageSize));
+                    }
+
+                    pagesDone += got / pageSize;
+                    done += got;
+
+                    // чтение остановилось на недоступной странице -- она пропускается
+                    if(done < total)
+                        done += pageSize;
+                }
+            }
+
+            readPages.fetch_add(pagesDone, std::memory_order_relaxed);
+        }, group);
+    }
+
+    pool.wait(group);
+
+    if(readPages.load() == 0)
+        return std::unexpected{ScanError::ReadError};
+
+    return snapshot;
+}
+
+SnapshotDiff MemorySnapshot::diff(const MemorySnapshot& newer, ThreadPool& pool, size_t valueSize) const
+{
+    valueSize = std::bit_floor(std::clamp<size_t>(valueSize, 1, sizeof(uint64_t)));
+
+    SnapshotDiff result{};
+    std::vector<PagePair> pairs{};
+
+    // в общем хранилище совпадающие идентификаторы -- одинаковые страницы, их не распаковываем
+    bool sharedStore = store == newer.store;
+    auto older = regions.begin();
+    auto later = newer.regions.begin();
+
+    while(older != regions.end() && later != newer.regions.end())
+    {
+        uintptr_t olderEnd = older->start + older->pages.size() * pageSize;
+        uintptr_t laterEnd = later->start + later->pages.size() * pageSize;
+        uintptr_t begin = std::max(older->start, later->start);
+        uintptr_t end = std::min(olderEnd, laterEnd);
+
+        for(uintptr_t address = begin; address < end; address += pageSize)
+        {
+            auto before = older->pages[(address - older->start) / pageSize];
+            auto after = later->pages[(address - later->start) / pageSize];
+
+            if(before != PageStore::missingPage && after != PageStore::missingPage)
+                ++result.comparedPages;
+
+            if(before != after || !sharedStore)
+                pairs.push_back({address, before, after});
+        }
+
+        if(olderEnd <= laterEnd)
+            ++older;
+        else
+            ++later;
+    }
+
+    constexpr size_t batchSize = 64;
+    size_t batchCount = (pairs.size() + batchSize - 1) / batchSize;
+
+    std::vector<DiffBatch> batches(batchCount);
+    std::atomic<size_t> next{0};
+    size_t workerCount = std::min(pool.size(), batchCount);
+
+    TaskGroup group;
+
+    for(size_t w = 0; w < workerCount; ++w)
+    {
+        pool.submit([&]
+        {
+            for(size_t b = next.fetch_add(1, std::memory_order_relaxed); b < batchCount;
+                b = next.fetch_add(1, std::memory_order_relaxed))
+            {
+                size_t last = std::min(pairs.size(), (b + 1) * batchSize);
+
+                for(size_t i = b * batchSize; i < last; ++i)
+                    comparePages(*store, *newer.store, pairs[i], valueSize, batches[b]);
+            }
+        }, group);
+    }
+
+    pool.wait(group);
+
+    for(auto& batch : batches)
+    {
+        result.pages.insert(result.pages.end(), batch.pages.begin(), batch.pages.end());
+        result.values.insert(result.values.end(), batch.values.begin(), batch.values.end());
+    }
+
+    return result;
+}
+
+size_t MemorySnapshot::pageCount() const noexcept
+{
+    size_t count = 0;
+
+    for(const auto& region : regions)
+        count += region.pages.size();
+
+    return count;
+}
+
+const PageStore& MemorySnapshot::getStore() const noexcept
+{
+    return *store;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <vector>
+
+#include "../Process/MemoryReader.hpp"
+#include "../Process/ModuleMapParser.hpp"
+#include "pageStore.hpp"
+#include "scanner.hpp"
+#include "threadPool.hpp"
+
+/**
+ * @brief Что изменилось между двумя снимками
+ *
+ * pages -- адреса изменившихся страниц по возрастанию, включая страницы,
+ * прочитанные только в одном из снимков.
+ * values -- адреса изменившихся выровненных значений по возрастанию
+ */
+struct SnapshotDiff
+{
+    std::vector<uintptr_t> pages{};
+    std::vector<uintptr_t> values{};
+    size_t comparedPages = 0; // страниц, которые есть в обоих снимках
+};
+
+/**
+ * @brief Постраничная копия регионов процесса в общем PageStore
+ *
+ * Снимок хранит только идентификаторы страниц, сами страницы -- сжатые
+ * и без повторов -- лежат в хранилище, общем для всех снимков процесса.
+ * Страница, не изменившаяся между снимками, получает тот же идентификатор,
+ * поэтому diff() сравнивает байты только там, где идентификаторы разные
+ */
+class MemorySnapshot
+{
+public:
+    /**
+     * @brief Читает регионы через Memory::readBlock и складывает страницы в хранилище
+     *
+     * Регионы режутся на блоки по chunkSize и читаются потоками пула.
+     * Страницы, которые не удалось прочитать, помечаются PageStore::missingPage
+     *
+     * @param memory память процесса
+     * @param regions регионы для снимка, начала выровнены на страницу
+     * @param store хранилище страниц, общее для сравниваемых снимков
+     * @param pool пул потоков
+     * @return std::expected<MemorySnapshot, ScanError> снимок
+     * @retval ScanError::InvalidIdentifier если pid не задан
+     * @retval ScanError::ReadError если не прочиталось ни одной страницы
+     */
+    [[nodiscard]] static std::expected<MemorySnapshot, ScanError> take
+    (
+        const Memory& memory,
+        const std::vector<MemoryRegion>& regions,
+        std::shared_ptr<PageStore> store,
+        ThreadPool& pool,
+        size_t chunkSize = 1024 * 1024
+    );
+
+    ~MemorySnapshot();
+
+    MemorySnapshot(const MemorySnapshot&) = delete;
+    MemorySnapshot& operator=(const MemorySnapshot&) = delete;
+
+    MemorySnapshot(MemorySnapshot&& other) noexcept = default;
+    MemorySnapshot& operator=(MemorySnapshot&& other) noexcept;
+
+    /**
+     * @brief Параллельно сравнивает снимок с более новым
+     *
+     * Сравниваются пересечения регионов обоих снимков. Если снимки лежат
+     * в разных хранилищах, распаковывается и сравнивается каждая страница
+     *
+     * @param newer снимок, сделанный позже
+     * @param pool пул потоков
+     * @param valueSize размер и выравнивание значений: 1, 2, 4 или 8
+     * @return SnapshotDiff изменившиеся страницы и значения
+     */
+    [[nodiscard]] SnapshotDiff diff(const MemorySnapshot& newer, ThreadPool& pool, size_t valueSize = 4) const;
+
+    /// @brief Сколько страниц в снимке
+    [[nodiscard]] size_t pageCount() const noexcept;
+
+    [[nodiscard]] const PageStore& getStore() const noexcept;
+
+private:
+    struct Region
+    {
+        uintptr_t start = 0;
+        std::vector<PageStore::PageId> pages{};
+    };
+
+    explicit MemorySnapshot(std::shared_ptr<PageStore> store) noexcept;
+
+    void releasePages() noexcept;
+
+    std::shared_ptr<PageStore> store{};
+    std::vector<Region> regions{};
+};
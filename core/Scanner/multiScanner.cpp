@@ -0,0 +1,228 @@
+#include "multiScanner.hpp"
+#include "resultSink.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <optional>
+
+double MultiScanReport::bytesPerSecond() const noexcept
+{
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+
+    return seconds > 0.0 ? static_cast<double>(totalBytes) / seconds : 0.0;
+}
+
+MultiScanner::MultiScanner(ThreadPool& pool, const Scanner& scanner, size_t chunkSize) noexcept
+    : pool(pool), scanner(scanner), chunkSize(chunkSize == 0 ? 1 : chunkSize) {}
+
+std::vector<ScanTarget> MultiScanner::buildTargets
+(
+    const std::vector<ProcessInfo>& processes,
+    const IModuleMapParser& parser,
+    const IModuleFilter& filter,
+    const ModuleFilterConfig& config
+)
+{
+    std::vector<ScanTarget> targets{};
+    targets.reserve(processes.size());
+
+    for(const auto& proc : processes)
+    {
+        auto parsed = parser.parse(proc.pid);
+        if(!parsed) continue;
+
+        auto filtered = filter.filter(*parsed, config);
+        if(!filtered) continue;
+
+        targets.push_back({proc.pid, std::move(*filtered)});
+    }
+
+    return targets;
+}
+
+/**
+ * @brief Режет регионы всех целей на блоки и чередует их по процессам
+ *
+ * Очередь каждого процесса идёт в порядке адресов, а общий список собирается
+ * по кругу: на каждом шаге берётся по одному блоку от каждого процесса.
+ * Так большой процесс не задерживает старт сканирования маленьких.
+ *
+ * @param targets цели сканирования
+ * @return std::vector<Job> чередующийся список блоков
+ */
+std::vector<MultiScanner::Job> MultiScanner::scheduleJobs(const std::vector<ScanTarget>& targets) const
+{
+    std::vector<std::vector<Job>> perTarget(targets.size());
+    size_t total = 0;
+
+    // под ограничителем блоки мельче, чтобы нагрузка на цель шла ровно
+    size_t jobSize = throttle ? std::min(chunkSize, ScanThrottle::burstBytes) : chunkSize;
+
+    for(size_t t = 0; t < targets.size(); ++t)
+    {
+        for(const auto& reg : targets[t].regions)
+        {
+            for(size_t offset = 0; offset < reg.size(); offset += jobSize)
+                perTarget[t].push_back({t, reg.start + offset, std::min(jobSize, reg.size() - offset), reg.end});
+        }
+        total += perTarget[t].size();
+    }
+
+    std::vector<Job> jobs{};
+    jobs.reserve(total);
+
+    for(size_t round = 0; jobs.size() < total; ++round)
+    {
+        for(const auto& queue : perTarget)
+        {
+            if(round < queue.size())
+                jobs.push_back(queue[round]);
+        }
+    }
+
+    return jobs;
+}
+
+std::expected<MultiScanReport, ScanError> MultiScanner::scan(const std::vector<ScanTarget>& targets, const Value& value)
+{
+    if(targets.empty())
+        return std::unexpected{ScanError::InvalidIdentifier};
+
+    auto begin = std::chrono::steady_clock::now();
+
+    auto jobs = scheduleJobs(targets);
+
+    size_t workerCount = std::min(pool.size(), std::max<size_t>(jobs.size(), 1));
+
+    // по приёмнику на процесс: потоки не делят ни списков, ни блокировок,
+    // а блоки одного процесса поток берёт по возрастанию адресов
+    std::deque<ResultSink> sinks{};
+
+    for(size_t t = 0; t < targets.size(); ++t)
+        sinks.emplace_back(value.size());
+
+    std::vector<size_t> found(jobs.size(), 0);
+    std::vector<size_t> readBytes(jobs.size(), 0);
+    std::vector<uint8_t> failed(jobs.size(), 0);
+
+    std::atomic<size_t> next{0};
+
+    TaskGroup group;
+
+    for(size_t w = 0; w < workerCount; ++w)
+    {
+        pool.submit([&]
+        {
+            // писатель в приёмник процесса создаётся при первом его блоке
+            std::vector<std::optional<ResultSink::Producer>> producers(targets.size());
+
+            // поток пула возвращается на свои процессоры после этой задачи
+            std::optional<CpuPin> pinned{};
+
+            if(throttle)
+                pinned.emplace(throttle->pin());
+
+            // блок дочитывается на value.size() - 1 байт, чтобы не терять значения на границе блоков
+            size_t overlap = value.size() - 1;
+            std::vector<std::byte> buffer(chunkSize + overlap);
+
+            for(size_t i = next.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+                i = next.fetch_add(1, std::memory_order_relaxed))
+            {
+                const auto& job = jobs[i];
+                Memory memory(targets[job.target].pid);
+                size_t want = std::min(job.size + overlap, job.limit - job.address);
+
+                if(throttle)
+                    throttle->acquire(want);
+
+                auto read = memory.readBlock(job.address, want, buffer.data());
+
+                if(!read)
+                {
+                    failed[i] = 1;
+                    continue;
+                }
+
+                readBytes[i] = std::min(*read, job.size);
+
+                auto& producer = producers[job.target];
+
+                if(!producer)
+                    producer.emplace(sinks[job.target].producer());
+
+                scanner.findMatches(value, job.address, std::span<const std::byte>(buffer).first(*read),
+                [&](uintptr_t addr, auto bytes)
+                {
+                    // совпадения, начинающиеся в дочитанном хвосте, найдёт следующий блок
+                    if(addr < job.address + job.size)
+                    {
+                        producer->add(addr, bytes);
+                        found[i]++;
+                    }
+                });
+            }
+        }, group);
+    }
+
+    pool.wait(group);
+
+    MultiScanReport report{};
+    report.targets.resize(targets.size());
+
+    for(size_t t = 0; t < targets.size(); ++t)
+    {
+        report.targets[t].pid = targets[t].pid;
+        report.sinkBytes += sinks[t].reservedBytes();
+
+        auto [it, inserted] = sessions.try_emplace(targets[t].pid, value, Memory(targets[t].pid));
+        it->second.clear();
+
+        sinks[t].drainInto(it->second);
+    }
+
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+        auto& stats = report.targets[jobs[i].target];
+
+        stats.chunks++;
+        stats.readErrors += failed[i];
+        stats.bytesRead += readBytes[i];
+        stats.hits += found[i];
+    }
+
+    for(const auto& stats : report.targets)
+    {
+        report.totalBytes += stats.bytesRead;
+        report.totalHits += stats.hits;
+    }
+
+    report.elapsed = std::chrono::steady_clock::now() - begin;
+
+    if(report.totalBytes == 0 && !jobs.empty())
+        return std::unexpected{ScanError::ReadError};
+
+    return report;
+}
+
+void MultiScanner::setThrottle(ScanThrottle* throttle) noexcept
+{
+    this->throttle = throttle;
+}
+
+ScanSessions* MultiScanner::session(pid_t pid) noexcept
+{
+    auto it = sessions.find(pid);
+
+    return it == sessions.end() ? nullptr : &it->second;
+}
+
+const std::map<pid_t, ScanSessions>& MultiScanner::getSessions() const noexcept
+{
+    return sessions;
+}
+
+void MultiScanner::clear() noexcept
+{
+    sessions.clear();
+}
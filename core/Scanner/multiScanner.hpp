@@ -0,0 +1,136 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <vector>
+#include <sys/types.h>
+
+#include "../Process/ModuleFilter.hpp"
+#include "../Process/ModuleMapParser.hpp"
+#include "../Process/ProcessFinder.hpp"
+#include "scanner.hpp"
+#include "scanSession.hpp"
+#include "scanThrottle.hpp"
+#include "threadPool.hpp"
+#include "value.hpp"
+
+/**
+ * @brief Процесс-цель для сканирования и его отфильтрованные регионы
+ */
+struct ScanTarget
+{
+    pid_t pid = 0;
+    std::vector<MemoryRegion> regions{};
+};
+
+/**
+ * @brief Статистика сканирования одного процесса
+ *
+ * bytesRead -- сколько байт реально прочитано
+ * chunks -- сколько блоков было обработано
+ * readErrors -- сколько блоков не удалось прочитать (регион исчез, процесс завершился)
+ * hits -- сколько совпадений найдено
+ */
+struct TargetStats
+{
+    pid_t pid = 0;
+    size_t bytesRead = 0;
+    size_t chunks = 0;
+    size_t readErrors = 0;
+    size_t hits = 0;
+};
+
+/**
+ * @brief Общий отчёт мульти-сканирования
+ */
+struct MultiScanReport
+{
+    std::vector<TargetStats> targets{};
+    size_t totalBytes = 0;
+    size_t totalHits = 0;
+    size_t sinkBytes = 0; // сколько байт заняли сегменты приёмников результатов до слияния в сессии
+    std::chrono::nanoseconds elapsed{};
+
+    /// @brief Суммарная пропускная способность по всем процессам, байт/сек
+    [[nodiscard]] double bytesPerSecond() const noexcept;
+};
+
+/**
+ * @brief Сканирует одно значение сразу в нескольких процессах
+ *
+ * Регионы всех процессов режутся на блоки по chunkSize и перемешиваются
+ * по кругу (pid1, pid2, ..., pid1, ...), чтобы общий пул потоков обслуживал
+ * процессы равномерно. Потоки пишут найденное в ResultSink своего процесса без
+ * общих блокировок, после сканирования сегменты сливаются в отдельную ScanSessions
+ * на каждый pid в порядке возрастания адресов.
+ */
+class MultiScanner
+{
+public:
+    MultiScanner(ThreadPool& pool, const Scanner& scanner, size_t chunkSize = 16 * 1024 * 1024) noexcept;
+
+    /**
+     * @brief Строит цели сканирования по списку процессов
+     *
+     * Процессы, у которых не удалось прочитать или отфильтровать maps, пропускаются
+     *
+     * @param processes процессы, например из ProcessFinder
+     * @param parser парсер /proc/pid/maps
+     * @param filter фильтр регионов
+     * @param config конфигурация фильтра
+     * @return std::vector<ScanTarget> цели с непустым набором регионов
+     */
+    [[nodiscard]] static std::vector<ScanTarget> buildTargets
+    (
+        const std::vector<ProcessInfo>& processes,
+        const IModuleMapParser& parser,
+        const IModuleFilter& filter,
+        const ModuleFilterConfig& config
+    );
+
+    /**
+     * @brief Первое сканирование всех целей
+     *
+     * Предыдущие результаты по этим pid сбрасываются
+     *
+     * @param targets процессы и их регионы
+     * @param value искомое значение
+     * @return std::expected<MultiScanReport, ScanError> отчёт о сканировании
+     * @retval ScanError::InvalidIdentifier если список целей пуст
+     * @retval ScanError::ReadError если не удалось прочитать ни одного блока
+     */
+    [[nodiscard]] std::expected<MultiScanReport, ScanError> scan(const std::vector<ScanTarget>& targets, const Value& value);
+
+    /**
+     * @brief Ограничитель скорости для всех потоков сканирования
+     *
+     * @param throttle живёт дольше сканера; nullptr -- без ограничения
+     */
+    void setThrottle(ScanThrottle* throttle) noexcept;
+
+    /// @brief Результаты конкретного процесса или nullptr, если он не сканировался
+    [[nodiscard]] ScanSessions* session(pid_t pid) noexcept;
+
+    [[nodiscard]] const std::map<pid_t, ScanSessions>& getSessions() const noexcept;
+
+    void clear() noexcept;
+
+private:
+    /// @brief Единица работы: один блок одного региона одного процесса, limit -- конец региона
+    struct Job
+    {
+        size_t target;
+        uintptr_t address;
+        size_t size;
+        uintptr_t limit;
+    };
+
+    [[nodiscard]] std::vector<Job> scheduleJobs(const std::vector<ScanTarget>& targets) const;
+
+    ThreadPool& pool;
+    const Scanner& scanner;
+    size_t chunkSize;
+    ScanThrottle* throttle = nullptr;
+    std::map<pid_t, ScanSessions> sessions{};
+};
@@ -0,0 +1,332 @@
+#include "pageStore.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t pageSize = PageStore::pageSize;
+
+    // первый байт сжатой страницы
+    constexpr std::byte rawTag{0};
+    constexpr std::byte lzTag{1};
+
+    uint32_t load32(const std::byte* p) noexcept
+    {
+        uint32_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    uint64_t load64(const std::byte* p) noexcept
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    bool isZero(std::span<const std::byte, pageSize> page) noexcept
+    {
+        uint64_t bits = 0;
+
+        for(size_t i = 0; i < pageSize; i += sizeof(uint64_t))
+            bits |= load64(page.data() + i);
+
+        return bits == 0;
+    }
+
+    /// @brief 64-битный хеш страницы: четыре независимые полосы, чтобы не ждать умножений
+    uint64_t hashPage(std::span<const std::byte, pageSize> page) noexcept
+    {
+        constexpr uint64_t prime = 0x9E3779B97F4A7C15ull;
+        uint64_t lanes[4] = {prime, prime << 1, prime << 2, prime << 3};
+
+        for(size_t i = 0; i < pageSize; i += 4 * sizeof(uint64_t))
+        {
+            for(size_t l = 0; l < 4; ++l)
+                lanes[l] = std::rotl((lanes[l] ^ load64(page.data() + i + l * sizeof(uint64_t))) * prime, 31);
+        }
+
+        uint64_t h = lanes[0] ^ std::rotl(lanes[1], 7) ^ std::rotl(lanes[2], 13) ^ std::rotl(lanes[3], 19);
+
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+    void put16(std::vector<std::byte>& out, size_t value)
+    {
+        out.push_back(static_cast<std::byte>(value & 0xff));
+        out.push_back(static_cast<std::byte>(value >> 8));
+    }
+
+    size_t get16(const std::byte* p) noexcept
+    {
+        return static_cast<size_t>(p[0]) | static_cast<size_t>(p[1]) << 8;
+    }
+
+    /**
+     * @brief Сжимает страницу
+     *
+     * Последовательности вида [длина литералов][литералы][длина совпадения][смещение назад],
+     * поля по 2 байта, последняя последовательность -- только литералы.
+     * Совпадения ищутся по хеш-таблице 4-байтовых слов, длинные серии одинаковых байт
+     * сворачиваются перекрывающимся совпадением со смещением 1.
+     * Если сжатие не выигрывает, страница хранится как есть
+     */
+    std::vector<std::byte> compress(std::span<const std::byte, pageSize> page)
+    {
+        constexpr size_t tableBits = 12;
+        constexpr uint16_t empty = UINT16_MAX;
+
+        std::array<uint16_t, size_t{1} << tableBits> table;
+        table.fill(empty);
+
+        std::vector<std::byte> out{};
+        out.reserve(pageSize / 2);
+        out.push_back(lzTag);
+
+        const std::byte* p = page.data();
+        size_t anchor = 0;
+        size_t i = 0;
+        size_t misses = 0;
+
+        auto storeRaw = [&]
+        {
+            out.assign(1, rawTag);
+            out.insert(out.end(), page.begin(), page.end());
+            return std::move(out);
+        };
+
+        while(i + 4 <= pageSize)
+        {
+            uint32_t word = load32(p + i);
+            size_t h = (word * 2654435761u) >> (32 - tableBits);
+            size_t candidate = table[h];
+            table[h] = static_cast<uint16_t>(i);
+
+            if(candidate == empty || load32(p + candidate) != word)
+            {
+                // на несжимаемых данных шаг растёт, как в LZ4
+                i += 1 + (misses++ >> 5);
+                continue;
+            }
+
+            size_t length = 4;
+
+            while(i + length < pageSize && p[candidate + length] == p[i + length])
+                ++length;
+
+            put16(out, i - anchor);
+            out.insert(out.end(), p + anchor, p + i);
+            put16(out, length);
+            put16(out, i - candidate);
+
+            i += length;
+            anchor = i;
+            misses = 0;
+
+            if(out.size() >= pageSize)
+                return storeRaw();
+        }
+
+        put16(out, pageSize - anchor);
+        out.insert(out.end(), p + anchor, p + pageSize);
+
+        if(out.size() > pageSize)
+            return storeRaw();
+
+        out.shrink_to_fit();
+        return out;
+    }
+
+    void decompress(std::span<const std::byte> packed, std::span<std::byte, pageSize> out) noexcept
+    {
+        if(packed.front() == rawTag)
+        {
+            std::memcpy(out.data(), packed.data() + 1, pageSize);
+            return;
+        }
+
+        const std::byte* in = packed.data() + 1;
+        const std::byte* end = packed.data() + packed.size();
+        std::byte* o = out.data();
+
+        while(true)
+        {
+            size_t literals = get16(in);
+            in += 2;
+
+            std::memcpy(o, in, literals);
+            in += literals;
+            o += literals;
+
+            if(in == end)
+                break;
+
+            size_t length = get16(in);
+            size_t offset = get16(in + 2);
+            in += 4;
+
+            const std::byte* from = o - offset;
+
+            if(offset >= length)
+            {
+                std::memcpy(o, from, length);
+                o += length;
+            }
+            else
+            {
+                // перекрывающееся совпадение -- серия, копируется побайтово
+                for(size_t k = 0; k < length; ++k)
+                    *o++ = from[k];
+            }
+        }
+    }
+
+    bool samePage(std::span<const std::byte> packed, std::span<const std::byte, pageSize> page)
+    {
+        std::array<std::byte, pageSize> unpacked;
+        decompress(packed, unpacked);
+
+        return std::memcmp(unpacked.data(), page.data(), pageSize) == 0;
+    }
+}
+
+PageStore::PageId PageStore::intern(std::span<const std::byte, pageSize> page)
+{
+    if(isZero(page))
+        return zeroPage;
+
+    uint64_t hash = hashPage(page);
+    size_t shardIndex = hash & (shardCount - 1);
+    Shard& shard = shards[shardIndex];
+
+    auto makeId = [&](uint32_t slot) { return static_cast<PageId>(((slot << shardBits) | shardIndex) + 1); };
+
+    {
+        std::lock_guard lock(shard.mutex);
+
+        // совпадение хеша проверяется сравнением содержимого
+        auto [first, last] = shard.byHash.equal_range(hash);
+
+        for(auto it = first; it != last; ++it)
+        {
+            Slot& slot = shard.slots[it->second];
+
+            if(samePage(slot.packed, page))
+            {
+                ++slot.refs;
+                return makeId(it->second);
+            }
+        }
+    }
+
+    // сжатие -- вне блокировки
+    auto packed = compress(page);
+
+    std::lock_guard lock(shard.mutex);
+
+    uint32_t index = 0;
+
+    if(!shard.freeSlots.empty())
+    {
+        index = shard.freeSlots.back();
+        shard.freeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(shard.slots.size());
+        shard.slots.emplace_back();
+    }
+
+    shard.storedBytes += packed.size();
+    shard.slots[index] = {std::move(packed), hash, 1};
+    shard.byHash.emplace(hash, index);
+
+    // пока шла упаковка, другой поток мог положить такую же страницу -- это
+    // лишь потеря дедупликации для одной копии, содержимое корректно в обеих
+    return makeId(index);
+}
+
+bool PageStore::load(PageId id, std::span<std::byte, pageSize> out) const
+{
+    if(id == missingPage)
+        return false;
+
+    if(id == zeroPage)
+    {
+        std::ranges::fill(out, std::byte{0});
+        return true;
+    }
+
+    size_t key = id - 1;
+    const Shard& shard = shards[key & (shardCount - 1)];
+
+    std::lock_guard lock(shard.mutex);
+    decompress(shard.slots[key >> shardBits].packed, out);
+
+    return true;
+}
+
+void PageStore::release(std::span<const PageId> ids)
+{
+    for(PageId id : ids)
+    {
+        if(id == zeroPage || id == missingPage)
+            continue;
+
+        size_t key = id - 1;
+        Shard& shard = shards[key & (shardCount - 1)];
+        uint32_t index = static_cast<uint32_t>(key >> shardBits);
+
+        std::lock_guard lock(shard.mutex);
+        Slot& slot = shard.slots[index];
+
+        if(--slot.refs != 0)
+            continue;
+
+        auto [first, last] = shard.byHash.equal_range(slot.hash);
+
+        for(auto it = first; it != last; ++it)
+        {
+            if(it->second == index)
+            {
+                shard.byHash.erase(it);
+                break;
+            }
+        }
+
+        shard.storedBytes -= slot.packed.size();
+        slot.packed = {};
+        shard.freeSlots.push_back(index);
+    }
+}
+
+size_t PageStore::uniquePages() const
+{
+    size_t count = 0;
+
+    for(const auto& shard : shards)
+    {
+        std::lock_guard lock(shard.mutex);
+        count += shard.byHash.size();
+    }
+    return count;
+}
+
+size_t PageStore::storedBytes() const
+{
+    size_t bytes = 0;
+
+    for(const auto& shard : shards)
+    {
+        std::lock_guard lock(shard.mutex);
+        bytes += shard.storedBytes;
+    }
+    return bytes;
+}
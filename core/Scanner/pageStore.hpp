@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Хранилище сжатых страниц памяти с дедупликацией по хешу
+ *
+ * Страница -- ровно pageSize байт. Нулевые страницы не хранятся вовсе,
+ * остальные сжимаются LZ77-кодеком (совпадения по 4 байта, окно -- сама страница),
+ * одинаковые страницы хранятся один раз. У каждой страницы счётчик ссылок:
+ * снимки берут страницы через intern() и отдают через release().
+ *
+ * Страницы разложены по шардам с отдельными мьютексами, так что intern() и load()
+ * можно вызывать из многих потоков одновременно
+ */
+class PageStore
+{
+public:
+    using PageId = uint32_t;
+
+    static constexpr size_t pageSize = 4096;
+    static constexpr PageId zeroPage = 0; // страница из нулей, памяти не занимает
+    static constexpr PageId missingPage = UINT32_MAX; // страницу не удалось прочитать
+
+    PageStore() = default;
+
+    PageStore(const PageStore&) = delete;
+    PageStore& operator=(const PageStore&) = delete;
+
+    /**
+     * @brief Кладёт страницу в хранилище или увеличивает счётчик ссылок уже лежащей
+     *
+     * @param page содержимое страницы
+     * @return PageId идентификатор; у одинаковых страниц он одинаковый
+     */
+    [[nodiscard]] PageId intern(std::span<const std::byte, pageSize> page);
+
+    /**
+     * @brief Распаковывает страницу
+     *
+     * @param id идентификатор от intern(), zeroPage даёт нули
+     * @param out куда распаковать
+     * @return bool false для missingPage
+     */
+    bool load(PageId id, std::span<std::byte, pageSize> out) const;
+
+    /// @brief Отдаёт ссылки на страницы, страница без ссылок освобождается
+    void release(std::span<const PageId> ids);
+
+    /// @brief Сколько разных ненулевых страниц лежит сейчас
+    [[nodiscard]] size_t uniquePages() const;
+
+    /// @brief Сколько байт занимают сжатые страницы
+    [[nodiscard]] size_t storedBytes() const;
+
+private:
+    static constexpr size_t shardBits = 6;
+    static constexpr size_t shardCount = size_t{1} << shardBits;
+
+    struct Slot
+    {
+        std::vector<std::byte> packed{};
+        uint64_t hash = 0;
+        uint32_t refs = 0;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex{};
+        std::vector<Slot> slots{};
+        std::vector<uint32_t> freeSlots{};
+        std::unordered_multimap<uint64_t, uint32_t> byHash{};
+        size_t storedBytes = 0;
+    };
+
+    std::array<Shard, shardCount> shards{};
+};
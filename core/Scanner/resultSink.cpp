@@ -0,0 +1,174 @@
+#include "resultSink.hpp"
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+ResultSink::Producer::Producer(ResultSink& sink, uint32_t id) noexcept : sink(&sink), id(id) {}
+
+ResultSink::Producer::Producer(Producer&& other) noexcept
+    : sink(other.sink), id(other.id), sequence(other.sequence), current(std::exchange(other.current, nullptr)) {}
+
+ResultSink::Producer::~Producer()
+{
+    publish();
+}
+
+void ResultSink::Producer::add(uintptr_t address, std::span<const std::byte> value)
+{
+    if(current && current->count == sink->segmentResults)
+        publish();
+
+    if(!current)
+    {
+        current = sink->acquire();
+        current->producer = id;
+        current->sequence = sequence++;
+    }
+
+    size_t index = current->count++;
+    size_t bytes = std::min(value.size(), sink->valueSize);
+
+    current->addresses[index] = address;
+    std::copy_n(value.begin(), bytes, current->values.get() + index * sink->valueSize);
+    std::fill_n(current->values.get() + index * sink->valueSize + bytes, sink->valueSize - bytes, std::byte{0});
+}
+
+void ResultSink::Producer::publish() noexcept
+{
+    // пустой сегмент тоже публикуется: вернуть его в пул во время сканирования
+    // значило бы класть в стек, из которого другие потоки сейчас берут
+    if(current)
+        push(sink->published, std::exchange(current, nullptr));
+}
+
+ResultSink::ResultSink(size_t valueSize, size_t segmentResults)
+    : valueSize(valueSize), segmentResults(segmentResults == 0 ? 1 : segmentResults) {}
+
+ResultSink::~ResultSink()
+{
+    for(auto* head : {published.exchange(nullptr), freeList.exchange(nullptr)})
+    {
+        while(head)
+            delete std::exchange(head, head->next.load(std::memory_order_relaxed));
+    }
+}
+
+ResultSink::Producer ResultSink::producer() noexcept
+{
+    return Producer(*this, producers.fetch_add(1, std::memory_order_relaxed));
+}
+
+void ResultSink::push(std::atomic<Segment*>& head, Segment* segment) noexcept
+{
+    Segment* top = head.load(std::memory_order_relaxed);
+
+    do
+    {
+        segment->next.store(top, std::memory_order_release);
+    }
+    while(!head.compare_exchange_weak(top, segment, std::memory_order_release, std::memory_order_relaxed));
+}
+
+ResultSink::Segment* ResultSink::acquire()
+{
+    Segment* segment = freeList.load(std::memory_order_acquire);
+
+    while(segment && !freeList.compare_exchange_weak(segment, segment->next.load(std::memory_order_acquire),
+                                                     std::memory_order_acquire, std::memory_order_acquire)) {}
+
+    if(segment)
+    {
+        segment->next.store(nullptr, std::memory_order_relaxed);
+        segment->count = 0;
+        return segment;
+    }
+
+    segment = new Segment{};
+    segment->addresses = std::make_unique_for_overwrite<uintptr_t[]>(segmentResults);
+    segment->values = std::make_unique_for_overwrite<std::byte[]>(segmentResults * valueSize);
+
+    segments.fetch_add(1, std::memory_order_relaxed);
+
+    return segment;
+}
+
+size_t ResultSink::drainInto(ScanSessions& session)
+{
+    std::vector<Segment*> list{};
+    size_t total = 0;
+
+    for(Segment* head = published.exchange(nullptr, std::memory_order_acquire); head; head = head->next.load(std::memory_order_acquire))
+    {
+        list.push_back(head);
+        total += head->count;
+    }
+
+    // цепочка каждого Producer -- его сегменты по порядку, адреса в ней уже возрастают
+    std::ranges::sort(list, {}, [](const Segment* segment) { return std::pair(segment->producer, segment->sequence); });
+
+    /// @brief Позиция чтения в цепочке: сегмент list[segment], элемент index, цепочка кончается перед list[end]
+    struct Cursor
+    {
+        uintptr_t address;
+        size_t segment;
+        size_t index;
+        size_t end;
+    };
+
+    auto later = [](const Cursor& a, const Cursor& b) { return a.address > b.address; };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heads(later);
+
+    // первый непустой элемент цепочки, начиная с сегмента from
+    auto start = [&](size_t from, size_t end)
+    {
+        while(from < end && list[from]->count == 0)
+            ++from;
+
+        if(from < end)
+            heads.push({list[from]->addresses[0], from, 0, end});
+    };
+
+    for(size_t first = 0; first < list.size();)
+    {
+        size_t end = first;
+
+        while(end < list.size() && list[end]->producer == list[first]->producer)
+            ++end;
+
+        start(first, end);
+        first = end;
+    }
+
+    session.reserve(session.size() + total);
+
+    while(!heads.empty())
+    {
+        Cursor cursor = heads.top();
+        heads.pop();
+
+        const Segment* segment = list[cursor.segment];
+        session.add(cursor.address, std::span<const std::byte>(segment->values.get() + cursor.index * valueSize, valueSize));
+
+        if(++cursor.index < segment->count)
+        {
+            cursor.address = segment->addresses[cursor.index];
+            heads.push(cursor);
+        }
+        else
+        {
+            start(cursor.segment + 1, cursor.end);
+        }
+    }
+
+    // все Producer уже разрушены, так что пул сейчас никто не читает
+    for(Segment* segment : list)
+        push(freeList, segment);
+
+    return total;
+}
+
+size_t ResultSink::reservedBytes() const noexcept
+{
+    return segments.load(std::memory_order_relaxed) * segmentResults * (sizeof(uintptr_t) + valueSize);
+}
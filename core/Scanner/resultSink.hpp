@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include "scanSession.hpp"
+
+/**
+ * @brief Приёмник результатов от нескольких потоков без общей блокировки
+ *
+ * Каждый поток пишет через свой Producer в собственный сегмент фиксированного размера:
+ * адреса и байты значений лежат в сегменте подряд, вставка -- запись в конец массива.
+ * Заполненный сегмент публикуется одним CAS в общий стек, новый берётся из пула
+ * свободных сегментов тоже CAS'ом, и только если пул пуст -- выделяется.
+ * Потоки делят лишь эти две вершины стеков, раз в segmentResults вставок.
+ *
+ * Внутри одного Producer адреса должны идти по возрастанию (так и есть, если поток
+ * берёт блоки одного процесса по порядку). drainInto() сливает цепочки всех
+ * Producer k-путевым слиянием в ScanSessions, так что результаты доступны
+ * через обычный getData() в порядке адресов
+ */
+class ResultSink
+{
+    struct Segment;
+
+public:
+    /**
+     * @brief Запись результатов одного потока
+     *
+     * Не потокобезопасен: один Producer -- один поток. Последний неполный сегмент
+     * публикуется в деструкторе
+     */
+    class Producer
+    {
+    public:
+        ~Producer();
+
+        Producer(const Producer&) = delete;
+        Producer& operator=(const Producer&) = delete;
+
+        Producer(Producer&& other) noexcept;
+        Producer& operator=(Producer&&) = delete;
+
+        /**
+         * @brief Добавляет результат
+         *
+         * @param address адрес, не меньше предыдущего у этого Producer
+         * @param value байты значения, берутся первые valueSize
+         */
+        void add(uintptr_t address, std::span<const std::byte> value);
+
+    private:
+        friend class ResultSink;
+
+        Producer(ResultSink& sink, uint32_t id) noexcept;
+
+        /// @brief Отдаёт текущий сегмент в стек опубликованных
+        void publish() noexcept;
+
+        ResultSink* sink;
+        uint32_t id;
+        uint32_t sequence = 0;
+        Segment* current = nullptr;
+    };
+
+    /**
+     * @param valueSize размер значения каждого результата
+     * @param segmentResults сколько результатов в одном сегменте
+     */
+    explicit ResultSink(size_t valueSize, size_t segmentResults = 4096);
+    ~ResultSink();
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    /// @brief Новый писатель, вызывается из любого потока
+    [[nodiscard]] Producer producer() noexcept;
+
+    /**
+     * @brief Сливает опубликованные результаты в сессию по возрастанию адресов
+     *
+     * Вызывается, когда все Producer уже разрушены. Сегменты возвращаются в пул
+     * и переиспользуются следующим сканированием
+     *
+     * @param session куда добавить результаты, место под них резервируется сразу
+     * @return size_t сколько результатов добавлено
+     */
+    size_t drainInto(ScanSessions& session);
+
+    /// @brief Сколько байт занимают все сегменты (и занятые, и в пуле)
+    [[nodiscard]] size_t reservedBytes() const noexcept;
+
+private:
+    struct Segment
+    {
+        // в стеке опубликованных или в пуле; acquire() читает его, пока другой поток
+        // может класть сегмент, поэтому атомарный: запись release, чтение acquire
+        std::atomic<Segment*> next{nullptr};
+        uint32_t producer = 0;
+        uint32_t sequence = 0; // номер сегмента у своего Producer
+        size_t count = 0;
+        std::unique_ptr<uintptr_t[]> addresses;
+        std::unique_ptr<std::byte[]> values;
+    };
+
+    /// @brief Сегмент из пула или новый
+    [[nodiscard]] Segment* acquire();
+
+    /// @brief Кладёт сегмент на вершину стека
+    static void push(std::atomic<Segment*>& head, Segment* segment) noexcept;
+
+    size_t valueSize;
+    size_t segmentResults;
+
+    std::atomic<Segment*> published{nullptr};
+    std::atomic<Segment*> freeList{nullptr}; // во время сканирования из пула только берут, ABA не возникает
+    std::atomic<uint32_t> producers{0};
+    std::atomic<size_t> segments{0};
+};
@@ -0,0 +1,74 @@
+#include "scanArena.hpp"
+#include <algorithm>
+
+ScanArena::CountingResource::CountingResource(std::pmr::memory_resource* upstream) noexcept : upstream(upstream) {}
+
+void* ScanArena::CountingResource::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = upstream->allocate(bytes, alignment);
+
+    reserved += bytes;
+    peak = std::max(peak, reserved);
+
+    return p;
+}
+
+void ScanArena::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    upstream->deallocate(p, bytes, alignment);
+    reserved -= bytes;
+}
+
+bool ScanArena::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+ScanArena::ScanArena(size_t initialSize, std::pmr::memory_resource* upstream)
+    : counting(upstream), arena(std::max<size_t>(initialSize, 1), &counting) {}
+
+void ScanArena::release() noexcept
+{
+    arena.release();
+    usedBytes = 0;
+}
+
+size_t ScanArena::used() const noexcept
+{
+    return usedBytes;
+}
+
+size_t ScanArena::reserved() const noexcept
+{
+    return counting.reserved;
+}
+
+size_t ScanArena::peakUsed() const noexcept
+{
+    return peakBytes;
+}
+
+size_t ScanArena::peakReserved() const noexcept
+{
+    return counting.peak;
+}
+
+void* ScanArena::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = arena.allocate(bytes, alignment);
+
+    usedBytes += bytes;
+    peakBytes = std::max(peakBytes, usedBytes);
+
+    return p;
+}
+
+void ScanArena::do_deallocate(void*, size_t, size_t)
+{
+    // память возвращается только целиком через release()
+}
+
+bool ScanArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @brief Арена для временных данных сканирования (std::pmr)
+ *
+ * Выделение -- сдвиг указателя в крупном блоке, освобождение отдельных
+ * объектов ничего не делает, вся память возвращается разом через release().
+ * Считает, сколько байт выдано и сколько взято у upstream, и их пиковые значения.
+ * Не потокобезопасна: на поток -- своя арена
+ */
+class ScanArena : public std::pmr::memory_resource
+{
+public:
+    /**
+     * @param initialSize размер первого блока, следующие растут геометрически
+     * @param upstream откуда брать блоки
+     */
+    explicit ScanArena(size_t initialSize = 1 << 20, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    ScanArena(const ScanArena&) = delete;
+    ScanArena& operator=(const ScanArena&) = delete;
+
+    /// @brief Возвращает все блоки upstream, все выданные указатели становятся недействительны
+    void release() noexcept;
+
+    /// @brief Сколько байт выдано с последнего release()
+    [[nodiscard]] size_t used() const noexcept;
+
+    /// @brief Сколько байт сейчас взято у upstream
+    [[nodiscard]] size_t reserved() const noexcept;
+
+    [[nodiscard]] size_t peakUsed() const noexcept;
+    [[nodiscard]] size_t peakReserved() const noexcept;
+
+private:
+    /// @brief Прослойка над upstream, считающая взятые блоки
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream) noexcept;
+
+        size_t reserved = 0;
+        size_t peak = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::pmr::memory_resource* upstream;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    CountingResource counting;
+    std::pmr::monotonic_buffer_resource arena;
+
+    size_t usedBytes = 0;
+    size_t peakBytes = 0;
+};
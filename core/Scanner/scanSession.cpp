@@ -2,23 +2,111 @@
 #include <unordered_set>
 #include <ranges>
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <span>
 
-ScanSessions::ScanSessions(Value val, Memory mem) noexcept : mem(std::move(mem)) {}
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+ScanSessions::ScanSessions(Value val, Memory mem) noexcept
+    : arena(std::make_unique<ScanArena>()), mem(std::move(mem)) {}
+
+/**
+ * @brief Перемещающее присваивание по членам
+ *
+ * Байты старых результатов лежат в старой арене, поэтому результаты переносятся
+ * раньше арены: их деструкторы отрабатывают, пока старая арена жива.
+ * Сам список результатов -- в обычной куче, у обеих сторон один распределитель,
+ * и буфер просто забирается без поэлементного копирования
+ */
+ScanSessions& ScanSessions::operator=(ScanSessions&& other) noexcept
+{
+    if(this != &other)
+    {
+        result = std::move(other.result);
+        bitmaps = std::move(other.bitmaps);
+        shared = std::move(other.shared);
+        view = std::move(other.view);
+        mem = std::move(other.mem);
+        arena = std::move(other.arena);
+    }
+    return *this;
+}
 
 void ScanSessions::clear() noexcept
 {
-    result.clear();
+    result = {};
+    bitmaps = {};
+    shared = {};
+    view = {};
+    arena->release();
 }
 
 size_t ScanSessions::size() const noexcept
 {
-    return result.size();
+    return result.size() + bitmapHits();
 }
 
-const std::vector<ScanResult>& ScanSessions::getData() const noexcept
+const std::pmr::vector<ScanResult>& ScanSessions::getData()
 {
-    return result;
+    if(bitmaps.empty())
+        return result;
+
+    fillView(size());
+    return view;
+}
+
+std::span<const ScanResult> ScanSessions::getFirst(size_t limit)
+{
+    if(bitmaps.empty())
+        return std::span<const ScanResult>(result).first(std::min(limit, result.size()));
+
+    fillView(limit);
+    return view;
+}
+
+void ScanSessions::fillView(size_t limit)
+{
+    view.clear();
+    view.reserve(std::min(limit, size()));
+
+    size_t next = 0;
+
+    // байты копируются в обычную кучу: арена сессии не растёт от каждого показа
+    auto copy = [&](uintptr_t address, std::span<const std::byte> value)
+    {
+        view.push_back({address, std::pmr::vector<std::byte>(value.begin(), value.end())});
+    };
+
+    for(const auto& map : bitmaps)
+    {
+        for(size_t w = 0; w < map.bits.size() && view.size() < limit; ++w)
+        {
+            for(uint64_t word = map.bits[w]; word != 0 && view.size() < limit; word &= word - 1)
+            {
+                uintptr_t address = map.base + (w * 64 + static_cast<size_t>(std::countr_zero(word))) * map.step;
+
+                for(; next < result.size() && result[next].address < address && view.size() < limit; ++next)
+                    copy(result[next].address, result[next].value);
+
+                if(view.size() < limit)
+                    copy(address, shared);
+            }
+        }
+    }
+
+    for(; next < result.size() && view.size() < limit; ++next)
+        copy(result[next].address, result[next].value);
+}
+
+const ScanArena& ScanSessions::getArena() const noexcept
+{
+    return *arena;
 }
 
 
@@ -26,26 +114,696 @@ void ScanSessions::add(uintptr_t addr, std::span<const std::byte> value)
 {
     if(addr == 0 || value.empty()) return;
 
-    result.push_back({addr, std::vector<std::byte>(value.begin(), value.end())});
+    result.push_back({addr, std::pmr::vector<std::byte>(value.begin(), value.end(), arena.get())});
+}
+
+void ScanSessions::reserve(size_t count)
+{
+    result.reserve(count);
+}
+
+void ScanSessions::addSlots
+(
+    uintptr_t base,
+    size_t step,
+    size_t slots,
+    std::span<const uint64_t> bits,
+    size_t count,
+    std::span<const std::byte> value
+)
+{
+    if(count == 0 || slots == 0 || value.empty())
+        return;
+
+    size_t words = (slots + 63) / 64;
+
+    // карта держит одно значение на всю сессию и порядок адресов, иначе блок идёт в список
+    bool fits = prefersBitmap(static_cast<double>(count) / static_cast<double>(slots), value.size())
+        && (bitmaps.empty() || (std::ranges::equal(shared, value)
+            && bitmaps.back().base + bitmaps.back().slots * bitmaps.back().step <= base));
+
+    if(!fits)
+    {
+        for(size_t w = 0; w < words; ++w)
+        {
+            for(uint64_t word = bits[w]; word != 0; word &= word - 1)
+                add(base + (w * 64 + static_cast<size_t>(std::countr_zero(word))) * step, value);
+        }
+        return;
+    }
+
+    if(bitmaps.empty())
+        shared.assign(value.begin(), value.end());
+
+    std::vector<uint64_t> copy(bits.begin(), bits.begin() + static_cast<ptrdiff_t>(words));
+
+    // биты за последним слотом не считаются совпадениями
+    if(slots % 64 != 0)
+        copy.back() &= (uint64_t{1} << (slots % 64)) - 1;
+
+    bitmaps.push_back({base, step, slots, count, std::move(copy)});
+}
+
+bool ScanSessions::prefersBitmap(double density, size_t valueSize) noexcept
+{
+    double listBytes = density * static_cast<double>(sizeof(ScanResult) + valueSize);
+
+    return listBytes > 0.125;
+}
+
+bool ScanSessions::bitmapCapable(const Value& value) noexcept
+{
+    using Type = Value::ValueType;
+
+    switch(value.type())
+    {
+        case Type::Int8:
+        case Type::UInt8:
+        case Type::Int16:
+        case Type::UInt16:
+        case Type::Int32:
+        case Type::UInt32:
+        case Type::Int64:
+        case Type::UInt64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t ScanSessions::bitmapHits() const noexcept
+{
+    size_t hits = 0;
+
+    for(const auto& map : bitmaps)
+        hits += map.count;
+
+    return hits;
+}
+
+size_t ScanSessions::bitmapBytes() const noexcept
+{
+    size_t bytes = 0;
+
+    for(const auto& map : bitmaps)
+        bytes += map.bits.size() * sizeof(uint64_t);
+
+    return bytes;
+}
+
+namespace
+{
+    // соседние результаты читаются одним окном, если между ними меньше страницы
+    constexpr size_t windowGap = 4096;
+    constexpr size_t windowLimit = 64 * 1024;
+
+    // окна одного readScatter
+    constexpr size_t batchWindows = 1024;
+    constexpr size_t batchBytes = 1024 * 1024;
+
+    // меньше результатов на блок -- накладные расходы пула больше выигрыша
+    constexpr size_t minBlockResults = 16 * 1024;
+    constexpr size_t blocksPerThread = 8;
+
+    constexpr uintptr_t pageMask = ~static_cast<uintptr_t>(4095);
+
+    /// @brief Выполняет jobs задач на потоках пула или, без пула, в вызывающем потоке
+    template <typename F>
+    void runJobs(ThreadPool* pool, size_t jobs, F&& job)
+    {
+        if(!pool || jobs <= 1)
+        {
+            for(size_t i = 0; i < jobs; ++i)
+                job(i);
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        size_t workers = std::min(pool->size(), jobs);
+        TaskGroup group;
+
+        for(size_t w = 0; w < workers; ++w)
+        {
+            pool->submit([&]
+            {
+                for(size_t i = next.fetch_add(1); i < jobs; i = next.fetch_add(1))
+                    job(i);
+            }, group);
+        }
+
+        pool->wait(group);
+    }
+
+    /**
+     * @brief Какие из отмеченных в candidates слотов слова карты хранят байты expected
+     *
+     * @param data байты слота 0 слова
+     * @param full все 64 слота слова прочитаны: тогда 4- и 8-байтовые значения с шагом
+     * в свой размер сравниваются по 16 байт за раз (SSE2)
+     */
+    uint64_t matchWord(const std::byte* data, uint64_t candidates, bool full, size_t step, std::span<const std::byte> expected) noexcept
+    {
+#if defined(__SSE2__)
+        if(full && step == expected.size() && (step == 4 || step == 8))
+        {
+            uint64_t mask = 0;
+            __m128i needle{};
+
+            if(step == 4)
+            {
+                uint32_t value;
+                std::memcpy(&value, expected.data(), sizeof(value));
+                needle = _mm_set1_epi32(static_cast<int>(value));
+            }
+            else
+            {
+                uint64_t value;
+                std::memcpy(&value, expected.data(), sizeof(value));
+                needle = _mm_set1_epi64x(static_cast<long long>(value));
+            }
+
+            // 64 слота по step байт -- step * 4 векторов
+            for(size_t k = 0; k < step * 4; ++k)
+            {
+                __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + k * 16)), needle);
+
+                if(step == 4)
+                {
+                    mask |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(equal))) << (k * 4);
+                }
+                else
+                {
+                    // 8-байтовый слот совпал, если совпали обе его половины
+                    equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+                    mask |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(equal))) << (k * 2);
+                }
+            }
+
+            return candidates & mask;
+        }
+#else
+        (void)full;
+#endif
+        uint64_t kept = 0;
+
+        for(uint64_t word = candidates; word != 0; word &= word - 1)
+        {
+            auto slot = static_cast<size_t>(std::countr_zero(word));
+
+            if(std::memcmp(data + slot * step, expected.data(), expected.size()) == 0)
+                kept |= uint64_t{1} << slot;
+        }
+
+        return kept;
+    }
+
+    /**
+     * @brief Сравнение числа типа T с прошлым значением
+     */
+    template <typename T>
+    struct ChangeTest
+    {
+        ValueChange change;
+        T delta;
+
+        bool operator()(std::span<const std::byte> now, std::span<const std::byte> previous) const noexcept
+        {
+            if(previous.size() < sizeof(T))
+                return false;
+
+            T current, before;
+            std::memcpy(&current, now.data(), sizeof(T));
+            std::memcpy(&before, previous.data(), sizeof(T));
+
+            switch(change)
+            {
+                case ValueChange::Changed: return std::memcmp(now.data(), previous.data(), sizeof(T)) != 0;
+                case ValueChange::Unchanged: return std::memcmp(now.data(), previous.data(), sizeof(T)) == 0;
+                case ValueChange::Increased: return current > before;
+                case ValueChange::Decreased: return current < before;
+                case ValueChange::ChangedBy: break;
+            }
+
+            if constexpr(std::is_floating_point_v<T>)
+            {
+                T tolerance = std::numeric_limits<T>::epsilon() * 4 * std::max({std::abs(current), std::abs(before), std::abs(delta)});
+                return std::abs(current - before - delta) <= tolerance;
+            }
+            else
+            {
+                using U = std::make_unsigned_t<T>;
+                return static_cast<U>(static_cast<U>(current) - static_cast<U>(before)) == static_cast<U>(delta);
+            }
+        }
+    };
+
+    /// @brief Строка: только изменилась или нет
+    struct TextChangeTest
+    {
+        bool changed;
+        size_t size;
+
+        bool operator()(std::span<const std::byte> now, std::span<const std::byte> previous) const noexcept
+        {
+            return previous.size() >= size && (std::memcmp(now.data(), previous.data(), size) != 0) == changed;
+        }
+    };
 }
 
 void ScanSessions::filterPrevious(const Value& val)
+{
+    filterPreviousWith(val, nullptr);
+}
+
+void ScanSessions::filterPrevious(const Value& val, ThreadPool& pool)
+{
+    filterPreviousWith(val, &pool);
+}
+
+void ScanSessions::filterPreviousWith(const Value& val, ThreadPool* pool)
+{
+    if(!bitmaps.empty())
+    {
+        if(bitmapCapable(val) && val.size() == shared.size())
+        {
+            std::vector<std::byte> bytes(val.size());
+            val.store(bytes.data());
+            filterBitmaps(bytes, pool);
+        }
+        else
+        {
+            expand();
+        }
+    }
+
+    filterWith(val.size(), [&](std::span<const std::byte> now, std::span<const std::byte>) { return val.match(now, 0.1); }, pool);
+}
+
+void ScanSessions::filterPrevious(const GroupPattern& group)
+{
+    expand();
+    filterWith(group.size(), [&](std::span<const std::byte> now, std::span<const std::byte>) { return group.match(now, 0.1); }, nullptr);
+}
+
+void ScanSessions::filterPrevious(const GroupPattern& group, ThreadPool& pool)
+{
+    expand();
+    filterWith(group.size(), [&](std::span<const std::byte> now, std::span<const std::byte>) { return group.match(now, 0.1); }, &pool);
+}
+
+void ScanSessions::filterPrevious(const FloatRange& range)
+{
+    expand();
+    filterWith(range.size(), [&](std::span<const std::byte> now, std::span<const std::byte>) { return range.match(now); }, nullptr);
+}
+
+void ScanSessions::filterPrevious(const FloatRange& range, ThreadPool& pool)
+{
+    expand();
+    filterWith(range.size(), [&](std::span<const std::byte> now, std::span<const std::byte>) { return range.match(now); }, &pool);
+}
+
+std::expected<void, ValueError> ScanSessions::filterChanged(ValueChange change, const Value& delta)
+{
+    return filterChangedWith(change, delta, nullptr);
+}
+
+std::expected<void, ValueError> ScanSessions::filterChanged(ValueChange change, const Value& delta, ThreadPool& pool)
+{
+    return filterChangedWith(change, delta, &pool);
+}
+
+std::expected<void, ValueError> ScanSessions::filterChangedWith(ValueChange change, const Value& delta, ThreadPool* pool)
+{
+    // у всех слотов карт одно прошлое значение: «не изменилось» -- то же И по нему,
+    // остальные условия оставляют разные значения и требуют списка
+    if(!bitmaps.empty())
+    {
+        if(change == ValueChange::Unchanged && delta.size() == shared.size())
+            filterBitmaps(shared, pool);
+        else
+            expand();
+    }
+
+    auto typed = [&]<typename T>() -> std::expected<void, ValueError>
+    {
+        T difference;
+        delta.store(reinterpret_cast<std::byte*>(&difference));
+
+        filterWith(sizeof(T), ChangeTest<T>{change, difference}, pool);
+        return {};
+    };
+
+    using Type = Value::ValueType;
+
+    switch(delta.type())
+    {
+        case Type::Int8: return typed.template operator()<int8_t>();
+        case Type::UInt8: return typed.template operator()<uint8_t>();
+        case Type::Int16: return typed.template operator()<int16_t>();
+        case Type::UInt16: return typed.template operator()<uint16_t>();
+        case Type::Int32: return typed.template operator()<int32_t>();
+        case Type::UInt32: return typed.template operator()<uint32_t>();
+        case Type::Int64: return typed.template operator()<int64_t>();
+        case Type::UInt64: return typed.template operator()<uint64_t>();
+        case Type::Float: return typed.template operator()<float>();
+        case Type::Double: return typed.template operator()<double>();
+        default: break;
+    }
+
+    if(change != ValueChange::Changed && change != ValueChange::Unchanged)
+        return std::unexpected{ValueError::InvalidType};
+
+    filterWith(delta.size(), TextChangeTest{change == ValueChange::Changed, delta.size()}, pool);
+    return {};
+}
+
+template <typename Keep>
+void ScanSessions::filterWith(size_t valueSize, const Keep& keep, ThreadPool* pool)
 {
     if(result.empty())
         return;
 
-    std::erase_if(result, [&](ScanResult& addr)
+    size_t blockCount = 1;
+
+    // байты выживших пишутся в уже выделенное место; если где-то его не хватит,
+    // выделение из арены не потокобезопасно и весь проход идёт одним блоком
+    if(pool && std::ranges::all_of(result, [&](const ScanResult& item) { return item.value.capacity() >= valueSize; }))
+        blockCount = std::clamp(result.size() / minBlockResults, size_t{1}, pool->size() * blocksPerThread);
+
+    // границы блоков сдвигаются вперёд до смены страницы, чтобы окна разных потоков не читали одно и то же
+    std::vector<FilterBlock> blocks{};
+    size_t begin = 0;
+
+    for(size_t b = 1; b <= blockCount && begin < result.size(); ++b)
     {
-        std::vector<std::byte> buffer(val.size());
+        size_t end = result.size() * b / blockCount;
 
-        auto readByte = mem.readBlock(addr.address, val.size(), buffer.data());
+        if(end <= begin)
+            continue;
 
-        if(!readByte) return true;
+        while(end < result.size() && (result[end].address & pageMask) == (result[end - 1].address & pageMask))
+            ++end;
 
-        if(!val.match(std::span(buffer), 0.1))
-            return true;
+        blocks.push_back({begin, end});
+        begin = end;
+    }
+
+    runJobs(pool, blocks.size(), [&](size_t b) { filterBlock(valueSize, keep, blocks[b]); });
+
+    compactBlocks(blocks, pool);
+}
+
+template <typename Keep>
+void ScanSessions::filterBlock(size_t valueSize, const Keep& keep, FilterBlock& block)
+{
+    std::vector<MemorySpan> windows{};
+    std::vector<size_t> firstResult{}; // первый результат каждого окна и граница после последнего
+    std::vector<uint8_t> valid{};
+    std::vector<std::byte> buffer{};
+    std::vector<std::byte> single(valueSize);
+
+    size_t kept = block.begin;
+    size_t next = block.begin;
+
+    while(next < block.end)
+    {
+        windows.clear();
+        firstResult.clear();
 
-        addr.value = std::move(buffer);
-        return false;
+        size_t bytes = 0;
+        size_t i = next;
+
+        while(i < block.end && windows.size() < batchWindows && bytes < batchBytes)
+        {
+            uintptr_t start = result[i].address;
+            uintptr_t end = start + valueSize;
+
+            firstResult.push_back(i);
+
+            for(++i; i < block.end; ++i)
+            {
+                uintptr_t address = result[i].address;
+
+                if(address < start || address > end + windowGap || address + valueSize - start > windowLimit)
+                    break;
+
+                end = std::max(end, address + valueSize);
+            }
+
+            windows.push_back({start, end - start});
+            bytes += end - start;
+        }
+
+        firstResult.push_back(i);
+        buffer.resize(bytes);
+        valid.assign(windows.size(), 0);
+
+        // при ошибке все окна остаются невалидными и проверяются поштучно
+        (void)mem.readScatter(windows, buffer.data(), valid.data());
+
+        const std::byte* data = buffer.data();
+
+        for(size_t w = 0; w < windows.size(); ++w)
+        {
+            for(size_t r = firstResult[w]; r < firstResult[w + 1]; ++r)
+            {
+                std::span<const std::byte> view{};
+
+                if(valid[w])
+                {
+                    view = {data + (result[r].address - windows[w].address), valueSize};
+                }
+                else
+                {
+                    // окно задело неотображённую страницу между результатами
+                    auto readByte = mem.readBlock(result[r].address, valueSize, single.data());
+
+                    if(!readByte || *readByte < valueSize)
+                        continue;
+
+                    view = single;
+                }
+
+                if(!keep(view, std::span<const std::byte>(result[r].value)))
+                    continue;
+
+                ScanResult& survivor = result[kept++];
+
+                if(&survivor != &result[r])
+                    survivor = std::move(result[r]);
+
+                survivor.value.assign(view.begin(), view.end());
+            }
+
+            data += windows[w].size;
+        }
+
+        next = i;
+    }
+
+    block.kept = kept - block.begin;
+}
+
+void ScanSessions::compactBlocks(std::vector<FilterBlock>& blocks, ThreadPool* pool)
+{
+    // после отсева выжившие блока b лежат в [begin, begin + kept), место им -- [target, target + kept)
+    std::vector<size_t> target(blocks.size());
+    size_t total = 0;
+
+    for(size_t b = 0; b < blocks.size(); ++b)
+    {
+        target[b] = total;
+        total += blocks[b].kept;
+    }
+
+    // блок можно сдвигать, когда его новое место не задевает выживших ещё не сдвинутых блоков левее;
+    // правее мешать нечему: target не больше begin
+    std::vector<uint8_t> moved(blocks.size(), 0);
+    std::vector<size_t> wave{};
+    size_t left = blocks.size();
+
+    while(left > 0)
+    {
+        wave.clear();
+
+        for(size_t b = 0; b < blocks.size(); ++b)
+        {
+            if(moved[b])
+                continue;
+
+            bool free = true;
+
+            for(size_t j = 0; j < b && free; ++j)
+            {
+                if(!moved[j] && blocks[j].kept > 0)
+                    free = target[b] + blocks[b].kept <= blocks[j].begin || blocks[j].begin + blocks[j].kept <= target[b];
+            }
+
+            if(free)
+                wave.push_back(b);
+        }
+
+        runJobs(wave.size() > 1 ? pool : nullptr, wave.size(), [&](size_t w)
+        {
+            const FilterBlock& block = blocks[wave[w]];
+            size_t to = target[wave[w]];
+
+            if(to != block.begin)
+                std::move(result.begin() + block.begin, result.begin() + block.begin + block.kept, result.begin() + to);
+        });
+
+        for(size_t b : wave)
+            moved[b] = 1;
+
+        left -= wave.size();
+    }
+
+    // хвост -- перемещённые элементы, их байты остаются в арене до clear()
+    result.erase(result.begin() + total, result.end());
+}
+
+void ScanSessions::filterBitmaps(std::span<const std::byte> expected, ThreadPool* pool)
+{
+    // expected может указывать на shared, который здесь же заменяется
+    std::vector<std::byte> now(expected.begin(), expected.end());
+
+    runJobs(pool, bitmaps.size(), [&](size_t i) { filterBitmap(bitmaps[i], now); });
+
+    shared = std::move(now);
+    std::erase_if(bitmaps, [](const SlotBitmap& map) { return map.count == 0; });
+
+    spillBitmaps([&](const SlotBitmap& map)
+    {
+        return !prefersBitmap(static_cast<double>(map.count) / static_cast<double>(map.slots), shared.size());
     });
-}
\ No newline at end of file
+}
+
+void ScanSessions::filterBitmap(SlotBitmap& map, std::span<const std::byte> expected) const
+{
+    std::vector<MemorySpan> windows{};
+    std::vector<std::pair<size_t, size_t>> words{}; // слова карты [first, last) каждого окна
+    std::vector<uint8_t> valid{};
+    std::vector<std::byte> buffer{};
+    std::vector<std::byte> single(expected.size());
+
+    size_t wordBytes = 64 * map.step;
+    size_t w = 0;
+
+    while(w < map.bits.size())
+    {
+        windows.clear();
+        words.clear();
+
+        size_t bytes = 0;
+
+        // окно -- серия соседних слов, где ещё остались биты
+        while(w < map.bits.size() && windows.size() < batchWindows && bytes < batchBytes)
+        {
+            if(map.bits[w] == 0)
+            {
+                ++w;
+                continue;
+            }
+
+            size_t first = w;
+
+            while(w < map.bits.size() && map.bits[w] != 0 && (w - first) * wordBytes < windowLimit)
+                ++w;
+
+            size_t lastSlot = std::min(w * 64, map.slots) - 1;
+            size_t size = (lastSlot - first * 64) * map.step + expected.size();
+
+            windows.push_back({map.base + first * wordBytes, size});
+            words.push_back({first, w});
+            bytes += size;
+        }
+
+        if(windows.empty())
+            break;
+
+        buffer.resize(bytes);
+        valid.assign(windows.size(), 0);
+
+        (void)mem.readScatter(windows, buffer.data(), valid.data());
+
+        const std::byte* data = buffer.data();
+
+        for(size_t k = 0; k < windows.size(); ++k)
+        {
+            for(size_t v = words[k].first; v < words[k].second; ++v)
+            {
+                if(valid[k])
+                {
+                    map.bits[v] = matchWord(data + (v - words[k].first) * wordBytes, map.bits[v], (v + 1) * 64 <= map.slots, map.step, expected);
+                    continue;
+                }
+
+                // окно задело неотображённую страницу между слотами: каждый слот читается сам
+                for(uint64_t word = map.bits[v]; word != 0; word &= word - 1)
+                {
+                    size_t bit = static_cast<size_t>(std::countr_zero(word));
+                    auto readByte = mem.readBlock(map.base + (v * 64 + bit) * map.step, expected.size(), single.data());
+
+                    if(!readByte || *readByte < expected.size() || std::memcmp(single.data(), expected.data(), expected.size()) != 0)
+                        map.bits[v] &= ~(uint64_t{1} << bit);
+                }
+            }
+
+            data += windows[k].size;
+        }
+    }
+
+    map.count = 0;
+
+    for(uint64_t word : map.bits)
+        map.count += static_cast<size_t>(std::popcount(word));
+}
+
+template <typename Keep>
+void ScanSessions::spillBitmaps(const Keep& keep)
+{
+    size_t before = result.size();
+    size_t added = 0;
+
+    for(const auto& map : bitmaps)
+    {
+        if(keep(map))
+            added += map.count;
+    }
+
+    if(added == 0)
+    {
+        std::erase_if(bitmaps, keep);
+        return;
+    }
+
+    result.reserve(before + added);
+
+    for(const auto& map : bitmaps)
+    {
+        if(!keep(map))
+            continue;
+
+        for(size_t w = 0; w < map.bits.size(); ++w)
+        {
+            for(uint64_t word = map.bits[w]; word != 0; word &= word - 1)
+            {
+                uintptr_t address = map.base + (w * 64 + static_cast<size_t>(std::countr_zero(word))) * map.step;
+                result.push_back({address, std::pmr::vector<std::byte>(shared.begin(), shared.end(), arena.get())});
+            }
+        }
+    }
+
+    std::erase_if(bitmaps, keep);
+
+    // карты идут по возрастанию, так что дописанный хвост уже отсортирован
+    std::inplace_merge(result.begin(), result.begin() + static_cast<ptrdiff_t>(before), result.end(),
+        [](const ScanResult& a, const ScanResult& b) { return a.address < b.address; });
+}
+
+void ScanSessions::expand()
+{
+    if(!bitmaps.empty())
+        spillBitmaps([](const SlotBitmap&) { return true; });
+}
@@ -1,15 +1,51 @@
 #pragma once
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <vector>
 #include <span>
+#include "floatRange.hpp"
+#include "groupPattern.hpp"
+#include "scanArena.hpp"
+#include "threadPool.hpp"
 #include "value.hpp"
 #include "../Process/MemoryReader.hpp"
+
+/**
+ * @brief Найденный адрес и байты значения
+ *
+ * Байты лежат в арене сессии или потока, который нашёл совпадение
+ */
 struct ScanResult
 {
     uintptr_t address;
-    std::vector<std::byte> value;
+    std::pmr::vector<std::byte> value;
+};
+
+/**
+ * @brief Как значение должно было измениться с прошлого отсева
+ */
+enum class ValueChange
+{
+    Changed,
+    Unchanged,
+    Increased,
+    Decreased,
+    ChangedBy // ровно на заданную разницу
 };
 
+/**
+ * @brief Результаты сканирования одного процесса
+ *
+ * Байты всех результатов выделяются из собственной ScanArena, clear() возвращает их разом.
+ * Сам список растёт геометрически в обычной куче: в монотонной арене каждое
+ * удвоение оставляло бы прежний буфер занятым до clear()
+ *
+ * Плотные блоки совпадений точного целого значения хранятся картой слотов: бит на каждый
+ * выровненный слот блока, байты значения у всех отмеченных слотов общие. Отсев карт идёт
+ * побитовым И с маской совпадений, карта, поредевшая ниже prefersBitmap(), переходит
+ * в список. getData() отдаёт список, собранный из карт и списка отдельно от них
+ */
 class ScanSessions
 {
 public:
@@ -20,17 +56,180 @@ public:
     ScanSessions& operator=(const ScanSessions&) = delete;
 
     ScanSessions(ScanSessions&&) noexcept = default;
-    ScanSessions& operator=(ScanSessions&&) noexcept = default;
+    ScanSessions& operator=(ScanSessions&& other) noexcept;
 
     explicit ScanSessions(Value val, Memory mem) noexcept;
     void clear() noexcept;
     [[nodiscard]] size_t size() const noexcept;
-    [[nodiscard]]   const std::vector<ScanResult>& getData() const noexcept;
+
+    /**
+     * @brief Все результаты списком по возрастанию адресов
+     *
+     * Карты слотов остаются картами: если они есть, список собирается отдельно
+     * в обычной куче. Ссылка действительна до следующего getData(), getFirst() или изменения сессии
+     */
+    [[nodiscard]] const std::pmr::vector<ScanResult>& getData();
+
+    /**
+     * @brief Первые limit результатов по возрастанию адресов, без разворачивания карт
+     *
+     * Ссылка действительна до следующего getData(), getFirst() или изменения сессии
+     */
+    [[nodiscard]] std::span<const ScanResult> getFirst(size_t limit);
+
+    /// @brief Арена результатов: текущий и пиковый объём
+    [[nodiscard]] const ScanArena& getArena() const noexcept;
 
     void filterPrevious(const Value& val);
+
+    /**
+     * @brief Отсев на потоках пула
+     *
+     * Результаты делятся на блоки по границам страниц, каждый поток читает свои
+     * соседние результаты общими окнами через readScatter, проверяет и уплотняет блок
+     * на месте. Затем блоки сдвигаются к началу массива волнами: в волну попадают
+     * блоки, чьё новое место не задевает ещё не сдвинутые данные. Порядок адресов
+     * сохраняется, второй копии массива нет
+     */
+    void filterPrevious(const Value& val, ThreadPool& pool);
+
+    /// @brief Оставляет структуры, у которых все поля шаблона по-прежнему совпадают
+    void filterPrevious(const GroupPattern& group);
+    void filterPrevious(const GroupPattern& group, ThreadPool& pool);
+
+    /// @brief Оставляет адреса, где float/double по-прежнему в интервале
+    void filterPrevious(const FloatRange& range);
+    void filterPrevious(const FloatRange& range, ThreadPool& pool);
+
+    /**
+     * @brief Отсев по сравнению с прошлым значением, сохранённым в каждом результате
+     *
+     * Тип берётся из delta и выбирается один раз на проход, сравнение идёт уже над
+     * типизированными числами. Целые сравниваются со знаком своего типа, разница для
+     * ChangedBy считается по модулю 2^N (переполнение счётчика -- тоже изменение на delta),
+     * для float/double допускается ошибка округления в несколько ULP.
+     * Changed/Unchanged сравнивают байты, так что NaN, оставшийся NaN, не изменился.
+     * Байты выживших заменяются текущими в том же проходе
+     *
+     * @param change условие отсева
+     * @param delta тип значений и, для ChangedBy, ожидаемая разница «сейчас минус раньше»
+     * @return std::expected<void, ValueError>
+     * @retval ValueError::InvalidType если для строки запрошено что-то кроме Changed/Unchanged
+     */
+    std::expected<void, ValueError> filterChanged(ValueChange change, const Value& delta);
+    std::expected<void, ValueError> filterChanged(ValueChange change, const Value& delta, ThreadPool& pool);
     void add(uintptr_t addr, std::span<const std::byte> value);
 
+    /// @brief Резервирует место под count результатов, чтобы серия add() не перевыделяла список
+    void reserve(size_t count);
+
+    /**
+     * @brief Добавляет совпадения одного блока по карте слотов
+     *
+     * Слот i -- адрес base + i * step. Если совпадений достаточно много, блок хранится
+     * картой, иначе отмеченные слоты добавляются в список по одному
+     *
+     * @param bits бит i -- совпадение в слоте i, не меньше (slots + 63) / 64 слов
+     * @param count сколько битов отмечено
+     * @param value байты значения, одинаковые во всех отмеченных слотах
+     */
+    void addSlots
+    (
+        uintptr_t base,
+        size_t step,
+        size_t slots,
+        std::span<const uint64_t> bits,
+        size_t count,
+        std::span<const std::byte> value
+    );
+
+    /**
+     * @brief Дешевле ли карта слотов, чем список, при доле совпадений density
+     *
+     * Элемент списка стоит sizeof(ScanResult) и байты значения, бит карты -- 1/8 байта
+     * на каждый слот, совпал он или нет
+     */
+    [[nodiscard]] static bool prefersBitmap(double density, size_t valueSize) noexcept;
+
+    /// @brief Можно ли хранить совпадения value картой: совпадение означает равенство байтов
+    [[nodiscard]] static bool bitmapCapable(const Value& value) noexcept;
+
+    /// @brief Сколько результатов хранится картами и сколько байт занимают карты
+    [[nodiscard]] size_t bitmapHits() const noexcept;
+    [[nodiscard]] size_t bitmapBytes() const noexcept;
+
 private:
-    std::vector<ScanResult> result{};
+    /// @brief Карта совпадений блока: бит i -- слот по адресу base + i * step
+    struct SlotBitmap
+    {
+        uintptr_t base;
+        size_t step;
+        size_t slots;
+        size_t count;
+        std::vector<uint64_t> bits;
+    };
+
+    /// @brief Непрерывный участок результатов [begin, end) и сколько в нём осталось после отсева
+    struct FilterBlock
+    {
+        size_t begin;
+        size_t end;
+        size_t kept = 0;
+    };
+
+    /**
+     * @brief Общий проход отсева
+     *
+     * @param valueSize сколько байт читать по каждому адресу
+     * @param keep keep(сейчас, прошлое значение) -- оставить ли результат
+     */
+    template <typename Keep>
+    void filterWith(size_t valueSize, const Keep& keep, ThreadPool* pool);
+
+    void filterPreviousWith(const Value& val, ThreadPool* pool);
+
+    std::expected<void, ValueError> filterChangedWith(ValueChange change, const Value& delta, ThreadPool* pool);
+
+    /// @brief Проверяет и уплотняет блок по месту: выжившие -- с block.begin подряд
+    template <typename Keep>
+    void filterBlock(size_t valueSize, const Keep& keep, FilterBlock& block);
+
+    /// @brief Сдвигает уплотнённые блоки к началу массива и обрезает хвост
+    void compactBlocks(std::vector<FilterBlock>& blocks, ThreadPool* pool);
+
+    /**
+     * @brief Оставляет в картах слоты, где сейчас лежат байты expected
+     *
+     * Читаются только слова карты, где ещё есть биты; поредевшие карты уходят в список
+     */
+    void filterBitmaps(std::span<const std::byte> expected, ThreadPool* pool);
+
+    /**
+     * @brief Проверяет одну карту
+     *
+     * Окно, которое не прочиталось целиком, перечитывается по слотам: выбывают только
+     * слоты, которые не читаются сами
+     */
+    void filterBitmap(SlotBitmap& map, std::span<const std::byte> expected) const;
+
+    /**
+     * @brief Переносит карты, для которых keep() истинно, в список с сохранением порядка адресов
+     */
+    template <typename Keep>
+    void spillBitmaps(const Keep& keep);
+
+    /// @brief Разворачивает все карты в список
+    void expand();
+
+    /// @brief Собирает в view первые limit результатов из списка и карт по возрастанию адресов
+    void fillView(size_t limit);
+
+    // арена объявлена раньше результатов и разрушается после них
+    std::unique_ptr<ScanArena> arena;
+
+    std::pmr::vector<ScanResult> result{};
+    std::vector<SlotBitmap> bitmaps{}; // по возрастанию base, не пересекаются
+    std::vector<std::byte> shared{}; // байты значения во всех отмеченных слотах карт
+    std::pmr::vector<ScanResult> view{}; // список и карты вместе для getData()/getFirst(), байты -- в обычной куче
     Memory mem;
 };
\ No newline at end of file
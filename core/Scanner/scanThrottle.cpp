@@ -0,0 +1,196 @@
+#include "scanThrottle.hpp"
+#include <algorithm>
+#include <thread>
+
+CpuPin::~CpuPin()
+{
+    if(pinned)
+        sched_setaffinity(0, sizeof(previous), &previous);
+}
+
+CpuPin::CpuPin(CpuPin&& other) noexcept : previous(other.previous), pinned(other.pinned)
+{
+    other.pinned = false;
+}
+
+bool CpuPin::active() const noexcept
+{
+    return pinned;
+}
+
+ScanThrottle::ScanThrottle(std::vector<pid_t> targets, ThrottleConfig config)
+    : targets(std::move(targets)), config(config), rate(static_cast<double>(config.bytesPerSecond)), ceiling(rate)
+{
+    if(config.avoidTargetCpus)
+    {
+        cpu_set_t own;
+
+        if(sched_getaffinity(0, sizeof(own), &own) == 0)
+        {
+            for(pid_t pid : this->targets)
+            {
+                auto allowed = TargetLoad::allowedCpus(pid);
+                if(!allowed) continue;
+
+                for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if(CPU_ISSET(cpu, &*allowed))
+                        CPU_CLR(cpu, &own);
+                }
+            }
+
+            if(CPU_COUNT(&own) > 0)
+                scannerCpus = own;
+        }
+    }
+
+    if(config.adaptive)
+    {
+        // базовое ожидание цели снимается до начала сканирования, иначе в нём будет и наша нагрузка
+        auto before = sampleTargets();
+        auto started = Clock::now();
+
+        std::this_thread::sleep_for(config.sampleInterval);
+
+        lastCounters = sampleTargets();
+
+        if(before && lastCounters)
+        {
+            auto elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+            uint64_t waited = lastCounters->waitNs > before->waitNs ? lastCounters->waitNs - before->waitNs : 0;
+            baseline = static_cast<double>(waited) * 1e-9 / elapsed;
+        }
+    }
+
+    lastSample = Clock::now();
+    nextFree = lastSample;
+}
+
+std::optional<SchedCounters> ScanThrottle::sampleTargets() const
+{
+    SchedCounters total{};
+    bool any = false;
+
+    for(pid_t pid : targets)
+    {
+        if(auto counters = TargetLoad::schedCounters(pid))
+        {
+            total.runNs += counters->runNs;
+            total.waitNs += counters->waitNs;
+            any = true;
+        }
+    }
+
+    return any ? std::optional{total} : std::nullopt;
+}
+
+void ScanThrottle::adapt(Clock::time_point now, const std::optional<SchedCounters>& sample)
+{
+    auto elapsed = std::chrono::duration<double>(now - lastSample).count();
+
+    if(sample && lastCounters && elapsed > 0.0)
+    {
+        // завершившиеся потоки пропадают из суммы, она может уменьшиться
+        uint64_t waited = sample->waitNs > lastCounters->waitNs ? sample->waitNs - lastCounters->waitNs : 0;
+        double delay = static_cast<double>(waited) * 1e-9 / elapsed;
+        double throughput = static_cast<double>(bytesSinceSample) / elapsed;
+
+        bool backingOff = rate > 0.0 && rate < ceiling;
+
+        if(baseline < 0.0 || delay < baseline)
+            baseline = delay;
+        else if(!backingOff && delay - baseline <= config.maxDelayRatio)
+            baseline += (delay - baseline) / 64.0;
+
+        double excess = delay - baseline;
+
+        if(excess > config.maxDelayRatio)
+        {
+            // без потолка тормозим от той скорости, что была на самом деле
+            if(rate == 0.0)
+                ceiling = rate = std::max(throughput, minRate);
+
+            rate = std::max(rate / 2.0, minRate);
+            ++counters.backoffs;
+        }
+        else if(excess < config.maxDelayRatio / 2.0 && rate > 0.0)
+        {
+            rate = std::min(ceiling, rate + ceiling / 8.0);
+
+            // без потолка, восстановившись полностью, снимаем ограничение
+            if(config.bytesPerSecond == 0 && rate >= ceiling)
+                rate = 0.0;
+        }
+    }
+
+    lastSample = now;
+    lastCounters = sample;
+    bytesSinceSample = 0;
+}
+
+void ScanThrottle::acquire(size_t bytes)
+{
+    bool sample = false;
+
+    {
+        std::lock_guard lock(mutex);
+
+        bytesSinceSample += bytes;
+
+        if(config.adaptive && !sampling && Clock::now() - lastSample >= config.sampleInterval)
+            sample = sampling = true;
+    }
+
+    // /proc читается без mutex: остальные потоки тем временем не стоят на нём
+    if(sample)
+    {
+        auto sampled = sampleTargets();
+
+        std::lock_guard lock(mutex);
+        adapt(Clock::now(), sampled);
+        sampling = false;
+    }
+
+    Clock::duration wait{};
+
+    {
+        std::lock_guard lock(mutex);
+        auto now = Clock::now();
+
+        if(rate == 0.0)
+        {
+            nextFree = now;
+            return;
+        }
+
+        // опоздавший поток не копит кредит на будущее
+        auto start = std::max(now, nextFree);
+        nextFree = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(bytes / rate));
+        wait = start - now;
+        counters.slept += wait;
+    }
+
+    if(wait > Clock::duration::zero())
+        std::this_thread::sleep_for(wait);
+}
+
+CpuPin ScanThrottle::pin() const
+{
+    CpuPin pinned{};
+
+    if(!scannerCpus || sched_getaffinity(0, sizeof(pinned.previous), &pinned.previous) != 0)
+        return pinned;
+
+    pinned.pinned = sched_setaffinity(0, sizeof(*scannerCpus), &*scannerCpus) == 0;
+    return pinned;
+}
+
+ThrottleStats ScanThrottle::stats() const
+{
+    std::lock_guard lock(mutex);
+
+    ThrottleStats current = counters;
+    current.rate = rate;
+
+    return current;
+}
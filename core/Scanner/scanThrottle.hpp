@@ -0,0 +1,143 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <sched.h>
+#include <sys/types.h>
+
+#include "../Process/TargetLoad.hpp"
+
+/**
+ * @brief Настройки ScanThrottle
+ *
+ * bytesPerSecond -- потолок скорости чтения, 0 -- без потолка
+ * avoidTargetCpus -- сажать потоки сканера на процессоры, запрещённые цели
+ * adaptive -- снижать скорость, когда потоки цели начинают ждать CPU
+ * maxDelayRatio -- на сколько доля времени ожидания в очереди планировщика
+ *     (сумма по потокам цели к прошедшему времени) может превысить базовую, выше -- торможение
+ * sampleInterval -- как часто смотреть на счётчики цели
+ */
+struct ThrottleConfig
+{
+    size_t bytesPerSecond = 0;
+    bool avoidTargetCpus = true;
+    bool adaptive = true;
+    double maxDelayRatio = 0.05;
+    std::chrono::milliseconds sampleInterval{100};
+};
+
+/**
+ * @brief Статистика ограничителя
+ *
+ * slept -- сколько времени потоки сканера проспали в acquire()
+ * backoffs -- сколько раз скорость снижалась из-за нагрузки на цель
+ * rate -- текущий предел в байт/сек, 0 -- без предела
+ */
+struct ThrottleStats
+{
+    std::chrono::nanoseconds slept{};
+    size_t backoffs = 0;
+    double rate = 0.0;
+};
+
+/**
+ * @brief Привязка текущего потока к процессорам, снимается в деструкторе
+ */
+class CpuPin
+{
+public:
+    CpuPin() noexcept = default;
+    ~CpuPin();
+
+    CpuPin(const CpuPin&) = delete;
+    CpuPin& operator=(const CpuPin&) = delete;
+
+    CpuPin(CpuPin&& other) noexcept;
+    CpuPin& operator=(CpuPin&& other) = delete;
+
+    /// @brief Поток действительно перепривязан
+    [[nodiscard]] bool active() const noexcept;
+
+private:
+    friend class ScanThrottle;
+
+    cpu_set_t previous{};
+    bool pinned = false;
+};
+
+/**
+ * @brief Ограничитель скорости сканирования, чтобы не мешать живому процессу
+ *
+ * Скорость считается по схеме GCRA: каждое чтение сдвигает момент, когда
+ * разрешено следующее, на bytes / rate, опоздавший поток спит.
+ * Раз в sampleInterval сравниваются счётчики планировщика целей. Базовое ожидание
+ * снимается при создании, опускается до наименьшего замеченного и медленно
+ * подтягивается вверх вслед за нагрузкой самой цели, но только пока сканер
+ * не тормозит: иначе оно догоняло бы ожидание, которое создаём мы сами.
+ * Если потоки целей ждут CPU дольше базового на maxDelayRatio, скорость делится
+ * пополам (не ниже 1 МБ/с), а пока цели спокойны -- возвращается к потолку шагами по 1/8.
+ * Без потолка торможение начинается с фактической скорости сканирования.
+ *
+ * Потокобезопасен: один объект на все потоки сканирования
+ */
+class ScanThrottle
+{
+public:
+    /**
+     * При adaptive конструктор спит один sampleInterval, чтобы снять базовое ожидание целей
+     *
+     * @param targets процессы, которые сканируются и которые надо беречь
+     * @param config настройки
+     */
+    explicit ScanThrottle(std::vector<pid_t> targets, ThrottleConfig config = {});
+
+    /// Наибольшее чтение за раз под ограничителем: крупный блок -- это всплеск нагрузки на цель
+    static constexpr size_t burstBytes = 256 * 1024;
+
+    ScanThrottle(const ScanThrottle&) = delete;
+    ScanThrottle& operator=(const ScanThrottle&) = delete;
+
+    /**
+     * @brief Разрешение прочитать bytes байт, при необходимости спит
+     */
+    void acquire(size_t bytes);
+
+    /**
+     * @brief Перепривязывает вызывающий поток на процессоры, свободные от целей
+     *
+     * Если цели могут работать на всех наших процессорах (обычный случай без taskset/cpuset),
+     * ничего не делает и возвращает неактивный CpuPin
+     */
+    [[nodiscard]] CpuPin pin() const;
+
+    [[nodiscard]] ThrottleStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double minRate = 1024.0 * 1024.0;
+
+    /// @brief Сверяется со счётчиками целей, вызывается под mutex, sample снят до него
+    void adapt(Clock::time_point now, const std::optional<SchedCounters>& sample);
+
+    [[nodiscard]] std::optional<SchedCounters> sampleTargets() const;
+
+    std::vector<pid_t> targets;
+    ThrottleConfig config;
+    std::optional<cpu_set_t> scannerCpus{};
+
+    mutable std::mutex mutex{};
+    double rate = 0.0;
+    double ceiling = 0.0;
+    Clock::time_point nextFree{};
+
+    Clock::time_point lastSample{};
+    std::optional<SchedCounters> lastCounters{};
+    double baseline = -1.0; // отрицательное -- ещё не измерено
+    size_t bytesSinceSample = 0;
+    bool sampling = false; // какой-то поток уже читает счётчики целей
+
+    ThrottleStats counters{};
+};
@@ -1,7 +1,18 @@
 #include "scanner.hpp"
+#include "../Process/PageMap.hpp"
+#include "../Process/RegionClassifier.hpp"
+#include <bit>
+#include <optional>
 #include <span>
+#include <thread>
 
-Scanner::Scanner(size_t chunkSize) noexcept : buffer(chunkSize) {}
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// на одном ядре читать наперёд некому: ядро и поиск делят один CPU,
+// а /proc/pid/mem копирует через промежуточную страницу и медленнее process_vm_readv
+Scanner::Scanner(size_t chunkSize) noexcept : buffer(chunkSize), queuedReads(std::thread::hardware_concurrency() > 1) {}
 
 std::expected<void, ScanError> Scanner::scan
 (
@@ -11,31 +22,699 @@ std::expected<void, ScanError> Scanner::scan
     Memory& memory
 ) const
 {
+    return scanRegions(regions, sessions, value, memory);
+}
+
+std::expected<void, ScanError> Scanner::scan
+(
+    const std::vector<MemoryRegion>& regions,
+    ScanSessions& sessions,
+    const GroupPattern& group,
+    Memory& memory
+) const
+{
+    return scanRegions(regions, sessions, group, memory);
+}
+
+std::expected<void, ScanError> Scanner::scan
+(
+    const std::vector<MemoryRegion>& regions,
+    ScanSessions& sessions,
+    const FloatRange& range,
+    Memory& memory
+) const
+{
+    return scanRegions(regions, sessions, range, memory);
+}
+
+std::expected<void, ScanError> Scanner::scan
+(
+    RegionStream& regions,
+    ScanSessions& sessions,
+    const Value& value,
+    Memory& memory
+) const
+{
+    startStats();
+
+    std::optional<CpuPin> pinned{};
+
+    if(throttle)
+        pinned.emplace(throttle->pin());
+
+    std::optional<PageMap> pageMap;
+
+    if(residencyAware)
+    {
+        if(auto opened = PageMap::open(memory.getPid()))
+            pageMap.emplace(std::move(*opened));
+    }
+
+    std::optional<UringReader> uring{};
+
+    if(queuedReads && value.size() - 1 + step < queueSlot)
+    {
+        if(auto opened = UringReader::open(memory.getPid(), queueDepth))
+            uring.emplace(std::move(*opened));
+    }
+
+    std::vector<ScanPiece> pieces{};
+    std::vector<MappedFile> images{};
+
+    // следующий регион потока делится на участки в конец out, false -- карта кончилась
+    auto nextRegion = [&](std::vector<ScanPiece>& out) -> std::expected<bool, ScanError>
+    {
+        auto reg = regions.next();
+
+        if(!reg)
+            return std::unexpected{ScanError::ReadError};
+
+        if(!*reg)
+            return false;
+
+        splitRegion(**reg, pageMap ? &*pageMap : nullptr, out, images, memory.getPid());
+        return true;
+    };
+
+    // очередь io_uring пополняется следующими регионами заранее и не пустеет на их границах,
+    // образы файлов при этом живут до конца прохода
+    if(uring)
+        return scanQueued(pieces, nextRegion, sessions, value, memory, *uring);
+
+    while(true)
+    {
+        pieces.clear();
+        images.clear();
+
+        auto more = nextRegion(pieces);
+
+        if(!more)
+            return std::unexpected{more.error()};
+
+        if(!*more)
+            return {};
+
+        if(auto status = scanPieces(pieces, sessions, value, memory, nullptr); !status)
+            return status;
+    }
+}
+
+template <typename P>
+std::expected<void, ScanError> Scanner::scanRegions
+(
+    const std::vector<MemoryRegion>& regions,
+    ScanSessions& sessions,
+    const P& value,
+    Memory& memory
+) const
+{
+    startStats();
+
+    std::optional<CpuPin> pinned{};
+
+    if(throttle)
+        pinned.emplace(throttle->pin());
+
+    std::optional<PageMap> pageMap;
+
+    if(residencyAware)
+    {
+        if(auto opened = PageMap::open(memory.getPid()))
+            pageMap.emplace(std::move(*opened));
+    }
+
+    std::vector<ScanPiece> pieces{};
+    std::vector<MappedFile> images{};
+
     for (const auto& reg : regions)
+        splitRegion(reg, pageMap ? &*pageMap : nullptr, pieces, images, memory.getPid());
+
+    if(queuedReads && value.size() - 1 + step < queueSlot)
+    {
+        if(auto uring = UringReader::open(memory.getPid(), queueDepth))
+            return scanPieces(pieces, sessions, value, memory, &*uring);
+    }
+
+    return scanPieces(pieces, sessions, value, memory, nullptr);
+}
+
+void Scanner::splitRegion
+(
+    const MemoryRegion& reg,
+    PageMap* pageMap,
+    std::vector<ScanPiece>& pieces,
+    std::vector<MappedFile>& images,
+    pid_t pid
+) const
+{
+    if(fileImages && RegionClassifier::isFileImage(reg))
+    {
+        auto image = MappedFile::open(pid, reg);
+
+        // образ обрезается по шагу, чтобы хвост из процесса начинался на той же сетке слотов
+        if(size_t imageBytes = image ? image->bytes().size() / step * step : 0; imageBytes > 0)
+        {
+            pieces.push_back({reg.start, imageBytes, reg.end, true, image->bytes().data()});
+
+            // хвост региона за концом файла читается из процесса
+            if(imageBytes < reg.size())
+                pieces.push_back({reg.start + imageBytes, reg.size() - imageBytes, reg.end, true});
+
+            images.push_back(std::move(*image));
+            return;
+        }
+    }
+
+    if(pageMap && RegionClassifier::isZeroFill(reg))
+    {
+        if(auto residency = pageMap->residency(reg.start, reg.size()))
+        {
+            residency->forEachRun([&](uintptr_t addr, size_t size, bool backed)
+            {
+                pieces.push_back({addr, size, reg.end, backed});
+            });
+            return;
+        }
+    }
+
+    pieces.push_back({reg.start, reg.size(), reg.end, true});
+}
+
+template <typename P>
+std::expected<void, ScanError> Scanner::scanPieces
+(
+    std::vector<ScanPiece>& pieces,
+    ScanSessions& sessions,
+    const P& value,
+    Memory& memory,
+    UringReader* uring
+) const
+{
+    if(uring)
+        return scanQueued(pieces, [](std::vector<ScanPiece>&) -> std::expected<bool, ScanError> { return false; }, sessions, value, memory, *uring);
+
+    for(const auto& piece : pieces)
+    {
+        if(piece.image)
+        {
+            if(auto status = scanImage(piece, sessions, value, memory); !status)
+                return status;
+
+            continue;
+        }
+
+        auto status = piece.backed
+            ? scanRange(piece.start, piece.size, piece.limit, sessions, value, memory)
+            : scanZeroRun(piece.start, piece.size, piece.limit, sessions, value, memory);
+
+        if(!status) return status;
+    }
+    return {};
+}
+
+void Scanner::startStats() const
+{
+    stats = {};
+    started = std::chrono::steady_clock::now();
+}
+
+void Scanner::noteScanned() const
+{
+    if(stats.firstByte == std::chrono::nanoseconds::zero())
+        stats.firstByte = std::chrono::steady_clock::now() - started;
+}
+
+template <typename P, typename More>
+std::expected<void, ScanError> Scanner::scanQueued
+(
+    std::vector<ScanPiece>& pieces,
+    More&& more,
+    ScanSessions& sessions,
+    const P& value,
+    Memory& memory,
+    UringReader& uring
+) const
+{
+    // блок очереди: size == 0 -- участок не тронутых страниц или файла, он не читается
+    struct Block
+    {
+        size_t piece;
+        uintptr_t address;
+        size_t size;
+        size_t want;
+    };
+
+    size_t overlap = value.size() - 1;
+    size_t payload = (queueSlot - overlap) / step * step;
+
+    // под ограничителем блоки не крупнее, чем синхронное чтение в scanRange
+    if(throttle)
+        payload = std::min(payload, ScanThrottle::burstBytes);
+
+    std::vector<Block> blocks{};
+    size_t split = 0; // сколько участков уже разбито на блоки
+    bool exhausted = false;
+
+    auto addBlocks = [&]
+    {
+        for(; split < pieces.size(); ++split)
+        {
+            const auto& piece = pieces[split];
+
+            if(!piece.backed || piece.image)
+            {
+                blocks.push_back({split, piece.start, 0, 0});
+                continue;
+            }
+
+            for(uintptr_t pos = piece.start; pos < piece.start + piece.size; pos += payload)
+            {
+                size_t len = std::min(payload, piece.start + piece.size - pos);
+                blocks.push_back({split, pos, len, std::min(len + overlap, piece.limit - pos)});
+            }
+        }
+    };
+
+    addBlocks();
+
+    size_t depth = uring.depth();
+    queueBuffer.resize(depth * queueSlot);
+
+    auto slot = [&](size_t block) { return queueBuffer.data() + (block % depth) * queueSlot; };
+
+    // Reading -- чтение в io_uring, Ready -- results[] готов (байты или -errno),
+    // Unsent -- submit() не принял блок, он читается синхронно, когда до него дойдёт очередь
+    enum class SlotState : uint8_t { Reading, Ready, Unsent };
+
+    std::vector<SlotState> state(depth, SlotState::Ready);
+    std::vector<size_t> filled(depth, 0);
+    std::vector<int64_t> results(depth, 0);
+    size_t submitted = 0;
+
+    // короткое чтение дочитывается с места остановки в тот же слот, ошибка после
+    // части блока укорачивает его, как readBlock на границе отображения
+    auto complete = [&](const ReadCompletion& done)
+    {
+        size_t index = done.tag % depth;
+        const auto& block = blocks[done.tag];
+
+        if(done.result > 0)
+        {
+            filled[index] += static_cast<size_t>(done.result);
+
+            if(filled[index] < block.want &&
+               uring.submit(done.tag, block.address + filled[index], block.want - filled[index], slot(done.tag) + filled[index]))
+                return;
+        }
+
+        results[index] = filled[index] > 0 ? static_cast<int64_t>(filled[index]) : done.result;
+        state[index] = SlotState::Ready;
+    };
+
+    // ждёт, пока дочитается блок; чужие завершения раскладываются по их слотам
+    auto waitFor = [&](size_t block)
+    {
+        while(state[block % depth] == SlotState::Reading)
+        {
+            ReadCompletion completions[queueDepth];
+            size_t count = uring.reap(completions);
+
+            if(count == 0 && !uring.flush(1))
+                return false;
+
+            for(size_t i = 0; i < count; ++i)
+                complete(completions[i]);
+        }
+        return true;
+    };
+
+    for(size_t current = 0; ; ++current)
+    {
+        // блоков должно хватать на всю глубину очереди вперёд
+        while(!exhausted && blocks.size() < current + depth + 1)
+        {
+            auto added = more(pieces);
+
+            if(!added)
+                return std::unexpected{added.error()};
+
+            exhausted = !*added;
+            addBlocks();
+        }
+
+        if(current >= blocks.size())
+            break;
+
+        for(; submitted < blocks.size() && submitted < current + depth; ++submitted)
+        {
+            const auto& block = blocks[submitted];
+
+            if(block.size == 0) continue;
+
+            size_t index = submitted % depth;
+            filled[index] = 0;
+
+            if(throttle)
+                throttle->acquire(block.want);
+
+            if(!uring.submit(submitted, block.address, block.want, slot(submitted)))
+            {
+                state[index] = SlotState::Unsent;
+                ++submitted;
+                break;
+            }
+
+            state[index] = SlotState::Reading;
+        }
+
+        if(!uring.flush())
+            return std::unexpected{ScanError::ReadError};
+
+        const auto& block = blocks[current];
+
+        if(block.size == 0)
+        {
+            const auto& piece = pieces[block.piece];
+
+            if(piece.image)
+            {
+                if(auto status = scanImage(piece, sessions, value, memory); !status)
+                    return status;
+
+                continue;
+            }
+
+            if(auto status = scanZeroRun(piece.start, piece.size, piece.limit, sessions, value, memory); !status)
+                return status;
+
+            continue;
+        }
+
+        if(state[current % depth] == SlotState::Unsent)
+        {
+            auto read = memory.readBlock(block.address, block.want, slot(current));
+
+            if(!read)
+                return std::unexpected{ScanError::ReadError};
+
+            results[current % depth] = static_cast<int64_t>(*read);
+            state[current % depth] = SlotState::Ready;
+        }
+
+        if(!waitFor(current) || results[current % depth] < 0)
+            return std::unexpected{ScanError::ReadError};
+
+        auto readBytes = static_cast<size_t>(results[current % depth]);
+
+        stats.bytesRead += readBytes;
+        stats.queuedReads++;
+        noteScanned();
+
+        collectMatches(value, block.address, std::span<const std::byte>(slot(current), readBytes), sessions);
+    }
+    return {};
+}
+
+template <typename P>
+void Scanner::collectMatches(const P& value, uintptr_t base, std::span<const std::byte> data, ScanSessions& sessions) const
+{
+    if constexpr(std::is_same_v<P, Value>)
     {
-        size_t offset = 0;
-        while (offset < reg.size())
+        size_t valSize = value.size();
+
+        if(slotBitmaps && ScanSessions::bitmapCapable(value) && data.size() >= valSize)
         {
-            size_t size = std::min(buffer.size(), reg.size() - offset);
-            auto readBytes = memory.readBlock(reg.start + offset, size, buffer.data());
+            size_t slots = (data.size() - valSize) / step + 1;
+            size_t count = 0;
+            std::span<const std::byte> matched{};
 
-            if(!readBytes) return std::unexpected{ScanError::ReadError};
-            if(*readBytes == 0) break;
+            slotBits.assign((slots + 63) / 64, 0);
 
-            findMatches
-            (
-                value, reg.start + offset, *readBytes, [&](uintptr_t addr, auto bytes)
+            findMatches(value, base, data, [&](uintptr_t addr, auto bytes)
             {
-            sessions.add(addr, bytes);
+                size_t slot = (addr - base) / step;
+
+                slotBits[slot / 64] |= uint64_t{1} << (slot % 64);
+                matched = bytes;
+                count++;
             });
 
-            offset += *readBytes;
+            sessions.addSlots(base, step, slots, slotBits, count, matched);
+            return;
         }
     }
+
+    findMatches(value, base, data, [&](uintptr_t addr, auto bytes)
+    {
+        sessions.add(addr, bytes);
+    });
+}
+
+template <typename P>
+std::expected<void, ScanError> Scanner::scanRange
+(
+    uintptr_t start,
+    size_t size,
+    uintptr_t limit,
+    ScanSessions& sessions,
+    const P& value,
+    Memory& memory
+) const
+{
+    size_t overlap = value.size() - 1;
+
+    if(buffer.size() <= overlap + step)
+        return std::unexpected{ScanError::InvalidRegion};
+
+    size_t payload = (buffer.size() - overlap) / step * step;
+    uintptr_t end = start + size;
+
+    if(throttle)
+        payload = std::min(payload, ScanThrottle::burstBytes);
+
+    uintptr_t pos = start;
+
+    while (pos < end)
+    {
+        size_t len = std::min(payload, end - pos);
+        size_t want = std::min(len + overlap, limit - pos);
+
+        if(throttle)
+            throttle->acquire(want);
+
+        auto readBytes = memory.readBlock(pos, want, buffer.data());
+
+        if(!readBytes) return std::unexpected{ScanError::ReadError};
+        if(*readBytes == 0) break;
+
+        stats.bytesRead += *readBytes;
+        noteScanned();
+
+        collectMatches(value, pos, std::span<const std::byte>(buffer).first(*readBytes), sessions);
+
+        pos += std::min(*readBytes, len);
+    }
+    return {};
+}
+
+template <typename P>
+std::expected<void, ScanError> Scanner::scanImage(const ScanPiece& piece, ScanSessions& sessions, const P& value, Memory& memory) const
+{
+    size_t overlap = value.size() - 1;
+    size_t payload = std::max(step, (buffer.size() - overlap) / step * step);
+    std::span<const std::byte> image(piece.image, piece.size);
+
+    stats.bytesMapped += piece.size;
+    noteScanned();
+
+    for(size_t pos = 0; pos < image.size(); pos += payload)
+    {
+        auto block = image.subspan(pos, std::min(payload + overlap, image.size() - pos));
+
+        collectMatches(value, piece.start + pos, block, sessions);
+    }
+
+    // значения, которые начинаются в образе и заходят за его конец, образ не видит:
+    // шов дочитывается из процесса вместе с перекрытием до конца региона
+    size_t seam = std::min(overlap / step * step, piece.size);
+    uintptr_t end = piece.start + piece.size;
+
+    if(seam == 0 || piece.limit <= end)
+        return {};
+
+    return scanRange(end - seam, seam, piece.limit, sessions, value, memory);
+}
+
+/**
+ * @brief Обрабатывает участок не тронутых страниц приватной анонимной памяти
+ *
+ * Память не читается: если искомое значение совпадает с нулями, каждый выровненный
+ * слот участка добавляется как совпадение. Слоты, выходящие за конец участка
+ * в заполненную страницу, дочитываются обычным scanRange.
+ */
+template <typename P>
+std::expected<void, ScanError> Scanner::scanZeroRun
+(
+    uintptr_t start,
+    size_t size,
+    uintptr_t limit,
+    ScanSessions& sessions,
+    const P& value,
+    Memory& memory
+) const
+{
+    size_t valSize = value.size();
+    uintptr_t end = start + size;
+
+    stats.bytesSkipped += size;
+    noteScanned();
+
+    std::vector<std::byte> zeros(valSize);
+
+    uintptr_t tail = start;
+
+    bool bitmap = false;
+
+    if constexpr(std::is_same_v<P, Value>)
+        bitmap = slotBitmaps && ScanSessions::bitmapCapable(value);
+
+    if(value.match(zeros, 0.1) && bitmap)
+    {
+        // весь участок -- одна сплошь заполненная карта
+        size_t slots = size >= valSize ? (size - valSize) / step + 1 : 0;
+        std::vector<uint64_t> bits((slots + 63) / 64, ~uint64_t{0});
+
+        sessions.addSlots(start, step, slots, bits, slots, zeros);
+        tail += slots * step;
+    }
+    else if(value.match(zeros, 0.1))
+    {
+        for(; tail + valSize <= end; tail += step)
+            sessions.add(tail, zeros);
+    }
+    else if(size >= valSize)
+    {
+        tail += (size - valSize) / step * step + step;
+    }
+
+    if(tail < end && end < limit)
+        return scanRange(tail, end - tail, limit, sessions, value, memory);
+
     return {};
 }
 
+size_t Scanner::textCandidates
+(
+    const TextPattern& pattern,
+    std::span<const std::byte> data,
+    size_t from,
+    uint32_t* out,
+    size_t& count
+) noexcept
+{
+    size_t length = pattern.bytes.size();
+
+    if(data.size() < length)
+        return data.size();
+
+    // последняя позиция, с которой строка ещё помещается в блок
+    size_t lastStart = data.size() - length;
+    size_t probe = pattern.lastProbe();
+
+    auto first = static_cast<uint8_t>(pattern.bytes[0]);
+    auto last = static_cast<uint8_t>(pattern.bytes[probe]);
+
+    auto isLetter = [](uint8_t c) { return c >= 'a' && c <= 'z'; };
+    uint8_t firstFold = pattern.ignoreCase && isLetter(first) ? 0x20 : 0;
+    uint8_t lastFold = pattern.ignoreCase && isLetter(last) ? 0x20 : 0;
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t pos = from;
+    count = 0;
+
+#if defined(__SSE2__)
+    const __m128i firstVec = _mm_set1_epi8(static_cast<char>(first));
+    const __m128i lastVec = _mm_set1_epi8(static_cast<char>(last));
+    const __m128i firstFoldVec = _mm_set1_epi8(static_cast<char>(firstFold));
+    const __m128i lastFoldVec = _mm_set1_epi8(static_cast<char>(lastFold));
+
+    for(; pos + 16 <= lastStart + 1; pos += 16)
+    {
+        if(count + 16 > textBatch)
+            return pos;
+
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos + probe));
+
+        __m128i hit = _mm_and_si128
+        (
+            _mm_cmpeq_epi8(_mm_or_si128(head, firstFoldVec), firstVec),
+            _mm_cmpeq_epi8(_mm_or_si128(tail, lastFoldVec), lastVec)
+        );
+
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hit));
+
+        while(mask)
+        {
+            out[count++] = static_cast<uint32_t>(pos + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for(; pos <= lastStart; ++pos)
+    {
+        if(count == textBatch)
+            return pos;
+
+        if((bytes[pos] | firstFold) == first && (bytes[pos + probe] | lastFold) == last)
+            out[count++] = static_cast<uint32_t>(pos);
+    }
+
+    return data.size();
+}
+
 void Scanner::setAlignment(Alignment a) noexcept
 {
     step = static_cast<size_t>(a);
-}
\ No newline at end of file
+}
+
+size_t Scanner::getAlignment() const noexcept
+{
+    return step;
+}
+
+void Scanner::setResidencyAware(bool enabled) noexcept
+{
+    residencyAware = enabled;
+}
+
+void Scanner::setQueuedReads(bool enabled) noexcept
+{
+    queuedReads = enabled;
+}
+
+void Scanner::setFileImages(bool enabled) noexcept
+{
+    fileImages = enabled;
+}
+
+bool Scanner::getFileImages() const noexcept
+{
+    return fileImages;
+}
+
+void Scanner::setSlotBitmaps(bool enabled) noexcept
+{
+    slotBitmaps = enabled;
+}
+
+void Scanner::setThrottle(ScanThrottle* throttle) noexcept
+{
+    this->throttle = throttle;
+}
+
+const ScanStats& Scanner::lastStats() const noexcept
+{
+    return stats;
+}
@@ -1,8 +1,15 @@
 #pragma once
+#include "../Process/MappedFile.hpp"
 #include "../Process/MemoryReader.hpp"
 #include "../Process/ModuleFilter.hpp"
+#include "../Process/RegionStream.hpp"
+#include "../Process/UringReader.hpp"
+#include "floatRange.hpp"
+#include "groupPattern.hpp"
 #include "scanSession.hpp"
+#include "scanThrottle.hpp"
 #include "value.hpp"
+#include <chrono>
 #include <vector>
 #include <span>
 #include <cstddef>
@@ -22,6 +29,26 @@ enum class Alignment
     Four = 4
 };
 
+/**
+ * @brief Статистика последнего вызова Scanner::scan
+ *
+ * bytesRead -- сколько байт прочитано из процесса
+ * bytesSkipped -- сколько байт не читалось, т.к. страницы ни разу не трогались (известные нули)
+ * queuedReads -- сколько блоков прочитано через io_uring, 0 если сканер читал синхронно
+ * bytesMapped -- сколько байт взято из файлов модулей, а не из памяти процесса
+ * firstByte -- сколько прошло от начала scan() до первого байта, попавшего в поиск
+ */
+struct ScanStats
+{
+    size_t bytesRead = 0;
+    size_t bytesSkipped = 0;
+    size_t queuedReads = 0;
+    size_t bytesMapped = 0;
+    std::chrono::nanoseconds firstByte{};
+};
+
+class PageMap;
+
 class Scanner
 {
 public:
@@ -42,6 +69,50 @@ public:
         Memory& memory
     ) const;
 
+    /**
+     * @brief Первое сканирование по шаблону структуры
+     *
+     * Ищется только якорное поле шаблона, остальные поля проверяются в том же
+     * прочитанном блоке. Результат -- адрес начала структуры и её байты
+     */
+    [[nodiscard]] std::expected<void, ScanError> scan
+    (
+        const std::vector<MemoryRegion>& regions,
+        ScanSessions& sessions,
+        const GroupPattern& group,
+        Memory& memory
+    ) const;
+
+    /**
+     * @brief Первое сканирование float/double по интервалу
+     *
+     * Совпадения ищутся векторным ядром FloatRange::candidates, без сравнения по одному
+     */
+    [[nodiscard]] std::expected<void, ScanError> scan
+    (
+        const std::vector<MemoryRegion>& regions,
+        ScanSessions& sessions,
+        const FloatRange& range,
+        Memory& memory
+    ) const;
+
+    /**
+     * @brief Первое сканирование по потоку регионов
+     *
+     * Каждый регион сканируется сразу, как только поток его отдал, до разбора
+     * следующих строк maps. io_uring открывается один раз на весь проход, и его очередь
+     * заранее пополняется блоками следующих регионов
+     *
+     * @retval ScanError::ReadError если maps не дочитался или не разобрался
+     */
+    [[nodiscard]] std::expected<void, ScanError> scan
+    (
+        RegionStream& regions,
+        ScanSessions& sessions,
+        const Value& value,
+        Memory& memory
+    ) const;
+
     [[nodiscard]] std::vector<ScanResult> scanAll
     (
         const std::vector<MemoryRegion>& allRegions,
@@ -50,26 +121,90 @@ public:
     ) const noexcept;
 
     void setAlignment(Alignment a) noexcept;
-private:
-    mutable std::vector<std::byte> buffer{};
 
-    size_t step = 4;
+    /// @brief Шаг выравнивания слотов в байтах
+    [[nodiscard]] size_t getAlignment() const noexcept;
+
+    /**
+     * @brief Включает чтение только заполненных страниц по /proc/pid/pagemap
+     *
+     * Для приватной анонимной памяти не тронутые страницы не читаются, а считаются нулями.
+     * Если pagemap недоступен, сканер молча читает регионы целиком
+     */
+    void setResidencyAware(bool enabled) noexcept;
+
+    /**
+     * @brief Включает чтение /proc/pid/mem через io_uring с очередью из queueDepth блоков
+     *
+     * Пока сканер ищет совпадения в одном блоке, ядро читает следующие.
+     * По умолчанию включено, если ядер больше одного.
+     * Если io_uring недоступен, сканер читает через process_vm_readv, как раньше
+     */
+    void setQueuedReads(bool enabled) noexcept;
+
+    /**
+     * @brief Включает чтение не изменённых регионов файлов с диска
+     *
+     * Регион, который по smaps совпадает с файлом (RegionClassifier::isFileImage),
+     * отображается из файла в наш процесс и сканируется без process_vm_readv.
+     * Нужны usage регионов (RegionClassifier::attachUsage или RegionStream с usage),
+     * без них все регионы читаются из процесса.
+     * По умолчанию включено
+     */
+    void setFileImages(bool enabled) noexcept;
+
+    [[nodiscard]] bool getFileImages() const noexcept;
 
+    /**
+     * @brief Включает хранение плотных совпадений картой слотов (ScanSessions::addSlots)
+     *
+     * Для точных целых Value совпадения каждого прочитанного блока собираются в карту
+     * бит на выровненный слот, сессия сама решает, хранить ли её картой или списком.
+     * По умолчанию включено
+     */
+    void setSlotBitmaps(bool enabled) noexcept;
+
+    /**
+     * @brief Ограничивает скорость чтения и перепривязывает поток сканирования на время scan()
+     *
+     * @param throttle ограничитель, живёт дольше сканера; nullptr -- без ограничения
+     */
+    void setThrottle(ScanThrottle* throttle) noexcept;
+
+    [[nodiscard]] const ScanStats& lastStats() const noexcept;
+
+    /**
+     * @brief Ищет совпадения значения в уже прочитанном блоке памяти
+     *
+     * Не использует внутренний буфер сканера, поэтому может вызываться
+     * одновременно из нескольких потоков над разными блоками.
+     * Строки ищутся с шагом своей кодировки, а не выравнивания сканера
+     *
+     * @param value искомое значение
+     * @param base адрес в процессе, с которого начинается блок
+     * @param data прочитанные байты
+     * @param callBack вызывается для каждого совпадения (адрес, байты)
+     */
     template <typename T>
     void findMatches
     (
         const Value& value,
         uintptr_t base,
-        size_t dataSize,
+        std::span<const std::byte> data,
         T&& callBack
     ) const noexcept
     {
+        if(const auto* pattern = value.textPattern())
+        {
+            findText(value, *pattern, base, data, callBack);
+            return;
+        }
+
         size_t valSize = value.size();
-        auto span = std::span(buffer).first(dataSize);
 
-        for (size_t i = 0; i + valSize <= span.size(); i += step)
+        for (size_t i = 0; i + valSize <= data.size(); i += step)
         {
-            auto bytes = span.subspan(i, valSize);
+            auto bytes = data.subspan(i, valSize);
 
             if(value.match(bytes, 0.1))
             {
@@ -77,4 +212,264 @@ private:
             }
         }
     }
+
+    /**
+     * @brief Ищет совпадения шаблона структуры в уже прочитанном блоке
+     *
+     * Якорь ищется обычным findMatches по окну, сдвинутому на его смещение.
+     * Для числового якоря шагом сканера выравнивается начало структуры,
+     * строковый проверяет выравнивание своей кодировки по собственному адресу
+     */
+    template <typename T>
+    void findMatches
+    (
+        const GroupPattern& group,
+        uintptr_t base,
+        std::span<const std::byte> data,
+        T&& callBack
+    ) const noexcept
+    {
+        const auto& anchor = group.anchor();
+        size_t span = group.size();
+
+        if(data.size() < span)
+            return;
+
+        auto window = data.subspan(anchor.offset, data.size() - span + anchor.value.size());
+        size_t shift = anchor.value.textPattern() ? anchor.offset : 0;
+
+        findMatches(anchor.value, base + shift, window, [&](uintptr_t addr, auto)
+        {
+            auto whole = data.subspan(addr - shift - base, span);
+
+            if(group.matchRest(whole, 0.1))
+                callBack(addr - shift, whole);
+        });
+    }
+
+    /// @brief Ищет значения из интервала в уже прочитанном блоке
+    template <typename T>
+    void findMatches
+    (
+        const FloatRange& range,
+        uintptr_t base,
+        std::span<const std::byte> data,
+        T&& callBack
+    ) const noexcept
+    {
+        size_t valSize = range.size();
+        uint32_t candidates[FloatRange::batch];
+        size_t from = 0;
+
+        while(from < data.size())
+        {
+            size_t count = 0;
+            from = range.candidates(data, from, step, candidates, count);
+
+            for(size_t i = 0; i < count; ++i)
+                callBack(base + candidates[i], data.subspan(candidates[i], valSize));
+        }
+    }
+
+private:
+    /// Сколько кандидатов предфильтра проверяется за один проход
+    static constexpr size_t textBatch = 256;
+
+    /**
+     * @brief Поиск строки: предфильтр по первому и последнему байту, затем полная проверка
+     */
+    template <typename T>
+    void findText
+    (
+        const Value& value,
+        const TextPattern& pattern,
+        uintptr_t base,
+        std::span<const std::byte> data,
+        T&& callBack
+    ) const noexcept
+    {
+        size_t length = pattern.bytes.size();
+        size_t align = pattern.alignment();
+        uint32_t candidates[textBatch];
+        size_t from = 0;
+
+        while(from < data.size())
+        {
+            size_t count = 0;
+            from = textCandidates(pattern, data, from, candidates, count);
+
+            for(size_t i = 0; i < count; ++i)
+            {
+                size_t offset = candidates[i];
+
+                if((base + offset) % align != 0) continue;
+
+                auto bytes = data.subspan(offset, length);
+
+                if(value.match(bytes))
+                    callBack(base + offset, bytes);
+            }
+        }
+    }
+
+    /**
+     * @brief Собирает позиции, где совпадают первый и последний байт строки
+     *
+     * Сравнивает по 16 позиций за раз (SSE2), буквы сравниваются через '|0x20',
+     * поэтому при ignoreCase предфильтр пропускает оба регистра
+     *
+     * @param from с какой позиции продолжать
+     * @param out не меньше textBatch элементов
+     * @param count сколько позиций записано
+     * @return size_t позиция для следующего вызова, data.size() если блок пройден
+     */
+    static size_t textCandidates
+    (
+        const TextPattern& pattern,
+        std::span<const std::byte> data,
+        size_t from,
+        uint32_t* out,
+        size_t& count
+    ) noexcept;
+
+    /// Глубина очереди io_uring и размер блока одного чтения в ней
+    static constexpr unsigned queueDepth = 32;
+    static constexpr size_t queueSlot = 512 * 1024;
+
+    /**
+     * @brief Участок региона: заполненный (читается) или из не тронутых страниц
+     *
+     * image -- байты участка в отображённом файле, тогда участок не читается из процесса
+     */
+    struct ScanPiece
+    {
+        uintptr_t start;
+        size_t size;
+        uintptr_t limit;
+        bool backed;
+        const std::byte* image = nullptr;
+    };
+
+    /**
+     * @brief Читает и сканирует диапазон [start, start + size) блоками по размеру буфера
+     *
+     * Каждый блок дочитывается на value.size() - 1 байт вперёд (не дальше limit),
+     * чтобы не терять значения, лежащие на границе блоков
+     */
+    template <typename P>
+    [[nodiscard]] std::expected<void, ScanError> scanRange
+    (
+        uintptr_t start,
+        size_t size,
+        uintptr_t limit,
+        ScanSessions& sessions,
+        const P& value,
+        Memory& memory
+    ) const;
+
+    /**
+     * @brief Сканирует участок прямо в отображённом файле, блоками с тем же перекрытием, что scanRange
+     *
+     * Последние байты образа, за которыми регион продолжается (limit дальше конца участка),
+     * пересканируются через scanRange вместе с началом следующего участка
+     */
+    template <typename P>
+    [[nodiscard]] std::expected<void, ScanError> scanImage(const ScanPiece& piece, ScanSessions& sessions, const P& value, Memory& memory) const;
+
+    /// @brief Добавляет совпадения для не тронутых (нулевых) страниц без чтения памяти
+    template <typename P>
+    [[nodiscard]] std::expected<void, ScanError> scanZeroRun
+    (
+        uintptr_t start,
+        size_t size,
+        uintptr_t limit,
+        ScanSessions& sessions,
+        const P& value,
+        Memory& memory
+    ) const;
+
+    /**
+     * @brief Сканирует участки, держа в io_uring до queueDepth чтений наперёд
+     *
+     * Блоки обрабатываются в порядке адресов: завершившиеся раньше своей очереди
+     * ждут в своих слотах, так что результаты попадают в сессию отсортированными
+     *
+     * @param pieces участки, дополняются через more
+     * @param more more(pieces) дописывает участки следующего региона,
+     *        std::expected<bool, ScanError>: false -- участков больше нет
+     */
+    template <typename P, typename More>
+    [[nodiscard]] std::expected<void, ScanError> scanQueued
+    (
+        std::vector<ScanPiece>& pieces,
+        More&& more,
+        ScanSessions& sessions,
+        const P& value,
+        Memory& memory,
+        UringReader& uring
+    ) const;
+
+    /// @brief Общий проход по регионам для Value, GroupPattern и FloatRange
+    template <typename P>
+    [[nodiscard]] std::expected<void, ScanError> scanRegions
+    (
+        const std::vector<MemoryRegion>& regions,
+        ScanSessions& sessions,
+        const P& value,
+        Memory& memory
+    ) const;
+
+    /**
+     * @brief Делит регион на участки: из файла, из не тронутых страниц и читаемые
+     *
+     * @param pageMap pagemap процесса или nullptr, если он не открыт
+     * @param images отображения файлов, должны жить, пока сканируются участки
+     */
+    void splitRegion
+    (
+        const MemoryRegion& reg,
+        PageMap* pageMap,
+        std::vector<ScanPiece>& pieces,
+        std::vector<MappedFile>& images,
+        pid_t pid
+    ) const;
+
+    /// @brief Сканирует участки через io_uring, если он открыт, иначе по одному синхронно
+    template <typename P>
+    [[nodiscard]] std::expected<void, ScanError> scanPieces
+    (
+        std::vector<ScanPiece>& pieces,
+        ScanSessions& sessions,
+        const P& value,
+        Memory& memory,
+        UringReader* uring
+    ) const;
+
+    /**
+     * @brief Передаёт совпадения блока в сессию
+     *
+     * Для точных целых Value -- одной картой слотов через ScanSessions::addSlots,
+     * для остального -- по одному через add()
+     */
+    template <typename P>
+    void collectMatches(const P& value, uintptr_t base, std::span<const std::byte> data, ScanSessions& sessions) const;
+
+    /// @brief Начинает статистику нового прохода
+    void startStats() const;
+
+    /// @brief Отмечает время первого байта, попавшего в поиск
+    void noteScanned() const;
+
+    mutable std::vector<std::byte> buffer{};
+    mutable std::vector<std::byte> queueBuffer{}; // слоты io_uring, отдельно от buffer: его занимают scanZeroRun
+    mutable std::vector<uint64_t> slotBits{};
+    mutable ScanStats stats{};
+    mutable std::chrono::steady_clock::time_point started{};
+
+    size_t step = 4;
+    bool residencyAware = true;
+    bool queuedReads = false;
+    bool fileImages = true;
+    bool slotBitmaps = true;
+    ScanThrottle* throttle = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "signatureScanner.hpp"
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <sys/stat.h>
+#include "../Process/ElfInfo.hpp"
+
+namespace
+{
+    /// Блок чтения исполняемого региона
+    constexpr size_t readChunk = 1024 * 1024;
+
+    bool isCode(const MemoryRegion& region) noexcept
+    {
+        return region.permissions.size() >= 3 && region.permissions[0] == 'r' && region.permissions[2] == 'x'
+            && region.pathname.starts_with('/') && !region.pathname.ends_with("(deleted)");
+    }
+
+    bool sameModule(const std::string& pathname, std::string_view module) noexcept
+    {
+        if(module.empty() || module == "*" || pathname == module)
+            return true;
+
+        auto slash = pathname.rfind('/');
+        return std::string_view(pathname).substr(slash + 1) == module;
+    }
+
+    /// @brief Ключ модуля: build-id или, без него, путь, размер и время изменения файла
+    std::string moduleIdentity(pid_t pid, const std::string& pathname)
+    {
+        auto file = ElfInfo::processPath(pid, pathname);
+
+        if(auto id = ElfInfo::buildId(file))
+            return "build-id:" + *id;
+
+        struct stat info{};
+
+        if(::stat(file.c_str(), &info) != 0)
+            return {};
+
+        return "file:" + pathname + ":" + std::to_string(info.st_size) + ":" + std::to_string(info.st_mtim.tv_sec)
+            + "." + std::to_string(info.st_mtim.tv_nsec);
+    }
+}
+
+std::expected<CodeSignature, ValueError> CodeSignature::parse(std::string_view text)
+{
+    static constexpr char hex[] = "0123456789ABCDEF";
+    CodeSignature signature{};
+
+    while(!text.empty())
+    {
+        auto begin = text.find_first_not_of(" \t");
+
+        if(begin == std::string_view::npos)
+            break;
+
+        text.remove_prefix(begin);
+
+        auto token = text.substr(0, text.find_first_of(" \t"));
+        text.remove_prefix(token.size());
+
+        if(!signature.canonical.empty())
+            signature.canonical += ' ';
+
+        if(token == "?" || token == "??")
+        {
+            signature.bytes.push_back(0);
+            signature.fixed.push_back(0);
+            signature.canonical += "??";
+            continue;
+        }
+
+        uint8_t byte = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), byte, 16);
+
+        if(token.size() != 2 || ec != std::errc{} || ptr != token.data() + token.size())
+            return std::unexpected{ValueError::InvalidFormat};
+
+        signature.bytes.push_back(byte);
+        signature.fixed.push_back(1);
+        signature.canonical += hex[byte >> 4];
+        signature.canonical += hex[byte & 0xf];
+    }
+
+    if(std::ranges::find(signature.fixed, 1) == signature.fixed.end())
+        return std::unexpected{ValueError::InvalidFormat};
+
+    // пропуск совпадает с любым байтом, поэтому окно нельзя сдвинуть дальше последнего пропуска
+    size_t length = signature.bytes.size();
+    size_t last = length - 1;
+    size_t longest = length;
+
+    for(size_t i = 0; i < last; ++i)
+    {
+        if(!signature.fixed[i])
+            longest = last - i;
+    }
+
+    signature.skip.fill(longest);
+
+    for(size_t i = 0; i < last; ++i)
+    {
+        if(signature.fixed[i])
+            signature.skip[signature.bytes[i]] = std::min(longest, last - i);
+    }
+
+    return signature;
+}
+
+size_t CodeSignature::size() const noexcept
+{
+    return bytes.size();
+}
+
+const std::string& CodeSignature::text() const noexcept
+{
+    return canonical;
+}
+
+std::expected<std::vector<uintptr_t>, ScanError> SignatureScanner::scanModule
+(
+    const std::vector<const MemoryRegion*>& code,
+    const CodeSignature& signature,
+    Memory& memory
+) const
+{
+    std::vector<uintptr_t> offsets{};
+    std::vector<std::byte> buffer(readChunk + signature.size() - 1);
+    size_t overlap = signature.size() - 1;
+
+    for(const MemoryRegion* region : code)
+    {
+        for(uintptr_t pos = region->start; pos < region->end; pos += readChunk)
+        {
+            size_t want = std::min(readChunk + overlap, region->end - pos);
+            auto readBytes = memory.readBlock(pos, want, buffer.data());
+
+            if(!readBytes)
+                return std::unexpected{ScanError::ReadError};
+
+            // вхождение, начатое в перекрытии, найдёт следующий блок
+            size_t limit = std::min(readChunk, *readBytes);
+
+            signature.find(std::span<const std::byte>(buffer).first(*readBytes), [&](size_t at)
+            {
+                if(at < limit)
+                    offsets.push_back(region->offset + (pos - region->start) + at);
+            });
+        }
+    }
+
+    return offsets;
+}
+
+std::expected<std::vector<SignatureMatch>, ScanError> SignatureScanner::find
+(
+    const std::vector<MemoryRegion>& layout,
+    std::string_view module,
+    const CodeSignature& signature,
+    Memory& memory
+)
+{
+    cached = 0;
+    scanned = 0;
+
+    // исполняемые регионы и начало образа каждого модуля
+    std::map<std::string, std::vector<const MemoryRegion*>> modules{};
+    std::map<std::string, uintptr_t> bases{};
+
+    for(const auto& region : layout)
+    {
+        if(!region.pathname.starts_with('/'))
+            continue;
+
+        auto [base, added] = bases.try_emplace(region.pathname, region.start);
+
+        if(!added)
+            base->second = std::min(base->second, region.start);
+
+        if(isCode(region) && sameModule(region.pathname, module))
+            modules[region.pathname].push_back(&region);
+    }
+
+    if(modules.empty())
+        return std::unexpected{ScanError::InvalidRegion};
+
+    std::vector<SignatureMatch> matches{};
+
+    for(const auto& [path, code] : modules)
+    {
+        auto identity = moduleIdentity(memory.getPid(), path);
+        auto key = identity + "\n" + signature.text();
+
+        // без ключа модуль не кешируется: нечем проверить, что файл тот же
+        std::vector<uintptr_t> uncached{};
+        const std::vector<uintptr_t>* offsets = nullptr;
+
+        if(auto entry = cache.find(key); !identity.empty() && entry != cache.end())
+        {
+            offsets = &entry->second;
+            ++cached;
+        }
+        else
+        {
+            auto found = scanModule(code, signature, memory);
+
+            if(!found)
+                return std::unexpected{found.error()};
+
+            ++scanned;
+
+            if(identity.empty())
+                offsets = &(uncached = std::move(*found));
+            else
+                offsets = &cache.emplace(std::move(key), std::move(*found)).first->second;
+        }
+
+        // смещение в файле обратно в адрес: в этой раскладке регион мог сдвинуться
+        for(uintptr_t offset : *offsets)
+        {
+            for(const MemoryRegion* region : code)
+            {
+                if(offset >= region->offset && offset - region->offset < region->size())
+                {
+                    uintptr_t address = region->start + (offset - region->offset);
+                    matches.push_back({address, path, address - bases[path]});
+                    break;
+                }
+            }
+        }
+    }
+
+    std::ranges::sort(matches, {}, &SignatureMatch::address);
+    return matches;
+}
+
+size_t SignatureScanner::lastCached() const noexcept
+{
+    return cached;
+}
+
+size_t SignatureScanner::lastScanned() const noexcept
+{
+    return scanned;
+}
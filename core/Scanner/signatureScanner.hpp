@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../Process/MemoryReader.hpp"
+#include "../Process/ModuleMapParser.hpp"
+#include "scanner.hpp"
+#include "value.hpp"
+
+/**
+ * @brief Сигнатура кода: байты с пропусками, "48 8B 05 ?? ?? ?? ?? 48 85 C0"
+ *
+ * Поиск -- Бойер-Мур-Хорспул с учётом пропусков: сдвиг по последнему байту окна
+ * берётся из таблицы, построенной при разборе. Пропуск в середине ограничивает
+ * сдвиг, поэтому сигнатуры, кончающиеся конкретными байтами, ищутся быстрее
+ */
+class CodeSignature
+{
+public:
+    /**
+     * @brief Разбирает сигнатуру
+     *
+     * Байт -- две шестнадцатеричные цифры, пропуск -- "?" или "??", разделитель -- пробел
+     *
+     * @param text сигнатура
+     * @return std::expected<CodeSignature, ValueError> сигнатура
+     * @retval ValueError::InvalidFormat если токен не байт и не пропуск или все токены -- пропуски
+     */
+    static std::expected<CodeSignature, ValueError> parse(std::string_view text);
+
+    [[nodiscard]] size_t size() const noexcept;
+
+    /// @brief Каноническая запись: байты заглавными через пробел, пропуски "??"
+    [[nodiscard]] const std::string& text() const noexcept;
+
+    /**
+     * @brief Ищет все вхождения в блоке
+     *
+     * @param callBack вызывается со смещением каждого вхождения от начала data
+     */
+    template <typename T>
+    void find(std::span<const std::byte> data, T&& callBack) const
+    {
+        size_t length = bytes.size();
+
+        if(data.size() < length)
+            return;
+
+        const auto* memory = reinterpret_cast<const uint8_t*>(data.data());
+        size_t last = length - 1;
+
+        for(size_t pos = 0; pos + length <= data.size(); pos += skip[memory[pos + last]])
+        {
+            size_t i = length;
+
+            while(i > 0 && (!fixed[i - 1] || memory[pos + i - 1] == bytes[i - 1]))
+                --i;
+
+            if(i == 0)
+                callBack(pos);
+        }
+    }
+
+private:
+    CodeSignature() = default;
+
+    std::vector<uint8_t> bytes{};
+    std::vector<uint8_t> fixed{}; // 0 -- пропуск
+    std::array<size_t, 256> skip{};
+    std::string canonical{};
+};
+
+/**
+ * @brief Найденное вхождение сигнатуры
+ *
+ * module -- путь модуля, moduleOffset -- смещение от начала его образа в памяти
+ */
+struct SignatureMatch
+{
+    uintptr_t address;
+    std::string module;
+    uintptr_t moduleOffset;
+};
+
+/**
+ * @brief Поиск сигнатур в исполняемых регионах модулей
+ *
+ * Читаются только r-x регионы файлов. Найденные вхождения запоминаются как смещения
+ * в файле под ключом (build-id модуля, сигнатура): тот же модуль в другом процессе
+ * или после перезапуска отвечает из кеша без чтения памяти. Если build-id нет,
+ * ключом служат путь, размер и время изменения файла
+ */
+class SignatureScanner
+{
+public:
+    /**
+     * @brief Ищет сигнатуру в модулях процесса
+     *
+     * @param layout все регионы процесса (неотфильтрованные)
+     * @param module полный путь или имя файла модуля, пустая строка или "*" -- все модули
+     * @param signature сигнатура
+     * @param memory память процесса
+     * @return std::expected<std::vector<SignatureMatch>, ScanError> вхождения по возрастанию адресов
+     * @retval ScanError::InvalidRegion если подходящих исполняемых регионов нет
+     * @retval ScanError::ReadError если регион не читается
+     */
+    std::expected<std::vector<SignatureMatch>, ScanError> find
+    (
+        const std::vector<MemoryRegion>& layout,
+        std::string_view module,
+        const CodeSignature& signature,
+        Memory& memory
+    );
+
+    /// @brief Сколько модулей в последнем find() ответили из кеша и сколько прочитаны
+    [[nodiscard]] size_t lastCached() const noexcept;
+    [[nodiscard]] size_t lastScanned() const noexcept;
+
+private:
+    /// @brief Смещения в файле вхождений сигнатуры в исполняемые регионы модуля
+    std::expected<std::vector<uintptr_t>, ScanError> scanModule
+    (
+        const std::vector<const MemoryRegion*>& code,
+        const CodeSignature& signature,
+        Memory& memory
+    ) const;
+
+    std::unordered_map<std::string, std::vector<uintptr_t>> cache{};
+    size_t cached = 0;
+    size_t scanned = 0;
+};
@@ -0,0 +1,111 @@
+#include "threadPool.hpp"
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if(threadCount == 0)
+        threadCount = 1;
+
+    workers.reserve(threadCount);
+
+    for(size_t i = 0; i < threadCount; ++i)
+        workers.emplace_back([this](std::stop_token stop) { workerLoop(stop); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    for(auto& worker : workers)
+        worker.request_stop();
+
+    taskReady.notify_all();
+
+    // потоки дожидаются здесь: mutex и условные переменные объявлены после workers
+    // и разрушаются раньше, чем jthread сам присоединился бы в деструкторе члена
+    for(auto& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(mutex);
+        tasks.push(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void ThreadPool::submit(std::function<void()> task, TaskGroup& group)
+{
+    {
+        std::lock_guard lock(group.mutex);
+        ++group.pending;
+    }
+
+    submit([task = std::move(task), &group]
+    {
+        // группа отмечается и при исключении из задачи, иначе wait(group) не вернётся
+        struct Done
+        {
+            TaskGroup& group;
+
+            ~Done()
+            {
+                std::lock_guard lock(group.mutex);
+
+                if(--group.pending == 0)
+                    group.finished.notify_all();
+            }
+        } done{group};
+
+        task();
+    });
+}
+
+void ThreadPool::wait(TaskGroup& group)
+{
+    std::unique_lock lock(group.mutex);
+    group.finished.wait(lock, [&] { return group.pending == 0; });
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && active == 0; });
+}
+
+size_t ThreadPool::size() const noexcept
+{
+    return workers.size();
+}
+
+/**
+ * @brief Цикл рабочего потока: забирает задачи из очереди до запроса остановки
+ *
+ * @param stop токен остановки от std::jthread
+ */
+void ThreadPool::workerLoop(std::stop_token stop)
+{
+    while(true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex);
+
+            if(!taskReady.wait(lock, stop, [this] { return !tasks.empty(); }))
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+            ++active;
+        }
+
+        task();
+
+        {
+            std::lock_guard lock(mutex);
+            --active;
+
+            if(tasks.empty() && active == 0)
+                idle.notify_all();
+        }
+    }
+}
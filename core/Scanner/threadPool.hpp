@@ -0,0 +1,83 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Счётчик задач одного вызывающего, которого можно дождаться отдельно от остальных
+ *
+ * Пул общий для нескольких клиентов, поэтому каждый проход ждёт только свои задачи
+ * через ThreadPool::wait(TaskGroup&), а не опустения всей очереди
+ */
+class TaskGroup
+{
+public:
+    TaskGroup() = default;
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+private:
+    friend class ThreadPool;
+
+    std::mutex mutex{};
+    std::condition_variable finished{};
+    size_t pending = 0;
+};
+
+/**
+ * @brief Пул рабочих потоков с общей очередью задач
+ *
+ * Потоки создаются один раз и переиспользуются между сканированиями,
+ * чтобы не платить за создание потоков на каждый проход
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Ставит задачу в очередь
+     *
+     * @param task задача, которую выполнит первый свободный поток
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Ставит задачу группы в очередь
+     *
+     * @param task задача
+     * @param group группа, живёт до wait(group)
+     */
+    void submit(std::function<void()> task, TaskGroup& group);
+
+    /**
+     * @brief Блокирует вызывающий поток, пока очередь не опустеет и все задачи не завершатся
+     *
+     * Ждёт и чужие задачи; если пулом пользуются несколько потоков, нужен wait(TaskGroup&)
+     */
+    void wait();
+
+    /// @brief Блокирует вызывающий поток, пока не завершатся все задачи группы
+    void wait(TaskGroup& group);
+
+    [[nodiscard]] size_t size() const noexcept;
+
+private:
+    void workerLoop(std::stop_token stop);
+
+    std::vector<std::jthread> workers{};
+    std::queue<std::function<void()>> tasks{};
+    std::mutex mutex{};
+    std::condition_variable_any taskReady{};
+    std::condition_variable idle{};
+    size_t active = 0;
+};
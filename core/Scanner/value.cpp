@@ -1,6 +1,177 @@
 #include "value.hpp"
+#include <algorithm>
+#include <charconv>
 #include <cstring>
 
+namespace
+{
+    template <typename T>
+    constexpr bool isText = std::is_same_v<T, TextPattern>;
+
+    constexpr bool isUpper(uint8_t c) noexcept
+    {
+        return c >= 'A' && c <= 'Z';
+    }
+
+    /**
+     * @brief Приводит латинские буквы строки к нижнему регистру
+     *
+     * В UTF-16LE меняется только младший байт символов со старшим нулевым байтом,
+     * чтобы не задеть другие символы с тем же младшим байтом
+     */
+    void foldCase(std::vector<std::byte>& bytes, TextEncoding encoding) noexcept
+    {
+        size_t unit = encoding == TextEncoding::Utf16Le ? 2 : 1;
+
+        for(size_t i = 0; i + unit <= bytes.size(); i += unit)
+        {
+            auto c = static_cast<uint8_t>(bytes[i]);
+
+            if(isUpper(c) && (unit == 1 || bytes[i + 1] == std::byte{0}))
+                bytes[i] = static_cast<std::byte>(c | 0x20);
+        }
+    }
+
+    bool matchText(const TextPattern& pattern, std::span<const std::byte> memory) noexcept
+    {
+        const auto& bytes = pattern.bytes;
+
+        if(memory.size() < bytes.size())
+            return false;
+
+        if(!pattern.ignoreCase)
+            return std::memcmp(memory.data(), bytes.data(), bytes.size()) == 0;
+
+        bool wide = pattern.encoding == TextEncoding::Utf16Le;
+
+        for(size_t i = 0; i < bytes.size(); ++i)
+        {
+            auto m = static_cast<uint8_t>(memory[i]);
+            auto p = static_cast<uint8_t>(bytes[i]);
+
+            // буква образца в нижнем регистре, '|0x20' совпадает с ней только у той же буквы в любом регистре
+            bool letter = p >= 'a' && p <= 'z' && (!wide || (i % 2 == 0 && bytes[i + 1] == std::byte{0}));
+
+            if(letter ? (m | 0x20) != p : m != p)
+                return false;
+        }
+        return true;
+    }
+
+    /// @brief Декодирует UTF-8 в кодовые точки, false при некорректной последовательности
+    bool decodeUtf8(std::string_view text, std::vector<char32_t>& out)
+    {
+        for(size_t i = 0; i < text.size();)
+        {
+            auto c = static_cast<uint8_t>(text[i]);
+            size_t length = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 0;
+
+            if(length == 0 || i + length > text.size())
+                return false;
+
+            char32_t cp = length == 1 ? c : c & (0x7f >> length);
+
+            for(size_t k = 1; k < length; ++k)
+            {
+                auto next = static_cast<uint8_t>(text[i + k]);
+
+                if((next & 0xc0) != 0x80)
+                    return false;
+
+                cp = (cp << 6) | (next & 0x3f);
+            }
+
+            if(cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+                return false;
+
+            out.push_back(cp);
+            i += length;
+        }
+        return true;
+    }
+
+    char* encodeUtf8(char32_t cp, char* out) noexcept
+    {
+        if(cp < 0x80)
+        {
+            *out++ = static_cast<char>(cp);
+        }
+        else if(cp < 0x800)
+        {
+            *out++ = static_cast<char>(0xc0 | (cp >> 6));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+        }
+        else if(cp < 0x10000)
+        {
+            *out++ = static_cast<char>(0xe0 | (cp >> 12));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+        }
+        else
+        {
+            *out++ = static_cast<char>(0xf0 | (cp >> 18));
+            *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+        }
+        return out;
+    }
+
+    /**
+     * @brief Выводит строку из памяти в UTF-8
+     *
+     * UTF-8 копируется как есть, UTF-16LE перекодируется (непарные суррогаты -- '?'),
+     * управляющие символы заменяются на '.'. Вывод обрезается по last
+     */
+    char* formatText(const TextPattern& pattern, std::span<const std::byte> memory, char* first, char* last) noexcept
+    {
+        size_t length = std::min(memory.size(), pattern.bytes.size());
+        char* out = first;
+
+        auto put = [&](char32_t cp)
+        {
+            if(cp < 0x20 || cp == 0x7f)
+                cp = '.';
+
+            if(last - out < 4)
+                return false;
+
+            out = encodeUtf8(cp, out);
+            return true;
+        };
+
+        if(pattern.encoding == TextEncoding::Utf8)
+        {
+            for(size_t i = 0; i < length && out < last; ++i)
+            {
+                auto c = static_cast<uint8_t>(memory[i]);
+                *out++ = c < 0x20 || c == 0x7f ? '.' : static_cast<char>(c);
+            }
+            return out;
+        }
+
+        for(size_t i = 0; i + 2 <= length; i += 2)
+        {
+            char32_t unit = static_cast<uint8_t>(memory[i]) | (static_cast<uint8_t>(memory[i + 1]) << 8);
+
+            if(unit >= 0xd800 && unit <= 0xdbff && i + 4 <= length)
+            {
+                char32_t low = static_cast<uint8_t>(memory[i + 2]) | (static_cast<uint8_t>(memory[i + 3]) << 8);
+
+                if(low >= 0xdc00 && low <= 0xdfff)
+                {
+                    if(!put(0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00))) break;
+                    i += 2;
+                    continue;
+                }
+            }
+
+            if(!put(unit >= 0xd800 && unit <= 0xdfff ? U'?' : unit)) break;
+        }
+        return out;
+    }
+}
+
 /**
  * @brief Возвращает размер  текущего хранимого типа в байтах
  * 
@@ -10,7 +181,16 @@
  */
 size_t Value::size() const noexcept
 {
-    return std::visit([](auto&& arg) noexcept { return sizeof(arg); }, value);
+    return std::visit([](auto&& arg) noexcept -> size_t
+    {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr(isText<T>)
+            return arg.bytes.size();
+        else
+            return sizeof(arg);
+
+    }, value);
 }
 
 /**
@@ -30,14 +210,330 @@ bool Value::match(std::span<const std::byte> memory, double epsilon) const
     {
         using T = std::decay_t<decltype(arg)>;
 
-        T memValue;
-        std::memcpy(&memValue, memory.data(), sizeof(T));
+        if constexpr(isText<T>)
+        {
+            return matchText(arg, memory);
+        }
+        else
+        {
+            T memValue;
+            std::memcpy(&memValue, memory.data(), sizeof(T));
+
+            if constexpr(std::is_floating_point_v<T>)
+                return std::abs(memValue - arg) < static_cast<T>(epsilon);
+
+            else
+                return memValue == arg;
+        }
+
+    }, value);
+}
+
+/**
+ * @brief Сравнивает два значения хранимого типа
+ * 
+ * Байты интерпретируются как тип, который сейчас хранится в Value,
+ * само хранимое значение в сравнении не участвует
+ * 
+ * @param lhs байты первого значения
+ * @param rhs байты второго значения
+ * @return int -1, 0 или 1
+ */
+int Value::compare(std::span<const std::byte> lhs, std::span<const std::byte> rhs) const
+{
+    return std::visit([&](auto&& arg) -> int
+    {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr(isText<T>)
+        {
+            int order = std::memcmp(lhs.data(), rhs.data(), arg.bytes.size());
+            return (order > 0) - (order < 0);
+        }
+        else
+        {
+            T left, right;
+            std::memcpy(&left, lhs.data(), sizeof(T));
+            std::memcpy(&right, rhs.data(), sizeof(T));
+
+            return (left > right) - (left < right);
+        }
+
+    }, value);
+}
+
+/**
+ * @brief Создаёт значение того же типа из байтов памяти
+ * 
+ * @param memory байты значения
+ * @return Value значение того же типа, что и хранимое
+ */
+Value Value::fromMemory(std::span<const std::byte> memory) const
+{
+    return std::visit([&](auto&& arg) -> Value
+    {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr(isText<T>)
+        {
+            TextPattern pattern{{memory.begin(), memory.begin() + arg.bytes.size()}, arg.encoding, arg.ignoreCase};
+
+            if(pattern.ignoreCase)
+                foldCase(pattern.bytes, pattern.encoding);
+
+            return Value(std::move(pattern));
+        }
+        else
+        {
+            T result;
+            std::memcpy(&result, memory.data(), sizeof(T));
+
+            return Value(result);
+        }
+
+    }, value);
+}
+
+Value::ValueType Value::type() const noexcept
+{
+    if(const auto* pattern = textPattern())
+    {
+        if(pattern->encoding == TextEncoding::Utf16Le)
+            return pattern->ignoreCase ? ValueType::WideStringNoCase : ValueType::WideString;
+
+        return pattern->ignoreCase ? ValueType::StringNoCase : ValueType::String;
+    }
+
+    return static_cast<ValueType>(value.index());
+}
+
+const TextPattern* Value::textPattern() const noexcept
+{
+    return std::get_if<TextPattern>(&value);
+}
+
+/**
+ * @brief Кодирует строку для поиска в памяти
+ *
+ * UTF-16LE строится из кодовых точек UTF-8, символы вне BMP -- суррогатной парой
+ */
+std::expected<Value, ValueError> Value::text(std::string_view utf8, TextEncoding encoding, bool ignoreCase)
+{
+    std::vector<char32_t> codePoints{};
+
+    if(utf8.empty() || !decodeUtf8(utf8, codePoints))
+        return std::unexpected{ValueError::InvalidFormat};
+
+    TextPattern pattern{{}, encoding, ignoreCase};
+
+    if(encoding == TextEncoding::Utf8)
+    {
+        pattern.bytes.resize(utf8.size());
+        std::memcpy(pattern.bytes.data(), utf8.data(), utf8.size());
+    }
+    else
+    {
+        auto putUnit = [&](char32_t unit)
+        {
+            pattern.bytes.push_back(static_cast<std::byte>(unit & 0xff));
+            pattern.bytes.push_back(static_cast<std::byte>(unit >> 8));
+        };
+
+        for(char32_t cp : codePoints)
+        {
+            if(cp >= 0x10000)
+            {
+                putUnit(0xd800 + ((cp - 0x10000) >> 10));
+                putUnit(0xdc00 + ((cp - 0x10000) & 0x3ff));
+            }
+            else
+            {
+                putUnit(cp);
+            }
+        }
+    }
+
+    if(pattern.bytes.size() > maxTextLength)
+        return std::unexpected{ValueError::TooLong};
+
+    if(ignoreCase)
+        foldCase(pattern.bytes, encoding);
+
+    return Value(std::move(pattern));
+}
+
+namespace
+{
+    constexpr std::string_view typeNames[] =
+    {
+        "i8", "u8", "i16", "u16", "i32", "u32", "i64", "u64", "f32", "f64",
+        "str", "istr", "wstr", "iwstr"
+    };
+
+    template <typename T>
+    std::expected<Value, ValueError> bytesAs(std::span<const std::byte> memory)
+    {
+        if(memory.size() < sizeof(T))
+            return std::unexpected{ValueError::InvalidFormat};
+
+        T result;
+        std::memcpy(&result, memory.data(), sizeof(T));
+
+        return Value(result);
+    }
+}
+
+std::expected<Value::ValueType, ValueError> Value::typeFromName(std::string_view name)
+{
+    for(size_t i = 0; i < std::size(typeNames); ++i)
+    {
+        if(typeNames[i] == name)
+            return static_cast<ValueType>(i);
+    }
+
+    return std::unexpected{ValueError::InvalidType};
+}
+
+std::string_view Value::typeName(ValueType type) noexcept
+{
+    auto index = static_cast<size_t>(type);
+
+    return index < std::size(typeNames) ? typeNames[index] : std::string_view{};
+}
+
+std::expected<Value, ValueError> Value::fromBytes(ValueType type, std::span<const std::byte> memory)
+{
+    switch (type)
+    {
+        case ValueType::Int8: return bytesAs<int8_t>(memory);
+        case ValueType::UInt8: return bytesAs<uint8_t>(memory);
+        case ValueType::Int16: return bytesAs<int16_t>(memory);
+        case ValueType::UInt16: return bytesAs<uint16_t>(memory);
+        case ValueType::Int32: return bytesAs<int32_t>(memory);
+        case ValueType::UInt32: return bytesAs<uint32_t>(memory);
+        case ValueType::Int64: return bytesAs<int64_t>(memory);
+        case ValueType::UInt64: return bytesAs<uint64_t>(memory);
+        case ValueType::Float: return bytesAs<float>(memory);
+        case ValueType::Double: return bytesAs<double>(memory);
+        case ValueType::String:
+        case ValueType::StringNoCase:
+        case ValueType::WideString:
+        case ValueType::WideStringNoCase:
+        {
+            if(memory.empty())
+                return std::unexpected{ValueError::InvalidFormat};
+
+            if(memory.size() > maxTextLength)
+                return std::unexpected{ValueError::TooLong};
+
+            bool wide = type == ValueType::WideString || type == ValueType::WideStringNoCase;
+            bool ignoreCase = type == ValueType::StringNoCase || type == ValueType::WideStringNoCase;
+
+            TextPattern pattern{{memory.begin(), memory.end()}, wide ? TextEncoding::Utf16Le : TextEncoding::Utf8, ignoreCase};
+
+            if(ignoreCase)
+                foldCase(pattern.bytes, pattern.encoding);
+
+            return Value(std::move(pattern));
+        }
+    }
+    return std::unexpected{ValueError::InvalidType};
+}
+
+namespace
+{
+    template <typename T>
+    std::expected<Value, ValueError> parseAs(std::string_view text)
+    {
+        T result{};
+        int base = 10;
+
+        if constexpr(std::is_integral_v<T>)
+        {
+            if(text.starts_with("0x") || text.starts_with("0X"))
+            {
+                text.remove_prefix(2);
+                base = 16;
+            }
+        }
+
+        std::from_chars_result parsed{};
+
+        if constexpr(std::is_integral_v<T>)
+            parsed = std::from_chars(text.data(), text.data() + text.size(), result, base);
+        else
+            parsed = std::from_chars(text.data(), text.data() + text.size(), result);
+
+        if(parsed.ec != std::errc{} || parsed.ptr != text.data() + text.size())
+            return std::unexpected{ValueError::InvalidFormat};
+
+        return Value(result);
+    }
+}
+
+/**
+ * @brief Разбирает текст как число указаного типа
+ * 
+ * @param type тип значения
+ * @param text текст числа, для целых допускается 0x
+ * @return std::expected<Value, ValueError> значение при успехе
+ * @retval ValueError::InvalidFormat если текст не число или выходит за диапазон типа
+ */
+std::expected<Value, ValueError> Value::parse(ValueType type, std::string_view text)
+{
+    switch (type)
+    {
+        case ValueType::Int8: return parseAs<int8_t>(text);
+        case ValueType::UInt8: return parseAs<uint8_t>(text);
+        case ValueType::Int16: return parseAs<int16_t>(text);
+        case ValueType::UInt16: return parseAs<uint16_t>(text);
+        case ValueType::Int32: return parseAs<int32_t>(text);
+        case ValueType::UInt32: return parseAs<uint32_t>(text);
+        case ValueType::Int64: return parseAs<int64_t>(text);
+        case ValueType::UInt64: return parseAs<uint64_t>(text);
+        case ValueType::Float: return parseAs<float>(text);
+        case ValueType::Double: return parseAs<double>(text);
+        case ValueType::String: return Value::text(text, TextEncoding::Utf8);
+        case ValueType::StringNoCase: return Value::text(text, TextEncoding::Utf8, true);
+        case ValueType::WideString: return Value::text(text, TextEncoding::Utf16Le);
+        case ValueType::WideStringNoCase: return Value::text(text, TextEncoding::Utf16Le, true);
+    }
+    return std::unexpected{ValueError::InvalidType};
+}
+
+char* Value::format(std::span<const std::byte> memory, char* first, char* last) const
+{
+    return std::visit([&](auto&& arg) -> char*
+    {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr(isText<T>)
+        {
+            return formatText(arg, memory, first, last);
+        }
+        else
+        {
+            T memValue;
+            std::memcpy(&memValue, memory.data(), sizeof(T));
+
+            auto [ptr, ec] = std::to_chars(first, last, memValue);
+
+            return ec == std::errc{} ? ptr : first;
+        }
+
+    }, value);
+}
 
-        if constexpr(std::is_floating_point_v<T>)
-            return std::abs(memValue - arg) < static_cast<T>(epsilon);
+void Value::store(std::byte* out) const noexcept
+{
+    std::visit([&](auto&& arg) noexcept
+    {
+        using T = std::decay_t<decltype(arg)>;
 
+        if constexpr(isText<T>)
+            std::memcpy(out, arg.bytes.data(), arg.bytes.size());
         else
-            return memValue == arg;
+            std::memcpy(out, &arg, sizeof(arg));
 
     }, value);
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 #include <variant>
 #include <cstdint>
 #include <cmath>
+#include <expected>
 #include <span>
+#include <string_view>
+#include <vector>
 
 /**
  * @brief Ограничивает допустимые типы данных для сканирования 
@@ -18,6 +21,56 @@ concept ValidValueType =std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>
                         std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t> || 
                         std::is_same_v<T, float> || std::is_same_v< T, double>;
 
+/**
+ * @brief Кодировка искомой строки
+ */
+enum class TextEncoding : uint8_t
+{
+    Utf8,
+    Utf16Le
+};
+
+/**
+ * @brief Искомая строка в байтах памяти
+ *
+ * bytes -- строка в кодировке encoding без завершающего нуля,
+ * при ignoreCase латинские буквы хранятся в нижнем регистре
+ */
+struct TextPattern
+{
+    std::vector<std::byte> bytes{};
+    TextEncoding encoding = TextEncoding::Utf8;
+    bool ignoreCase = false;
+
+    /// @brief Шаг, с которым строки этой кодировки лежат в памяти
+    [[nodiscard]] size_t alignment() const noexcept
+    {
+        return encoding == TextEncoding::Utf16Le ? 2 : 1;
+    }
+
+    /**
+     * @brief Смещение второго байта для предфильтра
+     *
+     * Для UTF-16LE берётся младший байт последнего символа: старший у латиницы нулевой
+     * и почти ничего не отсекает
+     */
+    [[nodiscard]] size_t lastProbe() const noexcept
+    {
+        return encoding == TextEncoding::Utf16Le && bytes.size() >= 2 ? bytes.size() - 2 : bytes.size() - 1;
+    }
+};
+
+/**
+ * @brief Ошибки разбора значения из текста
+ * 
+ */
+enum class ValueError
+{
+    InvalidType, // неизвестное имя типа
+    InvalidFormat, // текст не является числом этого типа
+    TooLong // строка длиннее Value::maxTextLength байт
+};
+
 /**
  * @brief 
  * 
@@ -31,9 +84,14 @@ public:
         Int16, UInt16,
         Int32, UInt32,
         Int64, UInt64,
-        Float, Double
+        Float, Double,
+        String, StringNoCase,
+        WideString, WideStringNoCase
     };
 
+    /// Максимальная длина искомой строки в байтах после кодирования
+    static constexpr size_t maxTextLength = 256;
+
     /**
     * @brief набор поддеживаемых типов данных
     * 
@@ -43,7 +101,8 @@ public:
         int16_t, uint16_t, 
         int32_t, uint32_t, 
         int64_t, uint64_t, 
-        float, double
+        float, double,
+        TextPattern
     >;
 
     template<ValidValueType T>
@@ -54,13 +113,79 @@ public:
     template<ValidValueType T>
     explicit Value(T val) : value(val) {}
 
+    /**
+     * @brief Создаёт значение-строку
+     *
+     * @param utf8 строка в UTF-8
+     * @param encoding в какой кодировке искать строку в памяти
+     * @param ignoreCase не различать регистр латинских букв
+     * @return std::expected<Value, ValueError> значение-строка
+     * @retval ValueError::InvalidFormat если строка пустая или не является корректным UTF-8
+     * @retval ValueError::TooLong если закодированная строка длиннее maxTextLength
+     */
+    static std::expected<Value, ValueError> text(std::string_view utf8, TextEncoding encoding, bool ignoreCase = false);
+
     size_t size() const noexcept;
 
+    /// @brief Тип хранимого значения
+    ValueType type() const noexcept;
+
+    /// @brief Искомая строка или nullptr, если значение числовое
+    const TextPattern* textPattern() const noexcept;
+
+    /**
+     * @brief Тип по короткому имени: i8, u8, i16, u16, i32, u32, i64, u64, f32, f64,
+     * str, istr (UTF-8), wstr, iwstr (UTF-16LE), префикс i -- без учёта регистра
+     * 
+     * @retval ValueError::InvalidType если имя не известно
+     */
+    static std::expected<ValueType, ValueError> typeFromName(std::string_view name);
+
+    /// @brief Короткое имя типа, обратное typeFromName()
+    static std::string_view typeName(ValueType type) noexcept;
+
+    /**
+     * @brief Создаёт значение указаного типа из байтов памяти
+     *
+     * Для строковых типов длина строки -- весь memory
+     *
+     * @retval ValueError::InvalidFormat если байтов меньше размера типа или строка пустая
+     * @retval ValueError::TooLong если строка длиннее maxTextLength
+     */
+    static std::expected<Value, ValueError> fromBytes(ValueType type, std::span<const std::byte> memory);
+
+    /**
+     * @brief Разбирает текст как число указаного типа
+     * 
+     * Целые числа допускают префикс 0x, для строковых типов текст берётся как есть
+     * 
+     * @param type тип значения
+     * @param text текст числа
+     * @return std::expected<Value, ValueError> значение или InvalidFormat
+     */
+    static std::expected<Value, ValueError> parse(ValueType type, std::string_view text);
+
+    /**
+     * @brief Форматирует байты памяти как число хранимого типа
+     *
+     * Строки выводятся в UTF-8, управляющие символы заменяются на '.'
+     * 
+     * @param memory байты значения
+     * @param first начало буфера вывода
+     * @param last конец буфера вывода
+     * @return char* позиция за последним записаным символом
+     */
+    char* format(std::span<const std::byte> memory, char* first, char* last) const;
+
+    /// @brief Копирует байты хранимого значения в out (size() байт)
+    void store(std::byte* out) const noexcept;
+
     /**
      * @brief Сравнивает хранимое значение с байтами по указаному адрессу
      * 
      * Метод сам учитывает тип данных. Для целых чисел выполняется точное сравнение,
-     * Для чисел с плавающей точкой -- сравнение с учетом погрешности
+     * Для чисел с плавающей точкой -- сравнение с учетом погрешности,
+     * для строк -- побайтовое сравнение всей строки с учётом ignoreCase
      * 
      * @param memory Указатель на начало адресса участка памяти для проверки
      * @param epsilon Допустимая погрешность для float and double
@@ -69,6 +194,25 @@ public:
      */
     bool match(std::span<const std::byte> memory, double epsilon = 1e-6) const;
 
+    /**
+     * @brief Сравнивает два значения хранимого типа, прочитанные из памяти
+     * 
+     * @param lhs байты первого значения
+     * @param rhs байты второго значения
+     * @return int отрицательное если lhs < rhs, 0 если равны, положительное если lhs > rhs
+     */
+    int compare(std::span<const std::byte> lhs, std::span<const std::byte> rhs) const;
+
+    /**
+     * @brief Создаёт значение того же типа из байтов памяти
+     * 
+     * @param memory байты значения, не меньше size()
+     * @return Value значение того же типа
+     */
+    Value fromMemory(std::span<const std::byte> memory) const;
+
 private:
+    explicit Value(TextPattern pattern) : value(std::move(pattern)) {}
+
     ValueVariant value;
 };
\ No newline at end of file
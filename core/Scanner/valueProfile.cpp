@@ -0,0 +1,195 @@
+#include "valueProfile.hpp"
+#include <algorithm>
+#include <cstring>
+
+ValueProfile::ValueProfile(size_t step, size_t total) noexcept : slotStep(step == 0 ? 1 : step), total(total) {}
+
+std::expected<ValueProfile, ScanError> ValueProfile::sample
+(
+    const std::vector<MemoryRegion>& regions,
+    Memory& memory,
+    size_t step,
+    size_t sampleBytes
+)
+{
+    size_t total = 0;
+
+    for(const auto& reg : regions)
+        total += reg.size();
+
+    if(total == 0)
+        return std::unexpected{ScanError::InvalidRegion};
+
+    ValueProfile profile(step, total);
+    std::vector<MemorySpan> spans{};
+
+    if(total <= sampleBytes)
+    {
+        // весь объём влезает в бюджет -- выборка совпадает с полным сканированием
+        for(const auto& reg : regions)
+        {
+            for(uintptr_t pos = reg.start; pos < reg.end; pos += window)
+                spans.push_back({pos, std::min(window, reg.end - pos)});
+        }
+    }
+    else
+    {
+        size_t count = std::max<size_t>(1, sampleBytes / window);
+        size_t stride = total / count;
+
+        auto reg = regions.begin();
+        size_t regionBase = 0; // смещение начала reg в сквозной нумерации байтов всех регионов
+
+        for(size_t k = 0; k < count; ++k)
+        {
+            // окно берётся из середины своего промежутка
+            size_t target = k * stride + stride / 2;
+
+            while(reg != regions.end() && regionBase + reg->size() <= target)
+            {
+                regionBase += reg->size();
+                ++reg;
+            }
+
+            if(reg == regions.end())
+                break;
+
+            uintptr_t address = reg->start + ((target - regionBase) & ~(window - 1));
+            spans.push_back({address, std::min(window, reg->end - address)});
+        }
+    }
+
+    std::vector<uint8_t> valid(spans.size(), 0);
+    size_t bytes = 0;
+
+    for(const auto& span : spans)
+        bytes += span.size;
+
+    profile.data.resize(bytes);
+
+    if(auto read = memory.readScatter(spans, profile.data.data(), valid.data()); !read)
+        return std::unexpected{ScanError::ReadError};
+
+    // не прочитанные окна (регион снят) выбрасываются, прочитанные сдвигаются к началу
+    size_t from = 0;
+    size_t to = 0;
+
+    for(size_t i = 0; i < spans.size(); ++i)
+    {
+        if(valid[i])
+        {
+            std::memmove(profile.data.data() + to, profile.data.data() + from, spans[i].size);
+            profile.windows.push_back({spans[i].address, to, spans[i].size});
+            to += spans[i].size;
+        }
+        from += spans[i].size;
+    }
+
+    profile.data.resize(to);
+
+    if(profile.windows.empty())
+        return std::unexpected{ScanError::ReadError};
+
+    return profile;
+}
+
+SelectivityEstimate ValueProfile::estimate(const Scanner& scanner, const Value& value) const
+{
+    SelectivityEstimate result{};
+    size_t valSize = value.size();
+
+    for(const auto& window : windows)
+    {
+        std::span<const std::byte> bytes(data.data() + window.offset, window.size);
+
+        if(window.size >= valSize)
+            result.sampledSlots += (window.size - valSize) / slotStep + 1;
+
+        scanner.findMatches(value, window.address, bytes, [&](uintptr_t, auto) { result.matches++; });
+    }
+
+    if(result.sampledSlots == 0)
+        return result;
+
+    result.selectivity = static_cast<double>(result.matches) / static_cast<double>(result.sampledSlots);
+    result.projectedHits = static_cast<size_t>(result.selectivity * static_cast<double>(total / slotStep));
+    result.layout = layoutFor(result.selectivity, valSize);
+
+    return result;
+}
+
+std::vector<ValueCount> ValueProfile::histogram(Value::ValueType type, size_t top) const
+{
+    std::vector<ValueCount> result{};
+
+    auto proto = Value::parse(type, "0");
+
+    if(!proto || proto->textPattern() || top == 0)
+        return result;
+
+    size_t valSize = std::min(proto->size(), sizeof(uint64_t));
+    std::vector<uint64_t> raw{};
+    raw.reserve(data.size() / slotStep);
+
+    for(const auto& window : windows)
+    {
+        for(size_t pos = 0; pos + valSize <= window.size; pos += slotStep)
+        {
+            uint64_t slot = 0;
+            std::memcpy(&slot, data.data() + window.offset + pos, valSize);
+            raw.push_back(slot);
+        }
+    }
+
+    if(raw.empty())
+        return result;
+
+    std::ranges::sort(raw);
+
+    // серии одинаковых значений после сортировки: (значение, сколько раз)
+    std::vector<std::pair<uint64_t, size_t>> runs{};
+
+    for(size_t i = 0; i < raw.size();)
+    {
+        size_t j = i;
+
+        while(j < raw.size() && raw[j] == raw[i])
+            ++j;
+
+        runs.push_back({raw[i], j - i});
+        i = j;
+    }
+
+    size_t shown = std::min(top, runs.size());
+
+    std::partial_sort(runs.begin(), runs.begin() + static_cast<ptrdiff_t>(shown), runs.end(),
+        [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    for(size_t i = 0; i < shown; ++i)
+    {
+        auto value = proto->fromMemory(std::as_bytes(std::span(&runs[i].first, 1)));
+        result.push_back({std::move(value), runs[i].second, static_cast<double>(runs[i].second) / static_cast<double>(raw.size())});
+    }
+
+    return result;
+}
+
+ResultLayout ValueProfile::layoutFor(double selectivity, size_t valueSize) noexcept
+{
+    return ScanSessions::prefersBitmap(selectivity, valueSize) ? ResultLayout::Bitmap : ResultLayout::Addresses;
+}
+
+size_t ValueProfile::totalBytes() const noexcept
+{
+    return total;
+}
+
+size_t ValueProfile::sampledBytes() const noexcept
+{
+    return data.size();
+}
+
+size_t ValueProfile::step() const noexcept
+{
+    return slotStep;
+}
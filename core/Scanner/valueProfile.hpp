@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <vector>
+
+#include "../Process/MemoryReader.hpp"
+#include "../Process/ModuleMapParser.hpp"
+#include "scanner.hpp"
+#include "value.hpp"
+
+/**
+ * @brief Как хранить результаты первого сканирования
+ *
+ * Addresses -- список адрес + байты значения, Bitmap -- бит на выровненный слот региона
+ */
+enum class ResultLayout
+{
+    Addresses,
+    Bitmap
+};
+
+/**
+ * @brief Оценка числа совпадений значения до полного сканирования
+ *
+ * selectivity -- доля выровненных слотов выборки, где значение совпало
+ * projectedHits -- selectivity, перенесённая на все слоты регионов
+ * layout -- что дешевле хранить при такой плотности
+ */
+struct SelectivityEstimate
+{
+    size_t sampledSlots = 0;
+    size_t matches = 0;
+    double selectivity = 0.0;
+    size_t projectedHits = 0;
+    ResultLayout layout = ResultLayout::Addresses;
+};
+
+/**
+ * @brief Частое значение в выборке
+ */
+struct ValueCount
+{
+    Value value;
+    size_t count;
+    double share; // доля слотов выборки
+};
+
+/**
+ * @brief Выборка памяти процесса для оценки распределения значений
+ *
+ * Из регионов читаются окна по window байт через равные промежутки по всему
+ * суммарному объёму (strided sampling), всего не больше sampleBytes. Окна читаются
+ * пачками через Memory::readScatter и хранятся целиком, поэтому оценка для Value
+ * идёт тем же Scanner::findMatches, что и сканирование: с той же погрешностью float,
+ * шагом выравнивания и правилами строк. Если регионы меньше бюджета, читаются целиком
+ * и оценка точная
+ */
+class ValueProfile
+{
+public:
+    /// Размер одного окна выборки
+    static constexpr size_t window = 4096;
+
+    /**
+     * @brief Читает выборку из регионов
+     *
+     * @param regions отфильтрованные регионы процесса
+     * @param memory память процесса
+     * @param step шаг выравнивания слотов, как у сканера
+     * @param sampleBytes бюджет выборки
+     * @return std::expected<ValueProfile, ScanError> выборка
+     * @retval ScanError::InvalidRegion если регионы пусты
+     * @retval ScanError::ReadError если не прочиталось ни одного окна
+     */
+    static std::expected<ValueProfile, ScanError> sample
+    (
+        const std::vector<MemoryRegion>& regions,
+        Memory& memory,
+        size_t step,
+        size_t sampleBytes = 4 * 1024 * 1024
+    );
+
+    /**
+     * @brief Доля совпадений value в выборке и прогноз на все регионы
+     *
+     * @param scanner сканер с тем же выравниванием, что и у выборки
+     */
+    [[nodiscard]] SelectivityEstimate estimate(const Scanner& scanner, const Value& value) const;
+
+    /**
+     * @brief Самые частые значения числового типа в выборке
+     *
+     * @param type тип, байты каждого слота читаются как число этого типа; строки не поддерживаются
+     * @param top сколько значений вернуть
+     * @return std::vector<ValueCount> по убыванию частоты, пусто для строковых типов
+     */
+    [[nodiscard]] std::vector<ValueCount> histogram(Value::ValueType type, size_t top) const;
+
+    /// @brief Что дешевле хранить при доле совпадений selectivity, по правилу ScanSessions::prefersBitmap()
+    [[nodiscard]] static ResultLayout layoutFor(double selectivity, size_t valueSize) noexcept;
+
+    [[nodiscard]] size_t totalBytes() const noexcept;
+    [[nodiscard]] size_t sampledBytes() const noexcept;
+    [[nodiscard]] size_t step() const noexcept;
+
+private:
+    ValueProfile(size_t step, size_t total) noexcept;
+
+    /// @brief Прочитанное окно: адрес и смещение его байтов в data
+    struct Window
+    {
+        uintptr_t address;
+        size_t offset;
+        size_t size;
+    };
+
+    size_t slotStep;
+    size_t total; // байт во всех регионах
+    std::vector<Window> windows{};
+    std::vector<std::byte> data{};
+};
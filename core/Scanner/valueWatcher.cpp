@@ -0,0 +1,314 @@
+#include "valueWatcher.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+    /// Адреса с промежутком не больше этого читаются одним участком
+    constexpr size_t mergeGap = 512;
+}
+
+ValueWatcher::ValueWatcher(Memory mem, const Value& type, size_t history)
+    : mem(std::move(mem)), type(type), valSize(type.size()),
+      capacity(history == 0 ? 1 : history), origin(std::chrono::steady_clock::now()) {}
+
+ValueWatcher::~ValueWatcher()
+{
+    stop();
+}
+
+size_t ValueWatcher::watch(uintptr_t address)
+{
+    std::lock_guard lock(mutex);
+
+    addresses.push_back(address);
+    layoutDirty = true;
+    ringTimes.resize(addresses.size() * capacity);
+    ringValues.resize(addresses.size() * capacity * valSize);
+    heads.push_back(0);
+    counts.push_back(0);
+    minRaw.resize(addresses.size() * valSize);
+    maxRaw.resize(addresses.size() * valSize);
+
+    return addresses.size() - 1;
+}
+
+void ValueWatcher::watch(std::span<const ScanResult> results)
+{
+    for(const auto& result : results)
+        watch(result.address);
+}
+
+void ValueWatcher::clear()
+{
+    std::lock_guard lock(mutex);
+
+    addresses.clear();
+    layoutDirty = true;
+    ringTimes.clear();
+    ringValues.clear();
+    heads.clear();
+    counts.clear();
+    minRaw.clear();
+    maxRaw.clear();
+}
+
+/**
+ * @brief Читает все адреса одним проходом и записывает изменившиеся значения
+ *
+ * Адреса не прочитанного участка дочитываются по одному, адреса, которые
+ * не читаются и так (регион освобождён), пропускаются без записи в историю.
+ * Обработчик изменений копируется под блокировкой и вызывается уже после её снятия
+ *
+ * @return std::expected<size_t, MemoryError> сколько значений изменилось
+ * @retval ошибка readScatter() если pid не инициализирован
+ */
+std::expected<size_t, MemoryError> ValueWatcher::sampleOnce()
+{
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<WatchEvent> events{};
+    std::function<void(const WatchEvent&)> handler{};
+    size_t changed = 0;
+
+    {
+        std::lock_guard lock(mutex);
+
+        if(layoutDirty)
+            rebuildLayout();
+
+        auto read = mem.readScatter(spans, readBuffer.data(), spanValid.data());
+
+        if(!read)
+            return std::unexpected{read.error()};
+
+        handler = onChange;
+
+        uint64_t timeNs = static_cast<uint64_t>((begin - origin).count());
+
+        for(size_t i = 0; i < addresses.size(); ++i)
+        {
+            const std::byte* raw = readBuffer.data() + slotOffset[i];
+
+            if(!spanValid[slotSpan[i]])
+            {
+                // участок из одного адреса не прочитался целиком -- читать отдельно нечего
+                if(spanSlots[slotSpan[i]] < 2)
+                    continue;
+
+                auto single = mem.readBlock(addresses[i], valSize, readBuffer.data() + slotOffset[i]);
+
+                if(!single || *single < valSize)
+                    continue;
+            }
+
+            uint32_t count = counts[i];
+            std::byte* minBytes = minRaw.data() + i * valSize;
+            std::byte* maxBytes = maxRaw.data() + i * valSize;
+
+            if(count > 0)
+            {
+                const std::byte* previous = entryValue(i, (heads[i] + capacity - 1) % capacity);
+
+                if(std::memcmp(previous, raw, valSize) == 0) continue;
+
+                if(handler)
+                    events.push_back({i, addresses[i], std::chrono::nanoseconds(timeNs), decode(previous), decode(raw)});
+
+                if(compareRaw(raw, minBytes) < 0) std::memcpy(minBytes, raw, valSize);
+                if(compareRaw(raw, maxBytes) > 0) std::memcpy(maxBytes, raw, valSize);
+                ++changed;
+            }
+            else
+            {
+                std::memcpy(minBytes, raw, valSize);
+                std::memcpy(maxBytes, raw, valSize);
+            }
+
+            ringTimes[i * capacity + heads[i]] = timeNs;
+            std::memcpy(entryValue(i, heads[i]), raw, valSize);
+            heads[i] = static_cast<uint32_t>((heads[i] + 1) % capacity);
+            counts[i] = static_cast<uint32_t>(std::min<size_t>(count + 1, capacity));
+        }
+    }
+
+    for(const auto& event : events)
+        handler(event);
+
+    cycleNs.store((std::chrono::steady_clock::now() - begin).count(), std::memory_order_relaxed);
+
+    return changed;
+}
+
+/**
+ * @brief Склеивает отсортированные адреса в участки чтения
+ *
+ * Соседние адреса объединяются, если промежуток между ними не больше mergeGap,
+ * для каждого адреса запоминается участок и смещение его байтов в readBuffer
+ */
+void ValueWatcher::rebuildLayout()
+{
+    std::vector<size_t> order(addresses.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, {}, [&](size_t i) { return addresses[i]; });
+
+    spans.clear();
+    spanSlots.clear();
+    slotSpan.assign(addresses.size(), 0);
+    slotOffset.assign(addresses.size(), 0);
+
+    size_t bufferSize = 0;
+
+    for(size_t i : order)
+    {
+        uintptr_t addr = addresses[i];
+
+        if(spans.empty() || addr > spans.back().address + spans.back().size + mergeGap)
+        {
+            bufferSize += spans.empty() ? 0 : spans.back().size;
+            spans.push_back({addr, valSize});
+            spanSlots.push_back(0);
+        }
+        else
+        {
+            spans.back().size = std::max(spans.back().size, addr + valSize - spans.back().address);
+        }
+
+        slotSpan[i] = static_cast<uint32_t>(spans.size() - 1);
+        spanSlots.back()++;
+        slotOffset[i] = bufferSize + (addr - spans.back().address);
+    }
+
+    bufferSize += spans.empty() ? 0 : spans.back().size;
+
+    readBuffer.resize(bufferSize);
+    spanValid.assign(spans.size(), 0);
+    layoutDirty = false;
+}
+
+void ValueWatcher::start(std::chrono::microseconds period)
+{
+    stop();
+
+    sampler = std::jthread([this, period](std::stop_token stop)
+    {
+        auto next = std::chrono::steady_clock::now();
+
+        while(!stop.stop_requested())
+        {
+            (void)sampleOnce();
+
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+
+            // если выборка не успела за период, расписание сдвигается, а не догоняет
+            if(next < now)
+                next = now;
+            else
+                std::this_thread::sleep_until(next);
+        }
+    });
+}
+
+void ValueWatcher::stop()
+{
+    if(sampler.joinable())
+    {
+        sampler.request_stop();
+        sampler.join();
+    }
+}
+
+void ValueWatcher::setOnChange(std::function<void(const WatchEvent&)> callBack)
+{
+    std::lock_guard lock(mutex);
+    onChange = std::move(callBack);
+}
+
+size_t ValueWatcher::size() const
+{
+    std::lock_guard lock(mutex);
+    return addresses.size();
+}
+
+uintptr_t ValueWatcher::address(size_t index) const
+{
+    std::lock_guard lock(mutex);
+    return addresses.at(index);
+}
+
+std::optional<Value> ValueWatcher::last(size_t index) const
+{
+    std::lock_guard lock(mutex);
+
+    if(index >= addresses.size() || counts[index] == 0)
+        return std::nullopt;
+
+    return decode(entryValue(index, (heads[index] + capacity - 1) % capacity));
+}
+
+std::optional<Value> ValueWatcher::min(size_t index) const
+{
+    std::lock_guard lock(mutex);
+
+    if(index >= addresses.size() || counts[index] == 0)
+        return std::nullopt;
+
+    return decode(minRaw.data() + index * valSize);
+}
+
+std::optional<Value> ValueWatcher::max(size_t index) const
+{
+    std::lock_guard lock(mutex);
+
+    if(index >= addresses.size() || counts[index] == 0)
+        return std::nullopt;
+
+    return decode(maxRaw.data() + index * valSize);
+}
+
+std::vector<WatchPoint> ValueWatcher::history(size_t index) const
+{
+    std::lock_guard lock(mutex);
+    std::vector<WatchPoint> points{};
+
+    if(index >= addresses.size())
+        return points;
+
+    size_t count = counts[index];
+    size_t first = (heads[index] + capacity - count) % capacity;
+    points.reserve(count);
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        size_t k = (first + i) % capacity;
+        points.push_back({std::chrono::nanoseconds(ringTimes[index * capacity + k]), decode(entryValue(index, k))});
+    }
+
+    return points;
+}
+
+std::chrono::nanoseconds ValueWatcher::lastCycle() const noexcept
+{
+    return std::chrono::nanoseconds(cycleNs.load(std::memory_order_relaxed));
+}
+
+std::byte* ValueWatcher::entryValue(size_t index, size_t k) noexcept
+{
+    return ringValues.data() + (index * capacity + k) * valSize;
+}
+
+const std::byte* ValueWatcher::entryValue(size_t index, size_t k) const noexcept
+{
+    return ringValues.data() + (index * capacity + k) * valSize;
+}
+
+Value ValueWatcher::decode(const std::byte* raw) const
+{
+    return type.fromMemory(std::span(raw, valSize));
+}
+
+int ValueWatcher::compareRaw(const std::byte* lhs, const std::byte* rhs) const
+{
+    return type.compare(std::span(lhs, valSize), std::span(rhs, valSize));
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "../Process/MemoryReader.hpp"
+#include "scanSession.hpp"
+#include "value.hpp"
+
+/**
+ * @brief Изменение значения по наблюдаемому адресу
+ */
+struct WatchEvent
+{
+    size_t index;
+    uintptr_t address;
+    std::chrono::nanoseconds time; // от начала наблюдения
+    Value previous;
+    Value current;
+};
+
+/**
+ * @brief Точка истории: значение, которое появилось в момент time
+ */
+struct WatchPoint
+{
+    std::chrono::nanoseconds time;
+    Value value;
+};
+
+/**
+ * @brief Периодически читает набор адресов и хранит историю их значений
+ *
+ * Все адреса читаются одним проходом Memory::readScatter (пачки по IOV_MAX),
+ * близко лежащие адреса склеиваются в один участок, т.к. ядро платит
+ * за каждый iovec, а не за байты. Если склеенный участок не прочитался
+ * (задел неотображённую страницу), его адреса дочитываются по одному.
+ * В кольцевой буфер адреса пишется только момент изменения и новое значение,
+ * поэтому неизменные выборки памяти не занимают. Минимум и максимум
+ * поддерживаются на лету и отдаются за O(1).
+ */
+class ValueWatcher
+{
+public:
+    /**
+     * @param mem память наблюдаемого процесса
+     * @param type значение, задающее тип и размер наблюдаемых данных
+     * @param history сколько последних изменений хранить на адрес
+     */
+    ValueWatcher(Memory mem, const Value& type, size_t history = 64);
+    ~ValueWatcher();
+
+    ValueWatcher(const ValueWatcher&) = delete;
+    ValueWatcher& operator=(const ValueWatcher&) = delete;
+
+    /// @brief Добавляет адрес в наблюдение, возвращает его индекс
+    size_t watch(uintptr_t address);
+
+    /// @brief Добавляет в наблюдение все адреса сессии
+    void watch(std::span<const ScanResult> results);
+
+    void clear();
+
+    /**
+     * @brief Одна выборка всех адресов
+     *
+     * @return std::expected<size_t, MemoryError> сколько значений изменилось
+     */
+    std::expected<size_t, MemoryError> sampleOnce();
+
+    /**
+     * @brief Запускает фоновую выборку с фиксированным периодом
+     *
+     * @param period период выборки
+     */
+    void start(std::chrono::microseconds period);
+    void stop();
+
+    /// @brief Обработчик изменений, вызывается из потока выборки
+    void setOnChange(std::function<void(const WatchEvent&)> callBack);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] uintptr_t address(size_t index) const;
+
+    [[nodiscard]] std::optional<Value> last(size_t index) const;
+    [[nodiscard]] std::optional<Value> min(size_t index) const;
+    [[nodiscard]] std::optional<Value> max(size_t index) const;
+
+    /// @brief История изменений адреса, от старых к новым
+    [[nodiscard]] std::vector<WatchPoint> history(size_t index) const;
+
+    /// @brief Длительность последней выборки
+    [[nodiscard]] std::chrono::nanoseconds lastCycle() const noexcept;
+
+private:
+    /// @brief Пересобирает склеенные участки чтения после изменения набора адресов
+    void rebuildLayout();
+
+    /// @brief Байты k-й записи кольцевого буфера адреса index
+    [[nodiscard]] std::byte* entryValue(size_t index, size_t k) noexcept;
+    [[nodiscard]] const std::byte* entryValue(size_t index, size_t k) const noexcept;
+
+    [[nodiscard]] Value decode(const std::byte* raw) const;
+    [[nodiscard]] int compareRaw(const std::byte* lhs, const std::byte* rhs) const;
+
+    Memory mem;
+    Value type;
+    size_t valSize;
+    size_t capacity;
+
+    std::vector<uintptr_t> addresses{};
+    std::vector<MemorySpan> spans{};
+    std::vector<uint8_t> spanValid{};
+    std::vector<uint32_t> slotSpan{};
+    std::vector<uint32_t> spanSlots{}; // сколько адресов склеено в участок
+    std::vector<size_t> slotOffset{};
+    std::vector<std::byte> readBuffer{};
+    bool layoutDirty = false;
+
+    // кольцевой буфер адреса: момент изменения и байты нового значения, по capacity записей
+    std::vector<uint64_t> ringTimes{};
+    std::vector<std::byte> ringValues{};
+    std::vector<uint32_t> heads{};
+    std::vector<uint32_t> counts{};
+    std::vector<std::byte> minRaw{}; // по valSize байт на адрес
+    std::vector<std::byte> maxRaw{};
+
+    std::function<void(const WatchEvent&)> onChange{};
+    std::chrono::steady_clock::time_point origin{};
+    std::atomic<int64_t> cycleNs{0};
+
+    mutable std::mutex mutex{};
+    std::jthread sampler{};
+};
@@ -1,6 +1,13 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
-#include <iomanip>
 #include <memory>
+#include <optional>
+#include <csignal>
+#include <thread>
+#include <unistd.h>
 
 #include "core/Process/ProcessFinder.hpp"
 #include "core/Process/ProcessReader.hpp"
@@ -8,31 +15,146 @@
 #include "core/Process/ModuleMapParser.hpp"
 #include "core/Process/MemoryReader.hpp"
 #include "core/Process/ModuleFilter.hpp"
+#include "core/Process/RegionStream.hpp"
 
 #include "core/Scanner/scanner.hpp"
 #include "core/Scanner/value.hpp"
 #include "core/Scanner/scanSession.hpp"
 
-int main()
+#include "core/Daemon/scanDaemon.hpp"
+
+#include "RegionPolicies.hpp"
+#include "ResultWriter.hpp"
+#include "BatchRunner.hpp"
+
+namespace
 {
+    void printUsage(const char* self)
+    {
+        std::cerr << "usage: " << self << " [--batch [file]] [--format text|ndjson|binary] [--limit n]\n"
+                  << "       " << self << " --daemon <socket>\n"
+                  << "  without --batch starts the interactive mode\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool batch = false;
+    const char* batchFile = nullptr;
+    OutputFormat format = OutputFormat::Text;
+    size_t limit = 0;
+    const char* daemonSocket = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--batch") == 0)
+        {
+            batch = true;
+
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                batchFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            std::string_view name = argv[++i];
+
+            if (name == "text") format = OutputFormat::Text;
+            else if (name == "ndjson") format = OutputFormat::Ndjson;
+            else if (name == "binary") format = OutputFormat::Binary;
+            else
+            {
+                printUsage(argv[0]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--daemon") == 0 && i + 1 < argc)
+        {
+            daemonSocket = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--limit") == 0 && i + 1 < argc)
+        {
+            std::string_view text = argv[++i];
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), limit);
+
+            if (ec != std::errc{} || ptr != text.data() + text.size())
+            {
+                std::cerr << "invalid --limit: " << text << "\n";
+                printUsage(argv[0]);
+                return 2;
+            }
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (daemonSocket)
+    {
+        // сигналы остановки принимает только основной поток через sigwait
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        ScanDaemon daemon(daemonSocket, RegionPolicies::forScan());
+        std::expected<void, DaemonError> result{};
+
+        std::jthread server([&](std::stop_token stop)
+        {
+            result = daemon.run(stop);
+            kill(getpid(), SIGTERM);
+        });
+
+        int signal = 0;
+        sigwait(&signals, &signal);
+
+        server.request_stop();
+        server.join();
+
+        if (!result)
+        {
+            std::cerr << "cannot listen on " << daemonSocket << "\n";
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (batch)
+    {
+        BatchRunner runner(format, limit);
+
+        if (!batchFile)
+            return runner.run(std::cin);
+
+        std::ifstream commands(batchFile);
+
+        if (!commands)
+        {
+            std::cerr << "cannot open " << batchFile << "\n";
+            return 2;
+        }
+
+        return runner.run(commands);
+    }
+
     ProcessScanner procScanner;
     ProcessReader reader;
     ProcessFinder finder(reader, procScanner);
-    ModuleMapParser moduleParser(reader);
-    ModuleFilter filter;
 
     Scanner scanner(16 * 1024 * 1024);
 
     pid_t pid{};
     std::string input;
 
-    ModuleFilterConfig config;
-    config.onlyWritable = true;
-    config.onlyExecutable = false;
-    config.excludeSystemLibs = true;
-    config.includeAnonymous = true;
+    ModuleFilterConfig config = RegionPolicies::forScan();
+
+    std::optional<RegionStream> regions;
 
-    std::vector<MemoryRegion> regions;
+    ResultWriter out(STDOUT_FILENO);
 
     while (true)
     {
@@ -50,23 +172,30 @@ int main()
         {
             pid = std::stoi(input);
 
-            auto parsed = moduleParser.parse(pid);
-            if (!parsed)
+            // maps только открывается: разбор и фильтр идут по ходу первого сканирования
+            auto rules = ModuleFilter::compile(config);
+            if (!rules)
             {
-                std::cerr << "parse modules failed\n";
+                std::cerr << "filter rules failed to compile\n";
                 continue;
             }
 
-            auto filtered = filter.filter(*parsed, config);
-            if (!filtered)
+            // smaps в потоке не читается: usage для resident и образов файлов берутся из pagemap
+            bool usage = config.skipNonResident || scanner.getFileImages();
+
+            auto opened = RegionStream::open(pid, std::move(*rules), usage);
+            if (!opened)
             {
-                std::cerr << "filter modules failed\n";
+                std::cerr << "attach failed\n";
                 continue;
             }
 
-            regions = *filtered;
+            regions.emplace(std::move(*opened));
+
+            if (usage && !regions->usageKnown())
+                std::cerr << "pagemap unavailable: resident filter and file images are disabled\n";
 
-            std::cout << "[regions] " << regions.size() << "\n";
+            std::cout << "[attach] " << std::chrono::duration_cast<std::chrono::microseconds>(regions->attachTime()).count() << " us\n";
         }
 
         // -------------------------
@@ -107,7 +236,7 @@ int main()
         scanner.setAlignment(Alignment::Four);
 
         auto result = scanner.scan(
-            regions,
+            *regions,
             session,
             value,
             mem
@@ -119,29 +248,12 @@ int main()
             return 0;
         }
 
-        std::cout << "found: " << session.size() << "\n";
-
-        for (auto& r : session.getData())
-        {
-            std::cout
-                << "addr 0x"
-                << std::hex
-                << r.address
-                << std::dec
-                << " value: ";
-
-            for (auto b : r.value)
-            {
-                std::cout
-                    << std::setw(2)
-                    << std::setfill('0')
-                    << std::hex
-                    << (int)b
-                    << " ";
-            }
+        std::cout << "[regions] " << regions->included() << " of " << regions->parsed()
+                  << ", first byte after " << std::chrono::duration_cast<std::chrono::microseconds>(scanner.lastStats().firstByte).count() << " us\n";
+        std::cout << "found: " << session.size() << std::endl;
 
-            std::cout << std::dec << "\n";
-        }
+        out.write(limit ? session.getFirst(limit) : std::span<const ScanResult>(session.getData()), value, limit);
+        out.flush();
 
         // -------------------------
         // NEXT SCAN LOOP
@@ -149,7 +261,7 @@ int main()
 
         while (true)
         {
-            std::cout << "\n[n] next scan | [r] restart | [q] quit : ";
+            std::cout << "\n[n] next scan | [c] changed | [u] unchanged | [+] increased | [-] decreased | [r] restart | [q] quit : ";
 
             std::cin >> input;
 
@@ -165,30 +277,35 @@ int main()
                 std::cout << "ВВеди число: " << std::endl;
                 std::cin >> newValue;
                 value.setValue(newValue);
-                session.filterPrevious();
-                for (auto& r : session.getData())
-        {
-            std::cout
-                << "addr 0x"
-                << std::hex
-                << r.address
-                << std::dec
-                << " value: ";
-
-            for (auto b : r.value)
-            {
-                std::cout
-                    << std::setw(2)
-                    << std::setfill('0')
-                    << std::hex
-                    << (int)b
-                    << " ";
+                session.filterPrevious(value);
+
+                out.write(limit ? session.getFirst(limit) : std::span<const ScanResult>(session.getData()), value, limit);
+                out.flush();
+
+                std::cout << "remaining: " << session.size() << std::endl;
             }
 
-            std::cout << std::dec << "\n";
-        }
+            if (input == "c" || input == "u" || input == "+" || input == "-")
+            {
+                ValueChange change = input == "c" ? ValueChange::Changed
+                                   : input == "u" ? ValueChange::Unchanged
+                                   : input == "+" ? ValueChange::Increased
+                                   : ValueChange::Decreased;
+
+                if(auto filtered = session.filterChanged(change, value); !filtered)
+                {
+                    if(filtered.error() == ValueError::InvalidType)
+                        std::cerr << input << " is not defined for " << Value::typeName(value.type()) << "\n";
+                    else
+                        std::cerr << "Ошибка filterChanged \n";
+
+                    continue;
+                }
+
+                out.write(limit ? session.getFirst(limit) : std::span<const ScanResult>(session.getData()), value, limit);
+                out.flush();
 
-                std::cout << "remaining: " << session.size() << "\n";
+                std::cout << "remaining: " << session.size() << std::endl;
             }
         }
     }
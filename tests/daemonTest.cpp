@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../RegionPolicies.hpp"
+#include "../core/Daemon/daemonClient.hpp"
+#include "../core/Daemon/scanDaemon.hpp"
+
+/**
+ * @brief Интеграционный тест ScanDaemon на процессе syntheticTarget
+ *
+ * Поднимает демон на временном сокете, сканирует мишень через DaemonClient
+ * и сверяет результаты из кольца с тем, что мишень положила в память
+ */
+namespace
+{
+    constexpr int32_t magic = 0x5A17C0DE;
+    constexpr size_t magicCount = 1000;
+    constexpr size_t markerCount = 7;
+    constexpr std::string_view marker = "linuxUtilits-synthetic-marker";
+
+    int failures = 0;
+
+    void check(bool condition, std::string_view what)
+    {
+        if(!condition)
+        {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    /// @brief Запущенная мишень с каналами на stdin/stdout
+    struct Target
+    {
+        pid_t pid = -1;
+        FILE* input = nullptr;
+        FILE* output = nullptr;
+        uintptr_t base = 0;
+        size_t bytes = 0;
+
+        bool start(const char* path)
+        {
+            int toChild[2];
+            int fromChild[2];
+
+            if(::pipe(toChild) != 0 || ::pipe(fromChild) != 0)
+                return false;
+
+            pid = ::fork();
+
+            if(pid < 0)
+                return false;
+
+            if(pid == 0)
+            {
+                ::dup2(toChild[0], STDIN_FILENO);
+                ::dup2(fromChild[1], STDOUT_FILENO);
+                ::close(toChild[1]);
+                ::close(fromChild[0]);
+                ::execl(path, path, static_cast<char*>(nullptr));
+                ::_exit(127);
+            }
+
+            ::close(toChild[0]);
+            ::close(fromChild[1]);
+            input = ::fdopen(toChild[1], "w");
+            output = ::fdopen(fromChild[0], "r");
+
+            return input && output && waitReady();
+        }
+
+        bool waitReady()
+        {
+            char line[128]{};
+
+            if(!std::fgets(line, sizeof(line), output))
+                return false;
+
+            unsigned long long address = 0;
+            size_t size = 0;
+
+            if(std::sscanf(line, "ready %llx %zu", &address, &size) != 2)
+                return false;
+
+            base = address;
+            bytes = size;
+            return true;
+        }
+
+        bool command(const char* line)
+        {
+            std::fprintf(input, "%s\n", line);
+            std::fflush(input);
+            return waitReady();
+        }
+
+        [[nodiscard]] bool owns(uint64_t address) const noexcept
+        {
+            return address >= base && address < base + bytes;
+        }
+
+        ~Target()
+        {
+            if(input)
+            {
+                std::fputs("quit\n", input);
+                std::fclose(input);
+            }
+
+            if(output)
+                std::fclose(output);
+
+            if(pid > 0)
+                ::waitpid(pid, nullptr, 0);
+        }
+    };
+
+    /// @brief Подключается, пока демон ещё поднимает сокет
+    std::expected<DaemonClient, DaemonError> connectWhenReady(const std::filesystem::path& socket)
+    {
+        for(int attempt = 0; attempt < 100; ++attempt)
+        {
+            if(auto client = DaemonClient::connect(socket))
+                return client;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        return DaemonClient::connect(socket);
+    }
+
+    /// @brief Результаты мишени из кольца: адреса по порядку и байты значений
+    struct Fetched
+    {
+        std::vector<uint64_t> addresses{};
+        std::vector<std::vector<std::byte>> values{};
+    };
+
+    std::expected<Fetched, DaemonError> fetchTarget(DaemonClient& client, const Target& target)
+    {
+        Fetched fetched{};
+
+        auto total = client.fetch([&](uint64_t address, std::span<const std::byte> value)
+        {
+            if(!target.owns(address))
+                return;
+
+            fetched.addresses.push_back(address);
+            fetched.values.emplace_back(value.begin(), value.end());
+        });
+
+        if(!total)
+            return std::unexpected{total.error()};
+
+        return fetched;
+    }
+
+    void testIntegers(DaemonClient& client, Target& target)
+    {
+        check(client.attach(target.pid).has_value(), "attach");
+        check(client.setType("i32").has_value(), "type i32");
+
+        auto found = client.scan(std::to_string(magic));
+        check(found && *found >= magicCount, "scan finds every magic value");
+
+        auto fetched = fetchTarget(client, target);
+        check(fetched.has_value(), "fetch after scan");
+
+        if(fetched)
+        {
+            check(fetched->addresses.size() == magicCount, "fetch returns every magic value of the target");
+            check(std::is_sorted(fetched->addresses.begin(), fetched->addresses.end()) &&
+                  std::adjacent_find(fetched->addresses.begin(), fetched->addresses.end()) == fetched->addresses.end(),
+                  "fetched addresses are sorted and unique");
+            check(std::all_of(fetched->values.begin(), fetched->values.end(), [](const auto& value)
+            {
+                int32_t read = 0;
+                return value.size() == sizeof(read) && (std::memcpy(&read, value.data(), sizeof(read)), read == magic);
+            }), "fetched values hold the magic bytes");
+        }
+
+        check(target.command("bump"), "target bump");
+        check(client.next(std::to_string(magic)).has_value(), "next");
+
+        fetched = fetchTarget(client, target);
+        check(fetched && fetched->addresses.size() == magicCount / 2, "next keeps only unchanged values");
+    }
+
+    void testText(DaemonClient& client, Target& target)
+    {
+        check(client.attach(target.pid).has_value(), "attach for text");
+        check(client.setType("str").has_value(), "type str");
+        check(client.scan(marker).has_value(), "text scan");
+
+        auto fetched = fetchTarget(client, target);
+        check(fetched && fetched->addresses.size() == markerCount, "text scan finds every marker");
+
+        if(fetched)
+        {
+            check(std::all_of(fetched->values.begin(), fetched->values.end(), [](const auto& value)
+            {
+                return value.size() == marker.size() &&
+                       std::memcmp(value.data(), marker.data(), marker.size()) == 0;
+            }), "text values arrive in full");
+        }
+    }
+
+    void testConcurrentClients(const std::filesystem::path& socket, Target& target)
+    {
+        size_t results[2]{};
+
+        {
+            std::jthread workers[2];
+
+            for(size_t i = 0; i < 2; ++i)
+            {
+                workers[i] = std::jthread([&, i]
+                {
+                    auto client = connectWhenReady(socket);
+
+                    if(!client || !client->attach(target.pid) || !client->setType("i32") ||
+                       !client->scan(std::to_string(magic)))
+                        return;
+
+                    if(auto fetched = fetchTarget(*client, target))
+                        results[i] = fetched->addresses.size();
+                });
+            }
+        }
+
+        check(results[0] == magicCount / 2 && results[1] == magicCount / 2, "concurrent clients get their own results");
+    }
+
+    /// @brief Находит у себя memfd кольца, который демон передал клиенту
+    int clientRingFd()
+    {
+        for(const auto& entry : std::filesystem::directory_iterator("/proc/self/fd"))
+        {
+            std::error_code error;
+            auto target = std::filesystem::read_symlink(entry.path(), error);
+
+            if(!error && target.string().find("memfd:linuxUtilits-results") != std::string::npos)
+                return std::stoi(entry.path().filename().string());
+        }
+
+        return -1;
+    }
+
+    void* mapClientRing(size_t& size)
+    {
+        int fd = clientRingFd();
+
+        if(fd < 0)
+            return nullptr;
+
+        size = static_cast<size_t>(::lseek(fd, 0, SEEK_END));
+        void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        return mapping == MAP_FAILED ? nullptr : mapping;
+    }
+
+    void testSealedRing(const std::filesystem::path& socket, Target& target)
+    {
+        auto client = connectWhenReady(socket);
+        check(client.has_value(), "connect for sealed ring");
+
+        if(!client)
+            return;
+
+        int fd = clientRingFd();
+        check(fd >= 0, "find client ring");
+
+        if(fd < 0)
+            return;
+
+        off_t size = ::lseek(fd, 0, SEEK_END);
+        check(::ftruncate(fd, 0) != 0 && ::ftruncate(fd, size * 2) != 0, "client cannot resize the ring");
+
+        check(client->attach(target.pid) && client->setType("i32") && client->scan(std::to_string(magic)),
+              "scan after resize attempt");
+
+        auto fetched = fetchTarget(*client, target);
+        check(fetched && fetched->addresses.size() == magicCount / 2, "daemon writes the ring after resize attempt");
+    }
+
+    void testCorruptedRing(const std::filesystem::path& socket, Target& target)
+    {
+        auto client = connectWhenReady(socket);
+        check(client.has_value(), "connect for corruption");
+
+        if(!client)
+            return;
+
+        check(client->attach(target.pid) && client->setType("i32") && client->scan(std::to_string(magic)),
+              "scan before corruption");
+
+        size_t size = 0;
+        void* ring = mapClientRing(size);
+        check(ring != nullptr, "map client ring");
+
+        if(!ring)
+            return;
+
+        std::memset(ring, 0xFF, std::min<size_t>(size, 192));
+        ::munmap(ring, size);
+
+        auto fetched = client->fetch([](uint64_t, std::span<const std::byte>) {});
+        check(!fetched && fetched.error() == DaemonError::CommandFailed, "daemon refuses a corrupted ring");
+        check(client->count().has_value(), "daemon keeps serving after corruption");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "usage: daemonTest <syntheticTarget>" << std::endl;
+        return 2;
+    }
+
+    Target target;
+
+    if(!target.start(argv[1]))
+    {
+        std::cerr << "cannot start " << argv[1] << std::endl;
+        return 1;
+    }
+
+    auto socket = std::filesystem::temp_directory_path() / ("linuxUtilits-test-" + std::to_string(::getpid()) + ".sock");
+
+    {
+        // маленькое кольцо: fetch идёт в несколько заходов и переходит через конец буфера
+        ScanDaemon daemon(socket, RegionPolicies::forScan(), 2, 4096);
+        std::jthread server([&](std::stop_token stop)
+        {
+            if(!daemon.run(stop))
+                std::cerr << "daemon failed to start" << std::endl;
+        });
+
+        {
+            auto client = connectWhenReady(socket);
+            check(client.has_value(), "connect");
+
+            if(client)
+            {
+                testIntegers(*client, target);
+                testText(*client, target);
+            }
+        }
+
+        testConcurrentClients(socket, target);
+        testSealedRing(socket, target);
+        testCorruptedRing(socket, target);
+    }
+
+    if(failures == 0)
+        std::cout << "daemon: all checks passed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
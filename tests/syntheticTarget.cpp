@@ -0,0 +1,65 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+
+/**
+ * @brief Процесс-мишень для интеграционных тестов
+ *
+ * Кладёт в анонимную память magicCount значений magic и markerCount копий
+ * marker, печатает "ready <адрес> <размер>" своей области и ждёт команд на stdin:
+ *
+ *     bump -- меняет каждое второе значение magic, отвечает тем же "ready"
+ *     quit
+ */
+namespace
+{
+    constexpr int32_t magic = 0x5A17C0DE;
+    constexpr size_t magicCount = 1000;
+    constexpr size_t markerCount = 7;
+    constexpr char marker[] = "linuxUtilits-synthetic-marker";
+}
+
+int main()
+{
+    constexpr size_t bytes = 1 << 20;
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(mapping == MAP_FAILED)
+        return 1;
+
+    auto* values = static_cast<int32_t*>(mapping);
+
+    for(size_t i = 0; i < magicCount; ++i)
+        values[i * 4] = magic;
+
+    auto* text = static_cast<char*>(mapping) + bytes / 2;
+
+    for(size_t i = 0; i < markerCount; ++i)
+        std::memcpy(text + i * 64, marker, sizeof(marker) - 1);
+
+    auto ready = [&]
+    {
+        std::cout << "ready " << std::hex << reinterpret_cast<uintptr_t>(mapping) << std::dec << " " << bytes << std::endl;
+    };
+
+    ready();
+
+    std::string line;
+
+    while(std::getline(std::cin, line))
+    {
+        if(line == "bump")
+        {
+            for(size_t i = 0; i < magicCount; i += 2)
+                values[i * 4] = magic + 1;
+
+            ready();
+        }
+        else if(line == "quit")
+            break;
+    }
+
+    return 0;
+}